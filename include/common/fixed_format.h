@@ -0,0 +1,62 @@
+#ifndef FIXED_FORMAT_H
+#define FIXED_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define FIXED_FORMAT_MAX_DECIMALS 6  // 10^6 still leaves 2147 whole units in an int32_t
+#define FIXED_FORMAT_MAX_CHARS 32    // Buffer size that fits any number, padding and short suffix
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Layout of a formatted number
+typedef struct {
+    uint8_t decimals;    // Digits after the decimal point, 0 to FIXED_FORMAT_MAX_DECIMALS
+    uint8_t width;       // Minimum characters of the number, padded with leading spaces
+    const char *suffix;  // Unit appended after the number, e.g. " °C", or NULL
+} fixed_format_t;
+
+/**
+ * @brief Format a fixed-point number without printf
+ *
+ * Writes an optional minus sign, the integer part, the decimal point and exactly
+ * format->decimals digits, padded on the left to format->width, followed by the
+ * suffix. Padding keeps the text the same length while the value changes, so labels
+ * do not shift and need no relayout.
+ *
+ * @param buf Destination, NUL-terminated on return
+ * @param size Size of buf in bytes
+ * @param value Value in units of 10^-decimals, e.g. 901 with one decimal for "90.1"
+ * @param format Layout
+ * @return Characters written without the NUL, or 0 with an empty buf if it is too small
+ */
+size_t fixed_format_int(char *buf, size_t size, int32_t value, const fixed_format_t *format);
+
+/**
+ * @brief Round a float to format->decimals and format it like fixed_format_int()
+ *
+ * Halves round away from zero. NaN and values outside the int32_t range are shown as
+ * "--", padded to the same width.
+ *
+ * @param buf Destination, NUL-terminated on return
+ * @param size Size of buf in bytes
+ * @param value Value to format
+ * @param format Layout
+ * @return Characters written without the NUL, or 0 with an empty buf if it is too small
+ */
+size_t fixed_format_float(char *buf, size_t size, float value, const fixed_format_t *format);
+
+/**
+ * @brief Compare the formatter with snprintf on readout-like values and log the timings
+ *
+ * Also logs how many results differ from snprintf's "%*.*f%s".
+ */
+void fixed_format_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FIXED_FORMAT_H */
@@ -0,0 +1,77 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Single-writer mailbox holding the latest value of T
+ *
+ * The writer never blocks or takes a lock: it bumps a sequence number to odd, copies
+ * the value and bumps it back to even. Readers copy the value and retry if the
+ * sequence changed meanwhile, so they always see a complete value. Intermediate
+ * values published between two reads are skipped. T must be trivially copyable.
+ */
+template <typename T>
+class SeqlockMailbox {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqlockMailbox requires a trivially copyable type");
+
+private:
+    std::atomic<uint32_t> sequence;  // Odd while a write is in progress
+    T value;
+
+public:
+    SeqlockMailbox() : sequence(0), value()
+    {
+    }
+
+    /**
+     * @brief Replace the value (single writer)
+     *
+     * @param next Value to publish
+     */
+    void publish(const T &next)
+    {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value, &next, sizeof(T));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the latest value (any number of readers)
+     *
+     * Retries only while the writer is in the middle of a publish.
+     *
+     * @param out Destination for the value
+     * @return Number of publishes so far, 0 if nothing was published yet
+     */
+    uint32_t read(T &out) const
+    {
+        while (1) {
+            uint32_t seq = sequence.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            memcpy(&out, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == seq) {
+                return seq / 2;
+            }
+        }
+    }
+
+    /**
+     * @brief Number of publishes so far, to tell whether read() would return news
+     */
+    uint32_t version() const
+    {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+};
+
+#endif /* SEQLOCK_H */
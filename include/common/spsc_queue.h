@@ -0,0 +1,78 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lock-free single-producer single-consumer ring buffer
+ *
+ * One task (or ISR) pushes and one task pops; neither side ever blocks or takes a
+ * lock. Capacity must be a power of two. Elements are copied in and out, so T should
+ * be a small trivially copyable struct.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+private:
+    T items[Capacity];
+    std::atomic<uint32_t> head;  // Next slot to write, owned by the producer
+    std::atomic<uint32_t> tail;  // Next slot to read, owned by the consumer
+
+public:
+    SpscQueue() : head(0), tail(0)
+    {
+    }
+
+    /**
+     * @brief Append an element (producer side)
+     *
+     * @param item Element to copy into the queue
+     * @return false if the queue is full and the element was dropped
+     */
+    bool push(const T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element (consumer side)
+     *
+     * @param out Destination for the element
+     * @return false if the queue is empty
+     */
+    bool pop(T &out)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = items[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of queued elements; exact only when called by producer or consumer
+     */
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+};
+
+#endif /* SPSC_QUEUE_H */
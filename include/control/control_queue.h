@@ -0,0 +1,116 @@
+#ifndef CONTROL_QUEUE_H
+#define CONTROL_QUEUE_H
+
+#include <cstdint>
+
+#include "common/spsc_queue.h"
+
+#define CONTROL_QUEUE_SIZE 16            // Commands buffered for the control task, power of two
+#define CONTROL_STATS_INTERVAL_MS 10000  // Latency report interval while commands arrive
+
+typedef enum {
+    CONTROL_CMD_SSR_STATE = 0,  // Switch an SSR by hand
+    CONTROL_CMD_DIMMER,         // Set the pump dimmer by hand
+    CONTROL_CMD_SETPOINT,       // Change a PID setpoint
+    CONTROL_CMD_PID_ENABLE,     // Enable or disable the PID controllers
+    CONTROL_CMD_PROFILE_START,  // Start an extraction profile
+    CONTROL_CMD_PROFILE_STOP,   // Abort the running extraction profile
+    CONTROL_CMD_DOSE,           // Arm a volumetric dose, or cancel it with 0 mL
+    CONTROL_CMD_SAFETY_RESET,   // Clear a latched safety interlock trip
+} control_cmd_type_t;
+
+// Control command from the UI
+typedef struct {
+    control_cmd_type_t type;
+    int index;  // SSR index, or -1 for the pressure setpoint; profile index, or -1 for the default
+    union {
+        bool state;      // CONTROL_CMD_SSR_STATE, CONTROL_CMD_PID_ENABLE
+        uint32_t level;  // CONTROL_CMD_DIMMER, 0-1023
+        float setpoint;  // CONTROL_CMD_SETPOINT; mL for CONTROL_CMD_DOSE
+    };
+    int64_t queued_us;  // Set when the command is posted
+} control_cmd_t;
+
+// Control command statistics
+typedef struct {
+    uint32_t posted;            // Commands queued for the control task
+    uint32_t dropped;           // Commands lost because the queue was full
+    uint32_t applied;           // Commands applied to the actuators
+    uint32_t max_latency_us;    // Worst time from posting to applying, since boot
+    uint64_t total_latency_us;  // Sum over all applied commands
+} control_stats_t;
+
+/**
+ * @brief Commands from the UI to the control task
+ *
+ * UI callbacks run on the render task with the UI mutex held. Instead of driving
+ * actuators and PID controllers from there, they post timestamped commands into a
+ * lock-free queue that the control task drains at the start of each cycle. Actuators
+ * and controllers are then only touched by the control task, and a slow driver call
+ * never stalls rendering.
+ *
+ * Single producer (the render task) and single consumer (the control task).
+ */
+class ControlQueue {
+private:
+    SpscQueue<control_cmd_t, CONTROL_QUEUE_SIZE> commands;
+    control_stats_t stats;
+    int64_t last_report_us;
+    uint32_t window_applied;     // Commands applied since the last report
+    uint32_t window_max_us;      // Worst latency since the last report
+    uint64_t window_latency_us;  // Latency sum since the last report
+
+public:
+    ControlQueue();
+
+    /**
+     * @brief Timestamp and queue a command (producer side)
+     *
+     * @param cmd Command to queue; queued_us is filled in
+     * @return false if the queue is full and the command was dropped
+     */
+    bool post(control_cmd_t cmd);
+
+    /**
+     * @brief Pop the oldest command (consumer side)
+     *
+     * @param out Destination for the command
+     * @return false if no command is pending
+     */
+    bool pop(control_cmd_t *out);
+
+    /**
+     * @brief Record that a popped command has been applied (consumer side)
+     *
+     * Accumulates UI-to-actuator latency and logs it every CONTROL_STATS_INTERVAL_MS.
+     *
+     * @param cmd The applied command
+     */
+    void complete(const control_cmd_t *cmd);
+
+    /**
+     * @brief Get command statistics
+     *
+     * @param out Destination for the statistics
+     */
+    void getStats(control_stats_t *out) const;
+};
+
+// Global instance
+extern ControlQueue control_queue;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool control_queue_post(const control_cmd_t *cmd);
+bool control_queue_pop(control_cmd_t *out);
+void control_queue_complete(const control_cmd_t *cmd);
+void control_queue_get_stats(control_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_QUEUE_H */
@@ -0,0 +1,155 @@
+#ifndef CHART_ENGINE_H
+#define CHART_ENGINE_H
+
+#include <cstdint>
+
+#include "display/raster.h"
+#include "esp_err.h"
+#include "sensor_manager/sensor_manager.h"
+
+#define CHART_MAX_TRACES 4
+#define CHART_GRID_ROWS 5                 // Horizontal grid lines, matching the Y-axis boxes
+#define CHART_GRID_SAMPLES 10             // Samples between vertical grid lines
+#define CHART_TRACE_WIDTH RASTER_FX(1.5)  // Antialiased trace width
+#define CHART_RAMP_STEPS 16               // Edge shades per trace on an indexed surface
+
+// Palette of an indexed surface: background, grid, then a ramp per trace
+#define CHART_PALETTE_BACKGROUND 0
+#define CHART_PALETTE_GRID 1
+#define CHART_PALETTE_TRACES 2
+#define CHART_PALETTE_SIZE (CHART_PALETTE_TRACES + CHART_MAX_TRACES * CHART_RAMP_STEPS)
+
+// Pixel format of the chart surface
+typedef enum {
+    CHART_FORMAT_RGB565 = 0,  // 2 bytes per pixel, traces blended exactly
+    CHART_FORMAT_INDEX8 = 1,  // 1 byte per pixel, expanded through the palette on flush
+} chart_format_t;
+
+// One line of the chart
+typedef struct {
+    uint16_t color;  // RGB565, native byte order
+    float min;       // Value drawn at the bottom edge
+    float max;       // Value drawn at the top edge
+} chart_trace_t;
+
+// Chart update statistics
+typedef struct {
+    uint32_t updates;         // Calls to update() that drew something
+    uint32_t full_redraws;    // Updates that redrew every column
+    uint32_t columns_drawn;   // Pixel columns rasterized since boot
+    uint32_t last_update_us;  // Time spent in the last update
+    uint32_t surface_bytes;   // Size of the surface
+} chart_stats_t;
+
+/**
+ * @brief Strip chart that scrolls its pixels instead of redrawing them
+ *
+ * The chart owns a surface with one sample every column_step pixels, newest on the
+ * right. Each update scrolls the surface left by the samples recorded since
+ * the previous update and rasterizes only the new columns, reading the history ring
+ * through HistoryView without copying it. Drawing cost is proportional to new
+ * samples, not to chart width.
+ *
+ * The surface is shown on the panel as a slint_platform overlay. In CHART_FORMAT_INDEX8
+ * it holds palette indices, which halves its memory and the PSRAM traffic of scrolling
+ * and drawing; the overlay expands them to RGB565 while filling the panel buffers.
+ */
+class ScrollingChart {
+private:
+    uint8_t *pixels;  // width x height of the format, row-major, PSRAM
+    chart_format_t format;
+    int pixel_bytes;
+    int x, y;  // Position on screen
+    int width, height;
+    int column_step;
+    uint16_t palette[CHART_PALETTE_SIZE];  // Colors of the palette entries in either format
+
+    chart_trace_t traces[CHART_MAX_TRACES];
+    int trace_count;
+
+    uint32_t drawn_count;  // History sample count the surface shows
+    bool valid;            // Surface matches drawn_count
+    bool attached;         // Shown as the panel overlay
+    chart_stats_t stats;
+
+    int32_t valueToY(const chart_trace_t &trace, float value) const;
+    void scroll(int columns);
+    void fill(int row, int column, int count, uint8_t entry);
+    void drawSample(const HistoryView *views, int index, int column, uint32_t sample);
+    void redraw(const HistoryView *views, uint32_t sample_count);
+
+    friend void chart_benchmark(void);
+
+public:
+    ScrollingChart();
+
+    /**
+     * @brief Allocate the surface
+     *
+     * @param x Left edge on screen
+     * @param y Top edge on screen
+     * @param samples Samples visible at once
+     * @param column_step Pixels per sample
+     * @param height Height in pixels
+     * @param background Background color
+     * @param grid_color Grid line color
+     * @param format Pixel format of the surface
+     * @return ESP_OK on success, ESP_ERR_NO_MEM if the surface cannot be allocated
+     */
+    esp_err_t init(int x,
+                   int y,
+                   int samples,
+                   int column_step,
+                   int height,
+                   uint16_t background,
+                   uint16_t grid_color,
+                   chart_format_t format);
+
+    /**
+     * @brief Free the surface; the chart must not be visible
+     */
+    void deinit();
+
+    /**
+     * @brief Add a line, drawn from the view at the same index passed to update()
+     *
+     * @return Trace index, or -1 if CHART_MAX_TRACES is reached
+     */
+    int addTrace(uint16_t color, float min, float max);
+
+    /**
+     * @brief Bring the surface up to date with the history
+     *
+     * Must be called with the UI mutex held.
+     *
+     * @param views One view per trace, all of the same history
+     * @param sample_count SensorHistory::sample_count of that history
+     * @return Number of pixel columns drawn
+     */
+    int update(const HistoryView *views, uint32_t sample_count);
+
+    /**
+     * @brief Show or hide the chart on the panel
+     *
+     * Must be called with the UI mutex held.
+     */
+    void setVisible(bool visible);
+
+    /**
+     * @brief Force a full redraw on the next update
+     */
+    void invalidate() { valid = false; }
+
+    const chart_stats_t &getStats() const { return stats; }
+};
+
+/**
+ * @brief Compare chart formats on synthetic data and log memory use and timings
+ *
+ * For each format, logs the surface size, the time of a full redraw and of a
+ * one-sample scroll, and the time to copy the surface into an RGB565 frame as the
+ * overlay does every time the chart changes.
+ */
+void chart_benchmark(void);
+
+#endif /* CHART_ENGINE_H */
@@ -0,0 +1,205 @@
+#ifndef LAYER_CACHE_H
+#define LAYER_CACHE_H
+
+#include <slint.h>
+
+#include <cstdint>
+#include <functional>
+
+#include "display/slint_platform.h"
+#include "esp_log.h"
+
+/**
+ * @brief Render the most recently created offscreen component into an image
+ *
+ * Components created after the main window get an offscreen window adapter. This
+ * renders such a component once, full-frame, into an RGB888 buffer. Every layer is
+ * rendered into the same buffer; drop the previous layer's image first, or the buffer
+ * is copied.
+ *
+ * @return The rendered layer, or an empty image if no offscreen component exists
+ */
+slint::Image slint_platform_render_offscreen();
+
+/**
+ * @brief Render frames that each follow a change, and measure their latency
+ *
+ * Only the region a change dirties is rendered and flushed, unlike the full frames of
+ * slint_platform_benchmark(). Must be called from the render task.
+ *
+ * @param frames Number of frames to render
+ * @param change Called with the frame number before each frame
+ * @return Average time from the start of rendering until the frame is on the panel, us
+ */
+uint32_t slint_platform_benchmark_changes(int frames, const std::function<void(int)> &change);
+
+/**
+ * @brief Run a hook on the render task before timers and rendering, under the UI mutex
+ *
+ * @param hook Function to run, or an empty function to remove it
+ */
+void slint_platform_set_before_render(std::function<void()> hook);
+
+/**
+ * @brief Cache of the static part of the UI as one pre-rendered image
+ *
+ * Layer is a component that draws only the static parts of the screen (panel
+ * backgrounds, shadows, grids, icons). It is rendered offscreen once and handed to
+ * App through its static-layer property. While layer-cached is set, App draws the
+ * image and only its dynamic parts, so a dirty region costs an image blit instead of
+ * re-rasterizing everything underneath it.
+ *
+ * The layer is re-rendered on the next frame after slint_platform_invalidate_layers(),
+ * which the UI calls on view switches. A setup function copies the state the static
+ * parts depend on, such as the current view, from App into each new Layer.
+ *
+ * @tparam App Main window component with static-layer and layer-cached properties, and
+ *             the bench-* properties of a rectangle that benchmark() changes
+ * @tparam Layer Component that draws the static parts
+ */
+template <typename App, typename Layer>
+class LayerCache {
+private:
+    slint::ComponentHandle<App> app;
+    std::function<void(const slint::ComponentHandle<Layer> &)> setup;
+    bool enabled;
+    bool valid;
+    uint32_t generation;  // Layer generation the cached image was rendered for
+
+public:
+    /**
+     * @param app Main window the layer is drawn into
+     * @param setup Called with each new Layer before it is rendered, may be empty
+     */
+    explicit LayerCache(const slint::ComponentHandle<App> &app,
+                        std::function<void(const slint::ComponentHandle<Layer> &)> setup = {})
+        : app(app), setup(std::move(setup)), enabled(true), valid(false), generation(0)
+    {
+    }
+
+    /**
+     * @brief Refresh the cache from the render task before every frame
+     */
+    void attach()
+    {
+        slint_platform_set_before_render([this] { refresh(); });
+    }
+
+    /**
+     * @brief Re-render the static layer if it is missing or stale
+     */
+    void refresh()
+    {
+        uint32_t current = slint_platform_layer_generation();
+        if (!enabled || (valid && generation == current)) {
+            return;
+        }
+
+        auto layer = Layer::create();
+        if (setup) {
+            setup(layer);
+        }
+
+        // Drop the previous image so its buffer is rendered into without a copy
+        app->set_static_layer(slint::Image());
+
+        // Showing the layer creates its window adapter, an offscreen one since the main
+        // window already has the panel
+        layer->show();
+        app->set_static_layer(slint_platform_render_offscreen());
+        layer->hide();
+        app->set_layer_cached(true);
+
+        generation = current;
+        valid      = true;
+    }
+
+    /**
+     * @brief Drop the cached image and draw everything live
+     */
+    void invalidate()
+    {
+        valid = false;
+        app->set_layer_cached(false);
+        app->set_static_layer(slint::Image());
+    }
+
+    /**
+     * @brief Enable or disable the cache
+     */
+    void setEnabled(bool on)
+    {
+        enabled = on;
+        if (!on) {
+            invalidate();
+        }
+    }
+
+    /**
+     * @brief Log frame latencies without and with the layer cache
+     *
+     * Full frames first, then frames that only redraw a rectangle of each of a few
+     * sizes, from a readout to the whole screen. The rectangle is nearly transparent, so
+     * everything under it is drawn, live or from the cached image.
+     *
+     * @param frames Frames rendered for each configuration
+     */
+    void benchmark(int frames)
+    {
+        static const char *TAG = "layer_cache";
+
+        // Dirty regions, centered on the screen
+        static const struct {
+            const char *name;
+            float width;
+            float height;
+        } regions[] = {
+            {"readout", 80, 24},
+            {"panel", 240, 160},
+            {"view", 710, 330},
+            {"screen", 800, 480},
+        };
+
+        bool was_enabled = enabled;
+
+        ESP_LOGI(TAG, "Layer cache disabled:");
+        setEnabled(false);
+        slint_platform_benchmark(frames);
+
+        ESP_LOGI(TAG, "Layer cache enabled:");
+        setEnabled(true);
+        refresh();
+        slint_platform_benchmark(frames);
+
+        slint::PhysicalSize size = app->window().size();
+        for (const auto &region : regions) {
+            app->set_bench_x((size.width - region.width) / 2);
+            app->set_bench_y((size.height - region.height) / 2);
+            app->set_bench_width(region.width);
+            app->set_bench_height(region.height);
+
+            uint32_t latency_us[2];
+            for (int cached = 0; cached < 2; cached++) {
+                setEnabled(cached != 0);
+                refresh();
+                // Flush the layer and geometry changes before measuring
+                slint_platform_benchmark_changes(1, [](int) {});
+                latency_us[cached] = slint_platform_benchmark_changes(
+                    frames, [this](int frame) { app->set_bench_phase(frame & 1); });
+            }
+            ESP_LOGI(TAG,
+                     "%s %dx%d: cache off %u us, on %u us per frame",
+                     region.name,
+                     (int)region.width,
+                     (int)region.height,
+                     (unsigned)latency_us[0],
+                     (unsigned)latency_us[1]);
+        }
+
+        app->set_bench_width(0);
+        app->set_bench_height(0);
+        setEnabled(was_enabled);
+    }
+};
+
+#endif /* LAYER_CACHE_H */
@@ -0,0 +1,90 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sdkconfig.h"
+
+// Use the ESP32-S3 PIE vector unit where the kernel and alignment allow it
+#if defined(CONFIG_IDF_TARGET_ESP32S3) && !defined(PIXEL_KERNELS_SCALAR_ONLY)
+#define PIXEL_KERNELS_PIE 1
+#else
+#define PIXEL_KERNELS_PIE 0
+#endif
+
+// Pixels per PIE loop iteration: two 128-bit registers of 8 RGB565 pixels each
+#define PIXEL_PIE_BLOCK 16
+
+// RGB565 spread over 32 bits as 00000gggggg00000rrrrr000000bbbbb for SWAR blending
+#define PIXEL_RGB565_SPREAD_MASK 0x07E0F81Fu
+
+/**
+ * @brief Blend a color over one native-order RGB565 pixel
+ *
+ * All three channels are blended with a single multiply, at 5-bit alpha precision.
+ *
+ * @param dst Background pixel
+ * @param color Source color
+ * @param alpha Source opacity, 0 (transparent) to 255 (opaque)
+ * @return Blended pixel
+ */
+static inline uint16_t pixel_mix_rgb565(uint16_t dst, uint16_t color, uint8_t alpha)
+{
+    uint32_t alpha5 = ((uint32_t)alpha + 4) >> 3;
+    uint32_t fg     = (color | ((uint32_t)color << 16)) & PIXEL_RGB565_SPREAD_MASK;
+    uint32_t bg     = (dst | ((uint32_t)dst << 16)) & PIXEL_RGB565_SPREAD_MASK;
+    bg += ((fg - bg) * alpha5) >> 5;
+    bg &= PIXEL_RGB565_SPREAD_MASK;
+    return (uint16_t)(bg | (bg >> 16));
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fill pixels with a solid RGB565 color
+ *
+ * @param dst Destination pixels
+ * @param color Color in the byte order expected at dst
+ * @param count Number of pixels
+ */
+void pixel_fill_rgb565(uint16_t *dst, uint16_t color, size_t count);
+
+/**
+ * @brief Copy pixels swapping the two bytes of each one
+ *
+ * Converts between the CPU's little-endian RGB565 and the panel's big-endian wire
+ * order. dst may equal src for an in-place swap.
+ *
+ * @param dst Destination pixels
+ * @param src Source pixels
+ * @param count Number of pixels
+ */
+void pixel_copy_swap_rgb565(uint16_t *dst, const uint16_t *src, size_t count);
+
+/**
+ * @brief Expand 8-bit palette indices to RGB565
+ *
+ * @param dst Destination pixels
+ * @param src Source indices, one byte per pixel
+ * @param palette 256-entry lookup table in the byte order wanted at dst; only the
+ *                entries used by src must be valid
+ * @param count Number of pixels
+ */
+void pixel_index8_to_rgb565(uint16_t *dst,
+                            const uint8_t *src,
+                            const uint16_t *palette,
+                            size_t count);
+
+/**
+ * @brief Measure every kernel and log its throughput in megapixels per second
+ */
+void pixel_kernels_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIXEL_KERNELS_H */
@@ -0,0 +1,166 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <cstdint>
+
+// Coordinates and widths are fixed point with 8 fractional bits; pixel centers are at .5
+#define RASTER_FX_SHIFT 8
+#define RASTER_FX_ONE (1 << RASTER_FX_SHIFT)
+#define RASTER_FX(px) ((int32_t)((px) * RASTER_FX_ONE))
+
+// Largest outer radius of an arc span table
+#define RASTER_ARC_MAX_RADIUS 160
+
+// RGB565 drawing target in native byte order; also used for clipped views into a larger one
+typedef struct {
+    uint16_t *pixels;
+    int width;
+    int height;
+    int stride;  // Row length in pixels
+} raster_surface_t;
+
+// 8-bit palette-indexed drawing target
+typedef struct {
+    uint8_t *pixels;
+    int width;
+    int height;
+    int stride;  // Row length in pixels
+} raster_index8_surface_t;
+
+// Palette entries of one color on an indexed surface: entry base + k holds the color at
+// (k + 1) / steps coverage over the background entry
+typedef struct {
+    uint8_t base;
+    uint8_t steps;
+    uint8_t background;  // Index the ramp fades from
+} raster_ramp_t;
+
+typedef struct {
+    int32_t x;  // Fixed point
+    int32_t y;
+} raster_point_t;
+
+// Per-row spans of a ring, built once per gauge geometry. Each row stores half-widths
+// (fixed point) of the circles bounding its antialiased edges, so drawing is span fills
+// with an exact coverage computation only in the few edge pixels.
+typedef struct {
+    int radius;        // Outer radius in pixels
+    int inner_radius;  // Inner radius in pixels, 0 for a filled disc
+    struct {
+        uint16_t outer_edge;  // Pixels beyond are empty
+        uint16_t outer_full;  // Pixels within are fully inside the outer circle
+        uint16_t inner_full;  // Pixels beyond are fully outside the inner circle
+        uint16_t inner_edge;  // Pixels within are empty
+    } rows[RASTER_ARC_MAX_RADIUS + 1];  // Indexed by distance of the row center from the center
+} raster_arc_table_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Draw an antialiased line with round caps
+ *
+ * @param surface Target surface, the line is clipped to it
+ * @param x0 Start X, fixed point
+ * @param y0 Start Y, fixed point
+ * @param x1 End X, fixed point
+ * @param y1 End Y, fixed point
+ * @param width Line width, fixed point
+ * @param color RGB565 color
+ * @return Number of pixels written
+ */
+uint32_t raster_line_aa(const raster_surface_t *surface,
+                        int32_t x0,
+                        int32_t y0,
+                        int32_t x1,
+                        int32_t y1,
+                        int32_t width,
+                        uint16_t color);
+
+/**
+ * @brief Draw an antialiased line with round caps on an indexed surface
+ *
+ * Coverage selects a step of the ramp instead of blending. Edge pixels over the
+ * background or the same color are exact; over other colors they are kept or replaced
+ * whole, whichever is closer.
+ *
+ * @param surface Target surface, the line is clipped to it
+ * @param x0 Start X, fixed point
+ * @param y0 Start Y, fixed point
+ * @param x1 End X, fixed point
+ * @param y1 End Y, fixed point
+ * @param width Line width, fixed point
+ * @param ramp Palette entries of the line color
+ * @return Number of pixels written
+ */
+uint32_t raster_line_aa_index8(const raster_index8_surface_t *surface,
+                               int32_t x0,
+                               int32_t y0,
+                               int32_t x1,
+                               int32_t y1,
+                               int32_t width,
+                               const raster_ramp_t *ramp);
+
+/**
+ * @brief Draw an antialiased polyline
+ *
+ * Joints are covered by the round caps of both segments, which blends their
+ * antialiased rims twice.
+ *
+ * @param surface Target surface
+ * @param points Vertices, fixed point
+ * @param count Number of vertices
+ * @param width Line width, fixed point
+ * @param color RGB565 color
+ * @return Number of pixels written
+ */
+uint32_t raster_polyline_aa(const raster_surface_t *surface,
+                            const raster_point_t *points,
+                            int count,
+                            int32_t width,
+                            uint16_t color);
+
+/**
+ * @brief Precompute the spans of a ring
+ *
+ * @param table Table to fill
+ * @param radius Outer radius in pixels, at most RASTER_ARC_MAX_RADIUS
+ * @param inner_radius Inner radius in pixels, 0 for a disc
+ * @return true on success, false if the radii are out of range
+ */
+bool raster_arc_table_init(raster_arc_table_t *table, int radius, int inner_radius);
+
+/**
+ * @brief Draw an antialiased arc of a precomputed ring
+ *
+ * Angles are in degrees, clockwise from 12 o'clock; the arc runs clockwise from
+ * start to end. A sweep of 360 degrees or more draws the full ring.
+ *
+ * @param surface Target surface
+ * @param table Ring spans
+ * @param cx Center X in pixels, on a pixel corner
+ * @param cy Center Y in pixels, on a pixel corner
+ * @param start_deg Start angle
+ * @param end_deg End angle
+ * @param color RGB565 color
+ * @return Number of pixels written
+ */
+uint32_t raster_arc_aa(const raster_surface_t *surface,
+                       const raster_arc_table_t *table,
+                       int cx,
+                       int cy,
+                       int start_deg,
+                       int end_deg,
+                       uint16_t color);
+
+/**
+ * @brief Measure each primitive and log its cost and throughput
+ */
+void raster_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RASTER_H */
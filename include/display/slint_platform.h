@@ -0,0 +1,173 @@
+#ifndef SLINT_PLATFORM_H
+#define SLINT_PLATFORM_H
+
+#include <cstdint>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Renderer pipeline configuration
+#define SLINT_RENDER_TASK_CORE 1     // Off the WiFi/BT core; the safety task there preempts it
+#define SLINT_FLUSH_TASK_PRIORITY 4  // Flush workers: below the render task and far below control
+#define SLINT_FLUSH_TASK_STACK 4096
+#define SLINT_FLUSH_WORKERS 2        // Flush workers, one pinned to each core
+#define SLINT_FLUSH_QUEUE_DEPTH 8    // Framebuffer bands queued ahead of the workers
+#define SLINT_MAX_DIRTY_RECTS 16     // Rectangles forwarded per frame, extra ones are merged
+#define SLINT_STATS_INTERVAL_MS 5000
+
+// Render pipeline statistics
+typedef struct {
+    uint32_t frames;              // Frames rendered since boot
+    uint32_t last_frame_us;       // Render time of the last frame
+    uint32_t max_frame_us;        // Worst render time in the current window
+    uint32_t avg_frame_us;        // Mean render time in the current window
+    uint32_t last_flush_us;       // Transfer time of the last frame
+    uint32_t last_bytes_flushed;  // Bytes sent to the panel for the last frame
+    uint32_t pixels_flushed;      // Dirty pixels sent to the panel since boot
+    float fps;                    // Frames flushed per second in the last window
+    uint32_t buffer_bytes;        // RAM held by framebuffers or line buffers
+    uint32_t paced;               // Redraws deferred until the panel caught up
+} slint_render_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Install the ESP32 Slint platform backed by the software renderer
+ *
+ * Allocates the render buffers selected by DISPLAY_RENDER_MODE (two RGB565
+ * framebuffers in PSRAM, or a few internal line buffers) and starts the flush task.
+ * Must be called before any Slint component is created.
+ *
+ * @param width Display width in pixels
+ * @param height Display height in pixels
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t slint_platform_init(int width, int height);
+
+/**
+ * @brief Forward the current touch state to the Slint window
+ *
+ * @param touched true while the panel is touched
+ * @param x Touch X coordinate in pixels
+ * @param y Touch Y coordinate in pixels
+ */
+void slint_platform_dispatch_touch(bool touched, uint16_t x, uint16_t y);
+
+/**
+ * @brief Set the task woken by redraw requests, flush completion and touch
+ *
+ * @param task Task that calls slint_platform_render()
+ */
+void slint_platform_set_render_task(TaskHandle_t task);
+
+/**
+ * @brief Wake the render task
+ */
+void slint_platform_wake(void);
+
+/**
+ * @brief Wake the render task from an interrupt handler
+ */
+void slint_platform_wake_from_isr(void);
+
+/**
+ * @brief Get how long the render task may sleep
+ *
+ * @return 0 if a frame can be rendered now, the ticks until the next Slint timer or
+ *         animation deadline, or portMAX_DELAY if nothing is scheduled
+ */
+TickType_t slint_platform_idle_timeout(void);
+
+/**
+ * @brief Run timers, pending tasks and render a frame if the window is dirty
+ *
+ * Renders the dirty region into the back framebuffer (or band by band into the line
+ * buffers) and hands it to the flush task, so rendering overlaps the previous transfer.
+ * A redraw is deferred while the panel is still busy with earlier frames; the flush
+ * task wakes the render task once it has caught up.
+ *
+ * @return true if a frame was rendered
+ */
+bool slint_platform_render(void);
+
+/**
+ * @brief Render full-screen frames and log frame latency and RAM footprint
+ *
+ * Each iteration forces a full redraw and waits until it has reached the panel. The
+ * log splits the frame latency into rasterization and the flush that follows it, so
+ * the numbers of a DISPLAY_RENDER_FRAMEBUFFER and a DISPLAY_RENDER_LINES build can be
+ * compared directly. Must be called from the render task.
+ *
+ * @param frames Number of frames to render
+ */
+void slint_platform_benchmark(int frames);
+
+/**
+ * @brief Mark cached static layers as stale, e.g. after a view switch
+ *
+ * Layer caches compare slint_platform_layer_generation() before each frame and
+ * re-render their static layer when it changed.
+ */
+void slint_platform_invalidate_layers(void);
+
+/**
+ * @brief Get the static layer generation, bumped by slint_platform_invalidate_layers()
+ */
+uint32_t slint_platform_layer_generation(void);
+
+/**
+ * @brief Show a native RGB565 surface on top of the Slint frame
+ *
+ * The surface is opaque and replaces whatever Slint draws under it. It is read only
+ * on the render task, so it must be modified with the UI mutex held. Removing the
+ * overlay does not repaint the area; it is meant to be removed together with a view
+ * change that redraws it.
+ *
+ * @param pixels Surface pixels in native byte order, row-major, or NULL to remove it
+ * @param x Left edge on screen
+ * @param y Top edge on screen
+ * @param w Width in pixels, also the row stride
+ * @param h Height in pixels
+ */
+void slint_platform_set_overlay(const uint16_t* pixels, int x, int y, int w, int h);
+
+/**
+ * @brief Draw an 8-bit palette-indexed surface over the UI
+ *
+ * Same as slint_platform_set_overlay(), but the surface stores one byte per pixel and
+ * is expanded through the palette as it is copied into the frame or line buffers.
+ *
+ * @param pixels Palette indices, row-major, or NULL to remove the overlay
+ * @param palette RGB565 color of each index, native byte order; must stay valid while shown
+ * @param x Left edge on screen
+ * @param y Top edge on screen
+ * @param w Width in pixels, also the row stride
+ * @param h Height in pixels
+ */
+void slint_platform_set_overlay_index8(const uint8_t* pixels,
+                                       const uint16_t* palette,
+                                       int x,
+                                       int y,
+                                       int w,
+                                       int h);
+
+/**
+ * @brief Mark the overlay as changed so the next frame sends it to the panel
+ */
+void slint_platform_overlay_changed(void);
+
+/**
+ * @brief Get render pipeline statistics
+ *
+ * @param out Destination for the statistics
+ */
+void slint_platform_get_stats(slint_render_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SLINT_PLATFORM_H */
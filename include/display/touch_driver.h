@@ -0,0 +1,108 @@
+#ifndef TOUCH_DRIVER_H
+#define TOUCH_DRIVER_H
+
+#include <cstdint>
+
+#include "common/spsc_queue.h"
+#include "display/touch_tracker.h"
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Touch task configuration
+#define TOUCH_TASK_PRIORITY 6  // Above the render task so samples are taken on time
+#define TOUCH_TASK_STACK 3072
+#define TOUCH_SAMPLE_PERIOD_MS 10  // Sampling interval while the panel is touched
+#define TOUCH_QUEUE_SIZE 32        // Events buffered for the UI, power of two
+
+// FT6236 on I2C
+#define TOUCH_I2C_ADDRESS 0x38
+#define TOUCH_I2C_TIMEOUT_MS 10
+#define FT6236_REG_G_MODE 0xA4     // 0: INT held low while touched, 1: INT pulses per report
+#define FT6236_REG_VENDOR_ID 0xA8
+#define FT6236_VENDOR_ID 0x11
+
+// Touch driver statistics
+typedef struct {
+    uint32_t irq_count;    // Touch interrupts
+    uint32_t samples;      // Controller reads
+    uint32_t read_errors;  // Reads the controller did not acknowledge
+    uint32_t events;       // Events queued for the UI
+    uint32_t dropped;      // Events lost because the queue was full
+    uint32_t max_read_us;  // Longest controller read
+} touch_stats_t;
+
+/**
+ * @brief Interrupt-driven FT6236 capacitive touch driver
+ *
+ * The controller sits on its own I2C bus, away from the display's SPI host. Its INT
+ * line wakes a sampling task; nothing touches the bus while the panel is idle. While
+ * touched, the task reads the first touch point in one I2C burst every
+ * TOUCH_SAMPLE_PERIOD_MS, debounces it with a TouchTracker and queues timestamped
+ * events into a lock-free queue drained by the UI task.
+ */
+class TouchDriver {
+private:
+    i2c_port_t port;
+    int irq_pin;
+    TaskHandle_t task_handle;
+    int64_t irq_time_us;
+    TouchTracker tracker;
+    SpscQueue<touch_event_t, TOUCH_QUEUE_SIZE> events;
+    touch_stats_t stats;
+    bool initialized;
+
+    static void taskEntry(void *arg);
+    static void irqHandler(void *arg);
+    esp_err_t readRegisters(uint8_t reg, uint8_t *data, size_t len);
+    bool sample(uint16_t *x, uint16_t *y);
+    void pushEvent(const touch_event_t &event);
+    void trackContact();
+
+public:
+    TouchDriver();
+
+    /**
+     * @brief Install the I2C driver, check the controller and start the sampling task
+     *
+     * @param port I2C port used only by the touch controller
+     * @param sda_pin I2C data pin
+     * @param scl_pin I2C clock pin
+     * @param irq_pin Controller INT pin (active low)
+     * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no FT6236 answers, or error code
+     */
+    esp_err_t init(i2c_port_t port, int sda_pin, int scl_pin, int irq_pin);
+
+    /**
+     * @brief Pop the oldest touch event (single consumer)
+     *
+     * @param out Destination for the event
+     * @return false if no event is pending
+     */
+    bool popEvent(touch_event_t *out);
+
+    /**
+     * @brief Get touch driver statistics
+     *
+     * @param out Destination for the statistics
+     */
+    void getStats(touch_stats_t *out) const;
+};
+
+// Global instance
+extern TouchDriver touch_driver;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool touch_pop_event(touch_event_t *out);
+void touch_get_stats(touch_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TOUCH_DRIVER_H */
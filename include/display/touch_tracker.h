@@ -0,0 +1,92 @@
+#ifndef TOUCH_TRACKER_H
+#define TOUCH_TRACKER_H
+
+#include <cstdbool>
+#include <cstdint>
+
+// FT6236 report: TD_STATUS, P1_XH, P1_XL, P1_YH, P1_YL read in one burst from TD_STATUS
+#define FT6236_REG_TD_STATUS 0x02
+#define FT6236_REPORT_BYTES 5
+#define FT6236_MAX_TOUCHES 2
+
+// FT6236 P1_XH event flag, bits 7:6
+#define FT6236_EVENT_DOWN 0
+#define FT6236_EVENT_UP 1
+#define FT6236_EVENT_CONTACT 2
+#define FT6236_EVENT_NONE 3
+
+// Contact debouncing
+#define TOUCH_PRESS_SAMPLES 2    // Consecutive valid samples before a press is reported
+#define TOUCH_RELEASE_SAMPLES 2  // Consecutive invalid samples before a release is reported
+#define TOUCH_MOVE_THRESHOLD 2   // Pixels a contact must move to report a move event
+
+typedef enum {
+    TOUCH_EVENT_PRESS = 0,
+    TOUCH_EVENT_MOVE,
+    TOUCH_EVENT_RELEASE,
+} touch_event_type_t;
+
+// Decoded touch event
+typedef struct {
+    touch_event_type_t type;
+    uint16_t x;
+    uint16_t y;
+    int64_t timestamp_us;  // Touch IRQ edge for a press, sample time otherwise
+} touch_event_t;
+
+/**
+ * @brief Decode the first touch point of an FT6236 report
+ *
+ * @param report FT6236_REPORT_BYTES bytes read from FT6236_REG_TD_STATUS
+ * @param x Display column of the contact, clamped to the panel
+ * @param y Display row of the contact, clamped to the panel
+ * @return true if the report holds a contact, false if the finger is up or the report
+ *         is invalid
+ */
+bool touch_decode_ft6236(const uint8_t *report, uint16_t *x, uint16_t *y);
+
+/**
+ * @brief Turns the samples of one contact into debounced press, move and release events
+ *
+ * Pure logic without I/O or timing, so recorded traces can be replayed on the host.
+ * begin() starts a contact at the IRQ edge, update() takes one sample and
+ * finished() tells the sampling loop when to go back to waiting for the IRQ.
+ */
+class TouchTracker {
+private:
+    bool down;
+    int valid;
+    int invalid;
+    uint16_t last_x;
+    uint16_t last_y;
+    int64_t irq_time_us;
+
+public:
+    TouchTracker();
+
+    /**
+     * @brief Start tracking a contact
+     *
+     * @param irq_time_us Time of the IRQ edge, used as the press timestamp
+     */
+    void begin(int64_t irq_time_us);
+
+    /**
+     * @brief Feed one sample
+     *
+     * @param contact The controller reported a contact
+     * @param x Display column of the contact
+     * @param y Display row of the contact
+     * @param now_us Sample time
+     * @param out Destination for the event, if any
+     * @return true if the sample produced an event
+     */
+    bool update(bool contact, uint16_t x, uint16_t y, int64_t now_us, touch_event_t *out);
+
+    /**
+     * @brief The contact is over, or was a glitch that never became a press
+     */
+    bool finished() const;
+};
+
+#endif /* TOUCH_TRACKER_H */
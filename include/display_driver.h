@@ -12,9 +12,6 @@ private:
     int width;
     int height;
     bool initialized;
-    
-    // Private methods for internal implementation
-    static bool touchEventHandler(uint16_t* x, uint16_t* y);
 
 public:
     /**
@@ -54,6 +51,22 @@ public:
      * This should be called in the main rendering loop to update the UI
      */
     void tick();
+
+    /**
+     * @brief Send a block of RGB565 pixels to the panel
+     *
+     * The region is split into bands of at most one SPI bus chunk. The bus is released
+     * between bands so a pending sensor read on the shared host has bounded latency.
+     * Blocks until the last band has been transferred.
+     *
+     * @param x Left edge of the region
+     * @param y Top edge of the region
+     * @param w Width of the region in pixels
+     * @param h Height of the region in pixels
+     * @param pixels Contiguous w*h pixel block in panel byte order
+     * @return ESP_OK on success, error code otherwise
+     */
+    esp_err_t flush(int x, int y, int w, int h, const uint16_t* pixels);
 };
 
 // Global instance
@@ -67,12 +80,23 @@ extern "C" {
 esp_err_t display_init(void);
 void display_slint_acquire(void);
 void display_slint_release(void);
+esp_err_t display_flush(int x, int y, int w, int h, const uint16_t* pixels);
+
+/**
+ * @brief Register a function run on the render task at the start of every UI tick
+ *
+ * The hook runs with the UI mutex held, before touch events, timers and rendering.
+ * It is where state published by other tasks is applied to the UI, so those tasks
+ * never have to take the UI mutex themselves.
+ *
+ * @param hook Function to run, or NULL to remove it
+ */
+void display_set_frame_start_hook(void (*hook)(void));
 
 // Slint function prototypes - implemented in display_driver.cpp
 // These are internal to the display driver, but declared here to make
 // them available to the Slint bindings
 void slint_init_with_custom_renderer(int width, int height, void* panel_handle);
-void slint_register_touch_event_handler(bool (*handler)(uint16_t* x, uint16_t* y));
 void slint_tick(void);
 
 #ifdef __cplusplus
@@ -0,0 +1,143 @@
+#ifndef VOLUMETRIC_DOSE_H
+#define VOLUMETRIC_DOSE_H
+
+#include <atomic>
+#include <cstdbool>
+#include <cstdint>
+
+#include "esp_attr.h"
+
+// Flow meter 1 calibration, FLOW_METER_PULSES_PER_ML in hardware/hardware_control.h
+#define DOSE_PULSES_PER_ML 5.5f
+
+// Outputs cut at the target; the dimmer (pump) is always cut
+#define DOSE_CUT_SSR_MASK 0  // SSRs closed as well, e.g. (1u << 1) for Valve 1
+
+// Drip compensation: volume that still flows after the cutoff, learned per shot
+#define DOSE_DRIP_INITIAL_ML 2.0f  // Estimate before the first shot
+#define DOSE_DRIP_MAX_ML 10.0f     // Learned drip is clamped to this
+#define DOSE_DRIP_GAIN 0.3f        // Weight of the newest shot in the learned drip
+#define DOSE_SETTLE_MS 3000        // Shot ends this long after the last pulse
+
+typedef enum {
+    DOSE_STATE_IDLE = 0,
+    DOSE_STATE_ARMED,     // Counting towards the cutoff pulse
+    DOSE_STATE_SETTLING,  // Outputs cut, counting the drip
+} dose_state_t;
+
+// Dosing statistics since boot
+typedef struct {
+    uint32_t shots;           // Doses that reached their cutoff
+    uint32_t cancelled;       // Doses cancelled before the cutoff
+    float target_ml;          // Last target volume
+    float volume_ml;          // Last delivered volume, drip included
+    float error_ml;           // Last delivered minus target volume
+    float mean_abs_error_ml;  // Mean |error| over all shots
+    float max_abs_error_ml;   // Worst |error|
+    float drip_ml;            // Learned drip, subtracted from the next target
+    uint32_t last_cut_us;     // Cutoff pulse seen to outputs cut, last shot
+    uint32_t max_cut_us;      // Worst cutoff time
+} dose_stats_t;
+
+/**
+ * @brief Volumetric shot cutoff driven by the flow meter interrupt
+ *
+ * arm() turns a target volume into a pulse count, less the learned drip. Every pulse
+ * of flow meter 1 calls onPulseFromIsr() from the GPIO interrupt; the pulse that
+ * reaches the count cuts the pump (and DOSE_CUT_SSR_MASK) right there, so the shot
+ * stops within one pulse instead of one 50 ms control cycle.
+ *
+ * The control task calls poll() every cycle. It reports the cutoff once so the
+ * controller can stop the profile and zero its setpoint, then waits until no pulse
+ * has arrived for DOSE_SETTLE_MS. The pulses after the cutoff are the drip; they
+ * update the learned drip and the shot-to-shot error statistics, and the outputs are
+ * released.
+ *
+ * The pulse counter and the state are shared with the interrupt through atomics;
+ * everything else belongs to the control task.
+ */
+class VolumetricDose {
+private:
+    std::atomic<uint32_t> pulses;     // Flow meter 1 pulses since boot, never reset
+    std::atomic<int> state;           // dose_state_t
+    uint32_t cut_pulse;               // Pulse count that triggers the cutoff
+    uint32_t start_pulse;             // Pulse count when the dose was armed
+    std::atomic<uint32_t> cut_count;  // Pulse count at the cutoff
+    volatile uint32_t cut_us;         // Time the ISR took to cut the outputs
+    volatile uint32_t last_pulse_us;  // Time of the last pulse while settling
+    bool cut_reported;
+    float target_ml;
+    dose_stats_t stats;
+
+    void finish();
+
+public:
+    VolumetricDose();
+
+    /**
+     * @brief Count one flow meter pulse; cuts the outputs at the target (ISR only)
+     */
+    void IRAM_ATTR onPulseFromIsr();
+
+    /**
+     * @brief Arm a dose (control task)
+     *
+     * Replaces a dose that is armed; a dose that is settling is finished first.
+     *
+     * @param target_ml Volume to deliver, drip included
+     * @return false if the target is not above the learned drip
+     */
+    bool arm(float target_ml);
+
+    /**
+     * @brief Disarm without cutting the outputs (control task)
+     */
+    void cancel();
+
+    /**
+     * @brief Track the dose once per control cycle (control task)
+     *
+     * @return true once, in the first cycle after the cutoff
+     */
+    bool poll();
+
+    /**
+     * @brief Volume since the dose was armed
+     */
+    float volumeMl() const;
+
+    dose_state_t getState() const { return (dose_state_t)state.load(); }
+
+    /**
+     * @brief Flow meter 1 pulses since boot; differences give exact volumes
+     */
+    uint32_t pulseCount() const { return pulses.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get dosing statistics
+     *
+     * @param out Destination for the statistics
+     */
+    void getStats(dose_stats_t* out) const;
+};
+
+// Global instance
+extern VolumetricDose volumetric_dose;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void dose_on_pulse_from_isr(void);
+bool dose_arm(float target_ml);
+void dose_cancel(void);
+bool dose_poll(void);
+void dose_get_stats(dose_stats_t* out);
+uint32_t dose_pulse_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VOLUMETRIC_DOSE_H */
@@ -0,0 +1,65 @@
+#ifndef GPIO_CLAIMS_H
+#define GPIO_CLAIMS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+
+#define GPIO_CLAIM_PIN_COUNT 49  // ESP32-S3 GPIO 0-48
+
+/**
+ * @brief Record of which driver uses each GPIO
+ *
+ * Every driver claims its pins before configuring them, so two drivers wired to the
+ * same GPIO fail at boot with both names in the log instead of one silently
+ * reconfiguring the other's pin. Pins are claimed and released during init from one
+ * task and are not locked.
+ */
+class GpioClaims {
+private:
+    const char* users[GPIO_CLAIM_PIN_COUNT];
+
+public:
+    GpioClaims();
+
+    /**
+     * @brief Claim a GPIO for a driver
+     *
+     * @param pin GPIO number; negative pins (not connected) are accepted and not recorded
+     * @param user Driver name, kept by pointer
+     * @return ESP_OK, ESP_ERR_INVALID_STATE if another driver has the pin, or
+     *         ESP_ERR_INVALID_ARG if there is no such GPIO
+     */
+    esp_err_t claim(int pin, const char* user);
+
+    /**
+     * @brief Claim several GPIOs for a driver, all or none
+     *
+     * @param pins GPIO numbers, negative entries are skipped
+     * @param count Number of pins
+     * @param user Driver name, kept by pointer
+     * @return ESP_OK, or the error of the first pin that could not be claimed
+     */
+    esp_err_t claimAll(const int* pins, size_t count, const char* user);
+
+    /**
+     * @brief Release a GPIO
+     *
+     * @param pin GPIO number; negative or unclaimed pins are ignored
+     */
+    void release(int pin);
+
+    /**
+     * @brief Driver that has a GPIO
+     *
+     * @param pin GPIO number
+     * @return Driver name, or nullptr if the pin is free
+     */
+    const char* user(int pin) const;
+};
+
+// Global instance
+extern GpioClaims gpio_claims;
+
+#endif /* GPIO_CLAIMS_H */
@@ -13,26 +13,30 @@
 #include "driver/ledc.h"
 #include "esp_log.h"
 
-// Constants and definitions
+// Constants and definitions. Every pin is claimed in gpio_claims at init: GPIO 9-15 belong
+// to the display (tft_config.h), 2/4/5 to touch (platformio.ini), and 39-42 are the JTAG
+// pins, free while the console uses USB-JTAG.
 #define ADC_PRESSURE_CHANNEL ADC1_CHANNEL_0  // Pressure transducer ADC channel
-#define DIMMER_PIN GPIO_NUM_12               // AC Dimmer control pin
+#define DIMMER_PIN GPIO_NUM_21               // AC Dimmer control pin
 
 // SSR pins - multiple relays
 #define SSR_COUNT 4            // Number of SSR relays
-#define SSR_PIN_1 GPIO_NUM_13  // Heater SSR
+#define SSR_PIN_1 GPIO_NUM_39  // Heater SSR
 #define SSR_PIN_2 GPIO_NUM_16  // Additional SSR 2
 #define SSR_PIN_3 GPIO_NUM_17  // Additional SSR 3
 #define SSR_PIN_4 GPIO_NUM_18  // Additional SSR 4
 
-// MAX6675 thermocouple interface pins
-#define MAX6675_CS_PIN GPIO_NUM_10
-#define MAX6675_SCK_PIN GPIO_NUM_11
-#define MAX6675_MISO_PIN GPIO_NUM_9
+// MAX6675 thermocouple interface, on its own host: SPI2 and GPIO 9-15 belong to the display
+#define MAX6675_SPI_HOST SPI3_HOST
+#define MAX6675_CS_PIN GPIO_NUM_6
+#define MAX6675_SCK_PIN GPIO_NUM_7
+#define MAX6675_MISO_PIN GPIO_NUM_8
 #define MAX6675_MOSI_PIN -1  // Not used for MAX6675
 
 // Flow meter pins (interrupts)
-#define FLOW_METER1_PIN GPIO_NUM_14
-#define FLOW_METER2_PIN GPIO_NUM_15
+#define FLOW_METER1_PIN GPIO_NUM_40
+#define FLOW_METER2_PIN GPIO_NUM_41
+#define FLOW_METER_PULSES_PER_ML 5.5f  // Both flow meters
 
 // C++ class to handle hardware control
 class HardwareControl {
@@ -42,12 +46,23 @@ private:
     uint32_t dimmer_level;
     bool ssr_states[SSR_COUNT];
     spi_device_handle_t max6675_spi;
+    int max6675_bus_id;                  // Device id in the SPI bus manager
+    volatile uint32_t ssr_lockout_mask;  // SSRs held off by the safety interlock
+    volatile bool dimmer_lockout;        // Dimmer held at zero by the safety interlock
+    bool lockout_warned;                 // A blocked request was logged since the trip
+    volatile uint32_t cutoff_ssr_mask;   // SSRs held off by a volumetric cutoff
+    volatile bool pump_cutoff;           // Dimmer held at zero by a volumetric cutoff
+
+    // Guards the lockout and cutoff state together with the output writes, so a setter
+    // cannot pass its checks, be preempted by forceSafe() or cutPumpFromIsr(), and then
+    // switch the output back on. Taken from the flow meter interrupt as well.
+    portMUX_TYPE output_lock;
 
 public:
     // Public static constants
     static const uint8_t SSR_PINS[SSR_COUNT];
     static const char* SSR_NAMES[SSR_COUNT];
-    static uint32_t flow_meter1_count;
+    static uint32_t flow_meter1_count;  // Pulses since boot, never reset; read atomically
     static uint32_t flow_meter2_count;
 
     // Constructor
@@ -118,12 +133,51 @@ public:
      */
     void setAllSSR(bool state);
 
+    /**
+     * @brief Force outputs off and hold them off until clearSafetyLockout()
+     *
+     * Writes the pins directly without logging so the safety interlock gets a bounded
+     * reaction time. While locked out, requests to switch the affected outputs on are
+     * ignored; the first one after the trip is logged.
+     *
+     * @param ssr_mask Bit mask of SSRs to switch off (bit 0 = SSR 0)
+     * @param dimmer_off true to drive the dimmer to zero
+     */
+    void forceSafe(uint32_t ssr_mask, bool dimmer_off);
+
+    /**
+     * @brief Release outputs held off by forceSafe()
+     */
+    void clearSafetyLockout();
+
+    /**
+     * @brief Cut the pump, and the SSRs in ssr_mask, from an interrupt
+     *
+     * Used by the volumetric dose when the target pulse arrives. Like forceSafe() the
+     * outputs stay off, silently, until releasePumpCutoff().
+     *
+     * @param ssr_mask Bit mask of SSRs to switch off (bit 0 = SSR 0)
+     */
+    void IRAM_ATTR cutPumpFromIsr(uint32_t ssr_mask);
+
+    /**
+     * @brief Release outputs held off by cutPumpFromIsr()
+     */
+    void releasePumpCutoff();
+
     /**
      * @brief Get MAX6675 SPI handle
      *
      * @return SPI device handle for MAX6675
      */
     spi_device_handle_t getMax6675Handle() const { return max6675_spi; }
+
+    /**
+     * @brief Get the SPI bus manager device id of the MAX6675
+     *
+     * @return Device id for spi_bus_manager transactions
+     */
+    int getMax6675BusId() const { return max6675_bus_id; }
 };
 
 // Global instance
@@ -144,6 +198,8 @@ void hw_set_dimmer(uint32_t level);
 void hw_set_ssr_state(int index, bool state);
 void hw_set_ssr_pwm(int index, float pwm);
 void hw_set_all_ssr(bool state);
+void hw_force_safe(uint32_t ssr_mask, bool dimmer_off);
+void hw_clear_safety_lockout(void);
 void hardware_control_init(void);
 
 #ifdef __cplusplus
@@ -24,6 +24,11 @@ private:
     float input;        // Current process value
     float output;       // Controller output
 
+    // Terms of the last computed output
+    float p_term;
+    float i_term;
+    float d_term;
+
     // State variables
     float error_sum;    // Integrated error 
     float last_error;   // Previous error for derivative calc
@@ -113,6 +118,20 @@ public:
      * @return Current setpoint value
      */
     float getSetpoint() const { return setpoint; }
+
+    /**
+     * @brief Get the proportional, integral and derivative terms of the last output
+     *
+     * @param p Destination for the proportional term
+     * @param i Destination for the integral term
+     * @param d Destination for the derivative term
+     */
+    void getTerms(float* p, float* i, float* d) const
+    {
+        *p = p_term;
+        *i = i_term;
+        *d = d_term;
+    }
 };
 
 // For backward compatibility with C code
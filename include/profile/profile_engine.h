@@ -0,0 +1,177 @@
+#ifndef PROFILE_ENGINE_H
+#define PROFILE_ENGINE_H
+
+#include <cstdbool>
+#include <cstdint>
+
+// Longest profile the compiler accepts, see scripts/build_profiles.py
+#define PROFILE_MAX_SEGMENTS 16
+
+typedef enum {
+    PROFILE_SEG_STEP = 0,  // Jump to the target pressure
+    PROFILE_SEG_RAMP,      // Move linearly from the entry setpoint to the target over ramp_ms
+    PROFILE_SEG_HOLD,      // Keep the setpoint the segment was entered with
+} profile_segment_type_t;
+
+// Segment exit conditions; a segment ends when any of its conditions is met
+#define PROFILE_EXIT_TIME (1u << 0)            // Segment time reached exit_time_ms
+#define PROFILE_EXIT_VOLUME (1u << 1)          // Shot volume reached exit_volume_ml
+#define PROFILE_EXIT_PRESSURE_ABOVE (1u << 2)  // Pressure rose to exit_pressure
+#define PROFILE_EXIT_PRESSURE_BELOW (1u << 3)  // Pressure fell to exit_pressure
+
+// One compiled segment; all values are in controller units (PSI, ms, mL)
+typedef struct {
+    uint8_t type;          // profile_segment_type_t
+    uint8_t exits;         // PROFILE_EXIT_* mask
+    float target;          // Pressure setpoint, PSI (unused by PROFILE_SEG_HOLD)
+    uint32_t ramp_ms;      // Ramp length (PROFILE_SEG_RAMP)
+    uint32_t exit_time_ms;
+    float exit_volume_ml;  // Volume since the shot started
+    float exit_pressure;   // PSI
+    const char* name;
+} profile_segment_t;
+
+// One compiled profile
+typedef struct {
+    const char* name;
+    const profile_segment_t* segments;
+    int segment_count;
+} profile_t;
+
+typedef enum {
+    PROFILE_STATE_IDLE = 0,  // No profile has run since boot or the last stop()
+    PROFILE_STATE_RUNNING,
+    PROFILE_STATE_DONE,  // The last segment exited
+} profile_state_t;
+
+// Progress of the running (or last) profile
+typedef struct {
+    profile_state_t state;
+    int profile;               // Index into the profile table, -1 if none
+    int segment;               // Current segment, -1 if none
+    const char* segment_name;  // Name of the current segment, else "IDLE" or "DONE"
+    uint32_t shot_ms;          // Time since start()
+    uint32_t segment_ms;       // Time in the current segment
+    float volume_ml;           // Volume since start()
+    float setpoint;            // Last setpoint returned by tick(), PSI
+} profile_status_t;
+
+/**
+ * @brief Runs compiled extraction profiles in the control loop
+ *
+ * Profiles are authored as JSON under profiles/ and compiled at build time by
+ * scripts/build_profiles.py into constant segment tables linked into flash, so
+ * starting a shot parses and loads nothing.
+ *
+ * tick() is called once per control cycle. It checks the exit conditions of the
+ * current segment only, moves on at most one segment per cycle and evaluates the
+ * setpoint with a multiply-add; it never allocates or loops over the table. A ramp
+ * starts from the setpoint the previous segment ended at, so a segment that exits
+ * early never causes a jump.
+ *
+ * Control task only.
+ */
+class ProfileEngine {
+private:
+    const profile_t* profiles;
+    int profile_count;
+
+    // Running profile
+    profile_state_t state;
+    int profile;
+    int segment;
+    uint32_t start_ms;
+    uint32_t segment_start_ms;
+    uint32_t last_tick_ms;
+    float entry_setpoint;  // Setpoint when the current segment was entered
+    float slope;           // PSI per ms of the current ramp
+    float setpoint;
+    float volume_ml;       // Last volume passed to tick()
+
+    void enterSegment(int index, uint32_t now_ms);
+    float segmentSetpoint(const profile_segment_t& seg, uint32_t elapsed_ms) const;
+    bool segmentDone(const profile_segment_t& seg, uint32_t elapsed_ms, float pressure) const;
+
+public:
+    ProfileEngine(const profile_t* profiles, int profile_count);
+
+    /**
+     * @brief Number of compiled profiles
+     */
+    int count() const { return profile_count; }
+
+    /**
+     * @brief Get a compiled profile
+     *
+     * @param index Profile index
+     * @return The profile, or nullptr if index is out of range
+     */
+    const profile_t* get(int index) const;
+
+    /**
+     * @brief Find a profile by name
+     *
+     * @param name Profile name
+     * @return Profile index, or -1 if there is none with that name
+     */
+    int find(const char* name) const;
+
+    /**
+     * @brief Start a profile from its first segment
+     *
+     * @param index Profile index
+     * @param now_ms Current time in milliseconds
+     * @return false if index is out of range
+     */
+    bool start(int index, uint32_t now_ms);
+
+    /**
+     * @brief Abort the running profile; the setpoint drops to zero
+     */
+    void stop();
+
+    /**
+     * @brief Whether a profile is running
+     */
+    bool isRunning() const { return state == PROFILE_STATE_RUNNING; }
+
+    /**
+     * @brief Advance the running profile by one control cycle
+     *
+     * @param now_ms Current time in milliseconds
+     * @param pressure Measured pressure, PSI
+     * @param volume_ml Volume delivered since start(), counted from flow meter pulses;
+     *                  the flow rate readout is too coarse to integrate
+     * @return Pressure setpoint for this cycle, PSI; zero once the profile is done
+     */
+    float tick(uint32_t now_ms, float pressure, float volume_ml);
+
+    /**
+     * @brief Get the progress of the running or last profile
+     *
+     * @param out Destination for the status
+     */
+    void getStatus(profile_status_t* out) const;
+};
+
+// Global instance, running the profiles compiled into the firmware
+extern ProfileEngine profile_engine;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int profile_engine_count(void);
+const char* profile_engine_name(int index);
+bool profile_engine_start(int index, uint32_t now_ms);
+void profile_engine_stop(void);
+bool profile_engine_is_running(void);
+float profile_engine_tick(uint32_t now_ms, float pressure, float volume_ml);
+void profile_engine_get_status(profile_status_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILE_ENGINE_H */
@@ -0,0 +1,120 @@
+#ifndef SHOT_FILE_H
+#define SHOT_FILE_H
+
+#include <cstdbool>
+#include <cstddef>
+#include <cstdint>
+
+// Shot file layout (little endian, must match scripts/decode_shot.py):
+//
+//   header   magic "SHOT", u16 version, u16 channel_count, u32 frame_count,
+//            u32 shot_index, u32 start_ms
+//   channels channel_count x { char name[12], char unit[8], f32 scale }
+//   data     u32 time_ms[frame_count], then i16 value[frame_count] per channel
+//
+// A channel value is raw * scale in its unit; time_ms counts from the first frame.
+#define SHOT_FILE_MAGIC "SHOT"
+#define SHOT_FILE_VERSION 1
+#define SHOT_CHANNEL_NAME_LEN 12
+#define SHOT_CHANNEL_UNIT_LEN 8
+
+// Recorded channels, one int16_t column each
+typedef enum {
+    SHOT_CH_TEMPERATURE = 0,
+    SHOT_CH_PRESSURE,
+    SHOT_CH_FLOW1,
+    SHOT_CH_FLOW2,
+    SHOT_CH_VOLUME1,  // Flow meter volumes since the first frame
+    SHOT_CH_VOLUME2,
+    SHOT_CH_PRESSURE_SETPOINT,
+    SHOT_CH_PRESSURE_P,  // Pressure PID terms
+    SHOT_CH_PRESSURE_I,
+    SHOT_CH_PRESSURE_D,
+    SHOT_CH_DIMMER,
+    SHOT_CH_SSR1,  // SSR duty cycles
+    SHOT_CH_SSR2,
+    SHOT_CH_SSR3,
+    SHOT_CH_SSR4,  // One per SSR_COUNT
+    SHOT_CHANNEL_COUNT
+} shot_channel_t;
+
+// File header
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint16_t version;
+    uint16_t channel_count;
+    uint32_t frame_count;
+    uint32_t shot_index;
+    uint32_t start_ms;
+} shot_file_header_t;
+
+// Channel table entry, written into every file so the decoder needs no knowledge of it
+typedef struct {
+    char name[SHOT_CHANNEL_NAME_LEN];
+    char unit[SHOT_CHANNEL_UNIT_LEN];
+    float scale;  // Unit per raw step
+} shot_channel_info_t;
+
+// One contiguous piece of a shot file
+typedef struct {
+    const void *data;
+    size_t size;
+    bool bulk;  // Frame data, sized by the shot; the header and channel table are small
+} shot_file_section_t;
+
+// Header, channel table, time column and one column per channel
+#define SHOT_FILE_SECTIONS (3 + SHOT_CHANNEL_COUNT)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Names, units and scales of the channels, indexed by shot_channel_t
+extern const shot_channel_info_t SHOT_CHANNELS[SHOT_CHANNEL_COUNT];
+
+/**
+ * @brief Convert a value to raw steps of a channel
+ *
+ * Rounds to the nearest step and saturates at the int16_t range; NaN becomes INT16_MIN.
+ *
+ * @param value Value in the channel's unit
+ * @param channel Channel
+ * @return Raw value
+ */
+int16_t shot_file_to_raw(float value, shot_channel_t channel);
+
+/**
+ * @brief Fill in a file header
+ *
+ * @param header Header to fill
+ * @param frame_count Frames in the shot
+ * @param shot_index Index of the shot
+ * @param start_ms Time of the first frame since boot
+ */
+void shot_file_header(shot_file_header_t *header,
+                      uint32_t frame_count,
+                      uint32_t shot_index,
+                      uint32_t start_ms);
+
+/**
+ * @brief List the pieces of a shot file in file order
+ *
+ * Writing them back to back gives the file, without copying the columns into one
+ * buffer first.
+ *
+ * @param header Header filled by shot_file_header()
+ * @param times Time column, header->frame_count entries
+ * @param columns One column per channel, header->frame_count entries each
+ * @param sections Destination for SHOT_FILE_SECTIONS sections
+ * @return Total file size in bytes
+ */
+size_t shot_file_sections(const shot_file_header_t *header,
+                          const uint32_t *times,
+                          int16_t *const *columns,
+                          shot_file_section_t *sections);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHOT_FILE_H */
@@ -0,0 +1,157 @@
+#ifndef SHOT_RECORDER_H
+#define SHOT_RECORDER_H
+
+#include <atomic>
+#include <cstdbool>
+#include <cstdint>
+
+#include "common/seqlock.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "recorder/shot_file.h"
+
+// Capture limits
+#define SHOT_RECORDER_SAMPLE_US 10000   // Frame period, 100 Hz
+#define SHOT_RECORDER_MAX_FRAMES 12000  // 2 minutes at 100 Hz, then truncated
+#define SHOT_RECORDER_MIN_MS 2000       // Shorter pump runs are blips, not shots
+#define SHOT_RECORDER_END_HOLD_MS 1000  // Pump off this long ends the shot
+
+// Flash commit
+#define SHOT_RECORDER_PARTITION "shots"  // SPIFFS partition label in partitions.csv
+#define SHOT_RECORDER_MOUNT "/shots"
+#define SHOT_RECORDER_MAX_FILES 32       // Older shots are deleted
+#define SHOT_RECORDER_SPARE_BYTES 65536  // Kept free on the partition for SPIFFS garbage collection
+#define SHOT_RECORDER_CHUNK_BYTES 4096   // Written per control cycle
+#define SHOT_RECORDER_PACE_MS 100        // Write anyway if no control cycle paces the commit
+#define SHOT_RECORDER_TASK_STACK 4096
+#define SHOT_RECORDER_TASK_PRIORITY 1  // Just above idle
+#define SHOT_RECORDER_TASK_CORE 0      // Away from the safety interlock
+
+// One control cycle as seen by the recorder. SHOT_CH_PRESSURE, SHOT_CH_VOLUME1 and
+// SHOT_CH_VOLUME2 are sampled by the recorder itself every frame; their values here
+// are ignored.
+typedef struct {
+    bool extracting;  // A shot is in progress; frames are kept only while it is
+    float values[SHOT_CHANNEL_COUNT];  // Indexed by shot_channel_t, in channel units
+} shot_sample_t;
+
+// Recorder statistics since boot
+typedef struct {
+    uint32_t shots_committed;  // Shots written to flash
+    uint32_t shots_discarded;  // Pump runs shorter than SHOT_RECORDER_MIN_MS
+    uint32_t shots_skipped;    // Shots that started while the previous one was committing
+    uint32_t commit_errors;    // Shots lost to filesystem errors
+    uint32_t max_capture_us;   // Worst time spent in capture()
+    uint32_t max_sample_us;    // Worst time spent taking one frame
+    uint32_t last_frames;      // Frames of the last committed shot
+    uint32_t last_bytes;       // File size of the last committed shot
+    uint32_t last_commit_ms;   // Time to write the last shot
+} shot_recorder_stats_t;
+
+/**
+ * @brief Records shots at 100 Hz and commits them to flash afterwards
+ *
+ * The control loop runs at 20 Hz and hands each cycle to capture(), which only
+ * publishes it to a seqlock mailbox, so recording never blocks or delays the loop.
+ * A SHOT_RECORDER_SAMPLE_US esp_timer takes the frames: while a shot is in progress it
+ * reads the pressure ADC and the flow meter pulse counters, takes the other channels
+ * from the newest control cycle, converts the frame to fixed point and appends it to
+ * preallocated PSRAM columns, one per channel. The MAX6675 is not read there: it
+ * converts only every 220 ms and shares an SPI bus, so the temperature repeats
+ * between the control loop's reads. The timer task runs below the control loop's
+ * priority and cannot preempt it.
+ *
+ * When the shot ends a low-priority task writes the columns to a file on the SPIFFS
+ * partition. Flash writes stall the caches of both cores, so the task writes one
+ * SHOT_RECORDER_CHUNK_BYTES chunk per control cycle, woken by capture() right after
+ * the cycle's work, and the stalls fall into the loop's idle time. A shot starting
+ * before the previous one is written is not recorded. The oldest shots are deleted
+ * until the new one fits.
+ *
+ * Files are decoded on the host with scripts/decode_shot.py.
+ */
+class ShotRecorder {
+private:
+    enum State { IDLE, RECORDING, COMMITTING };
+
+    // Columns in one PSRAM block; owned by the sampling timer unless state is COMMITTING
+    uint32_t* times;
+    int16_t* columns[SHOT_CHANNEL_COUNT];
+    uint32_t frame_count;
+    int64_t start_us;
+    int64_t idle_since_us;  // Pump stopped at this time, 0 while it runs
+    uint32_t extracted_ms;  // Frame time of the last frame with the pump running
+    uint32_t shot_index;    // Index of the next file
+    bool skipping;          // Ignore the running shot, it could not be recorded from its start
+
+    // Flow meter pulse counts at the first frame
+    uint32_t start_pulses[2];
+
+    SeqlockMailbox<shot_sample_t> latest;  // Newest control cycle, read by the sampling timer
+    std::atomic<int> state;
+    TaskHandle_t task_handle;
+    esp_timer_handle_t sample_timer;
+    bool initialized;
+    shot_recorder_stats_t stats;
+    mutable portMUX_TYPE stats_lock;  // Guards stats, updated from three tasks
+
+    static void taskEntry(void* arg);
+    static void timerCallback(void* arg);
+    void sample();
+    void append(const float* values, int64_t now_us);
+    void finish();
+    void commit();
+    bool writeChunked(int fd, const void* data, size_t size);
+    bool makeRoom(size_t size);
+    uint32_t scanIndex();
+    bool oldestShot(uint32_t* index);
+
+public:
+    ShotRecorder();
+
+    /**
+     * @brief Allocate the capture columns, mount the shot partition and start the
+     *        commit task and the sampling timer
+     *
+     * @return ESP_OK on success, ESP_ERR_NO_MEM or a SPIFFS error otherwise
+     */
+    esp_err_t init();
+
+    /**
+     * @brief Hand over one control cycle (control task only)
+     *
+     * Frames repeat it until the next cycle. A shot starts when sample->extracting
+     * becomes true and ends SHOT_RECORDER_END_HOLD_MS after it becomes false. Also
+     * paces a pending commit.
+     *
+     * @param sample State of the cycle
+     */
+    void capture(const shot_sample_t* sample);
+
+    /**
+     * @brief Get recorder statistics
+     *
+     * @param out Destination for the statistics
+     */
+    void getStats(shot_recorder_stats_t* out) const;
+};
+
+// Global instance
+extern ShotRecorder shot_recorder;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t shot_recorder_init(void);
+void shot_recorder_capture(const shot_sample_t* sample);
+void shot_recorder_get_stats(shot_recorder_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHOT_RECORDER_H */
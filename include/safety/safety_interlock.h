@@ -0,0 +1,198 @@
+#ifndef SAFETY_INTERLOCK_H
+#define SAFETY_INTERLOCK_H
+
+#include <cstdbool>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sensor_manager/sensor_manager.h"
+
+// Interlock engine timing
+#define SAFETY_EVAL_PERIOD_US 1000     // Periodic rule evaluation interval (1 ms)
+#define SAFETY_REACTION_BOUND_US 5000  // Guaranteed trip-to-safe reaction bound (5 ms)
+#define SAFETY_TASK_CORE 1             // Keep off the WiFi/BT core
+#define SAFETY_TASK_PRIORITY (configMAX_PRIORITIES - 1)  // Strictly above every other task
+#define SAFETY_TASK_STACK 3072
+#define SAFETY_MAX_RULES 8
+#define SAFETY_RESET_TIMEOUT_MS 100  // Wait for the interlock task to run a reset
+
+// Interlock task notification bits
+#define SAFETY_NOTIFY_EVALUATE (1u << 0)  // Timer period or new sensor readings
+#define SAFETY_NOTIFY_RESET (1u << 1)     // reset() requested from another task
+
+// Default interlock limits
+#define SAFETY_MAX_TEMPERATURE 130.0f  // Boiler over-temperature limit (°C)
+#define SAFETY_MAX_PRESSURE 90.0f      // Over-pressure limit (PSI)
+#define SAFETY_SENSOR_FAULT_HOLD_MS 150  // Consecutive -1.0 readings before tripping
+#define SAFETY_STALE_TIMEOUT_MS 500      // Max age of the last valid temperature
+#define SAFETY_DRY_RUN_FLOW 1.0f         // Flow below this counts as zero (mL/min)
+#define SAFETY_DRY_RUN_HOLD_MS 3000      // Pump running without flow before tripping
+
+// Interlock rule types
+typedef enum {
+    SAFETY_RULE_OVER_TEMPERATURE,  // temperature > threshold (°C)
+    SAFETY_RULE_SENSOR_FAULT,      // readTemperature() returned the -1.0 error value
+    SAFETY_RULE_SENSOR_STALE,      // no valid temperature for threshold ms
+    SAFETY_RULE_OVER_PRESSURE,     // pressure > threshold (PSI)
+    SAFETY_RULE_DRY_RUN,           // pump run for a shot while flow <= threshold (mL/min)
+} safety_rule_type_t;
+
+// Actuators forced safe when a rule trips
+#define SAFETY_ACTION_HEATER_OFF (1u << 0)  // SSR 0 (heater)
+#define SAFETY_ACTION_SSR_OFF (1u << 1)     // All SSRs
+#define SAFETY_ACTION_PUMP_OFF (1u << 2)    // Dimmer (pump)
+#define SAFETY_ACTION_ALL_OFF (SAFETY_ACTION_HEATER_OFF | SAFETY_ACTION_SSR_OFF | SAFETY_ACTION_PUMP_OFF)
+
+// A single entry of the interlock rule table
+typedef struct {
+    safety_rule_type_t type;
+    float threshold;   // Limit in the rule's unit (°C, PSI, mL/min or ms)
+    uint32_t hold_ms;  // Violation must persist this long before tripping
+    uint32_t actions;  // SAFETY_ACTION_* mask applied on trip
+} safety_rule_t;
+
+// Reaction time and trip statistics
+typedef struct {
+    uint32_t trip_count;        // Number of trips since boot
+    int last_trip_rule;         // Index of the rule that tripped last, -1 if none
+    int64_t last_reaction_us;   // Violation deadline to actuators-safe, last trip
+    int64_t max_reaction_us;    // Worst reaction time observed
+    int64_t max_eval_us;        // Worst rule table evaluation time
+    uint32_t bound_violations;  // Trips slower than SAFETY_REACTION_BOUND_US
+} safety_stats_t;
+
+/**
+ * @brief Independent safety interlock engine
+ *
+ * Runs in its own task at SAFETY_TASK_PRIORITY, pinned to SAFETY_TASK_CORE. No other task
+ * runs at that priority, so the interlock preempts the control loop it polices as soon
+ * as it is woken instead of waiting for the next tick. The task is
+ * woken every SAFETY_EVAL_PERIOD_US by an esp_timer and immediately whenever new sensor
+ * readings are published, so a violation never waits for the 50 ms sensor loop or the UI
+ * mutex. Trips latch until reset() is called with all conditions cleared.
+ *
+ * Rule state and trips are only touched by the interlock task. reset() hands the
+ * request to that task and waits for its answer, so a trip can never land between the
+ * rule check and the lockout release.
+ */
+class SafetyInterlock {
+private:
+    // Latest sensor snapshot, written by publish() and read by the interlock task
+    struct Snapshot {
+        float temperature;
+        float pressure;
+        float flow_rate;
+        uint32_t dimmer_level;
+        bool pump_running;       // A shot or a manual pump run is in progress
+        int64_t sample_us;       // Time the snapshot was published
+        int64_t last_valid_us;   // Time of the last valid temperature reading
+    };
+
+    safety_rule_t rules[SAFETY_MAX_RULES];
+    int rule_count;
+    int64_t violation_since_us[SAFETY_MAX_RULES];  // 0 when the rule is not violated
+
+    Snapshot snapshot;
+    portMUX_TYPE snapshot_lock;
+
+    volatile bool tripped;
+    volatile uint32_t active_actions;
+    safety_stats_t stats;
+    mutable portMUX_TYPE stats_lock;  // Guards stats against getStats() from other tasks
+
+    SemaphoreHandle_t reset_done;  // Given by the interlock task after a reset request
+    int reset_blocker;             // Rule that refused the last reset, -1 if it cleared
+
+    TaskHandle_t task_handle;
+    esp_timer_handle_t eval_timer;
+    bool initialized;
+
+    static void taskEntry(void* arg);
+    static void timerCallback(void* arg);
+
+    // Returns the onset time of the violation, or 0 when the rule is satisfied
+    int64_t checkRule(const safety_rule_t& rule, const Snapshot& snap, int64_t now_us) const;
+    void evaluate();
+    void trip(int rule_index, int64_t deadline_us);
+    int applyReset();
+
+public:
+    SafetyInterlock();
+
+    /**
+     * @brief Load the default rule table and start the interlock task and timer
+     *
+     * @return ESP_OK on success, or error code
+     */
+    esp_err_t init();
+
+    /**
+     * @brief Replace the rule table
+     *
+     * @param rules Array of rules
+     * @param count Number of rules (at most SAFETY_MAX_RULES)
+     * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the table is too large
+     */
+    esp_err_t setRules(const safety_rule_t* rules, int count);
+
+    /**
+     * @brief Publish fresh sensor readings and wake the interlock task
+     *
+     * Safe to call from any task; the copy is guarded by a spinlock and never blocks.
+     *
+     * @param data Latest sensor data
+     * @param pump_running true while a shot or a manual pump run is in progress. The
+     *                     pressure PID keeps the dimmer above zero at idle, so the dry-run
+     *                     rule only applies while this is set.
+     */
+    void publish(const sensor_data_t* data, bool pump_running);
+
+    /**
+     * @brief Clear a latched trip once no rule is violated any more
+     *
+     * Requested from the control panel through CONTROL_CMD_SAFETY_RESET. Until then the
+     * tripped outputs stay off. Runs on the interlock task; the caller blocks for at most
+     * SAFETY_RESET_TIMEOUT_MS. Must not be called from the interlock task itself.
+     *
+     * @return true if the interlock was cleared, false if a condition is still active
+     */
+    bool reset();
+
+    /**
+     * @brief Check whether the interlock has tripped
+     *
+     * @return true while a trip is latched
+     */
+    bool isTripped() const { return tripped; }
+
+    /**
+     * @brief Get reaction time and trip statistics
+     *
+     * @param out Destination for a copy of the statistics
+     */
+    void getStats(safety_stats_t* out) const;
+};
+
+// Global instance
+extern SafetyInterlock safety_interlock;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t safety_interlock_init(void);
+void safety_interlock_publish(const sensor_data_t* data, bool pump_running);
+bool safety_interlock_reset(void);
+bool safety_interlock_is_tripped(void);
+void safety_interlock_get_stats(safety_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFETY_INTERLOCK_H */
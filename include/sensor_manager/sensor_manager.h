@@ -6,6 +6,7 @@
 
 // Number of data points to store for graphs
 #define SENSOR_HISTORY_LENGTH 120 // 2 minutes of data at 1Hz
+#define SENSOR_FLOW_WINDOW_MS 500  // Flow rates are measured over at least this long
 
 // Sensor data structure to hold all readings
 typedef struct {
@@ -18,6 +19,28 @@ typedef struct {
     float ssr_pwm[4];  // PWM values for each SSR (0.0-1.0)
 } sensor_data_t;
 
+// Read-only view of one channel of the history ring, oldest sample first. Indexes the
+// ring in place, so it stays valid as long as the history itself.
+class HistoryView {
+public:
+    HistoryView(const float* ring, int head, int count)
+        : ring(ring), head(head), count(count)
+    {
+    }
+
+    int size() const { return count; }
+
+    float operator[](int i) const { return ring[(head + i) % SENSOR_HISTORY_LENGTH]; }
+
+    // Sample recorded age samples before the newest one
+    float newest(int age = 0) const { return (*this)[count - 1 - age]; }
+
+private:
+    const float* ring;
+    int head;   // Index of the oldest sample
+    int count;  // Valid samples, at most SENSOR_HISTORY_LENGTH
+};
+
 // Historical sensor data for plotting
 class SensorHistory {
 public:
@@ -26,18 +49,36 @@ public:
     float flow_rate1[SENSOR_HISTORY_LENGTH];
     float flow_rate2[SENSOR_HISTORY_LENGTH];
     int write_index;
+    uint32_t sample_count; // Samples recorded since reset, lets readers tell what is new
     uint32_t last_update_time;
     uint32_t update_interval_ms; // Interval between data points
 
     SensorHistory();
     void reset();
+
+    /**
+     * @brief Get a view of one channel without copying it
+     *
+     * The view is built from sample_count as read by the caller, not from the live
+     * write_index, so it stays consistent while the sensor task keeps recording. The
+     * slot the next sample goes to is left out of it.
+     *
+     * @param channel One of the channel arrays of this history
+     * @param samples sample_count as read by the caller
+     * @return View ordered from the oldest to the newest of the first samples samples
+     */
+    HistoryView view(const float* channel, uint32_t samples) const;
 };
 
 // Sensor manager class
 class SensorManager {
 private:
     spi_device_handle_t max6675_spi;
+    int max6675_bus_id;  // Device id in the SPI bus manager
     bool initialized;
+    uint32_t last_flow_count[2];  // Flow meter pulse counts at the start of the window
+    int64_t last_flow_us;         // Start of the flow rate window, 0 before the first call
+    float last_flow_rate[2];      // Rates of the previous window (mL/min)
     SensorHistory sensor_history;
     
 public:
@@ -68,6 +109,10 @@ public:
     /**
      * @brief Calculate flow rates from pulse counts
      *
+     * The rates are the pulses over the time since the previous measurement, taken at
+     * most every SENSOR_FLOW_WINDOW_MS: one pulse in a 50 ms control cycle would read as
+     * 218 mL/min. Calls within a window return the rates of the previous one.
+     *
      * @param flow1 Pointer to store flow rate 1 (mL/min)
      * @param flow2 Pointer to store flow rate 2 (mL/min)
      */
@@ -0,0 +1,189 @@
+#ifndef SPI_BUS_MANAGER_H
+#define SPI_BUS_MANAGER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "driver/spi_master.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Bus manager limits
+#define SPI_BUS_HOST_COUNT 3   // SPI1_HOST, SPI2_HOST, SPI3_HOST
+#define SPI_BUS_MAX_DEVICES 6  // Devices across all hosts
+#define SPI_BUS_INVALID_DEVICE (-1)
+
+// Per-device bus statistics
+typedef struct {
+    const char* name;
+    uint32_t transactions;  // Bus grants since the last reset
+    uint64_t bytes;         // Bytes transferred while holding the bus
+    uint64_t busy_us;       // Time spent holding the bus
+    uint64_t wait_us_total; // Time spent waiting for the bus
+    uint32_t wait_us_max;   // Longest single wait
+    float utilization;      // busy_us relative to the statistics window (0.0-1.0)
+} spi_bus_device_stats_t;
+
+/**
+ * @brief Owner of the SPI hosts and the pins and devices on them
+ *
+ * The display and the MAX6675 each have a host of their own, so no transfer ever
+ * waits for another device's. The manager keeps it that way: it claims the bus and
+ * chip select GPIOs in gpio_claims, so a pin already in use is refused, and reports
+ * per-device utilization and wait times so a device added to an occupied host shows
+ * up in the logs.
+ *
+ * Every bus access still goes through acquire()/release(), a mutex per host. It costs
+ * nothing while a device has its host to itself and keeps transfers whole if a
+ * second device is ever added.
+ */
+class SpiBusManager {
+private:
+    struct Device {
+        bool used;
+        spi_host_device_t host;
+        int cs_pin;                  // CS GPIO, or -1 if the driver does not say
+        spi_device_handle_t handle;  // nullptr for devices driven through another driver
+        const char* name;
+        int64_t acquired_us;
+        spi_bus_device_stats_t stats;
+    };
+
+    struct Host {
+        bool initialized;
+        SemaphoreHandle_t mutex;  // Held by the device using the bus
+        spi_bus_config_t config;
+    };
+
+    Device devices[SPI_BUS_MAX_DEVICES];
+    Host hosts[SPI_BUS_HOST_COUNT];
+    int64_t window_start_us;
+    portMUX_TYPE lock;  // Guards the statistics
+
+    esp_err_t allocDevice(spi_host_device_t host, int cs_pin, const char* name, int* device_id);
+    bool validDevice(int device_id) const;
+
+public:
+    SpiBusManager();
+
+    /**
+     * @brief Initialize an SPI host if it is not initialized yet
+     *
+     * The first caller configures the bus; later callers share it if they use the same
+     * pins. A bus whose pins are already used by another bus or as a chip select is
+     * refused.
+     *
+     * @param host SPI host to initialize
+     * @param config Bus configuration
+     * @param dma_chan DMA channel selection
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE on a pin conflict, or error code
+     */
+    esp_err_t initHost(spi_host_device_t host,
+                       const spi_bus_config_t* config,
+                       spi_dma_chan_t dma_chan);
+
+    /**
+     * @brief Add a device to a host
+     *
+     * The chip select must not be used by another device or as a bus pin.
+     *
+     * @param host SPI host the device is attached to
+     * @param config Device configuration
+     * @param name Device name used in statistics
+     * @param device_id Output for the bus manager device id
+     * @param handle Output for the SPI device handle
+     * @return ESP_OK on success, ESP_ERR_INVALID_STATE on a pin conflict, or error code
+     */
+    esp_err_t addDevice(spi_host_device_t host,
+                        const spi_device_interface_config_t* config,
+                        const char* name,
+                        int* device_id,
+                        spi_device_handle_t* handle);
+
+    /**
+     * @brief Register a device driven by another driver (e.g. esp_lcd panel IO)
+     *
+     * @param host SPI host the device is attached to
+     * @param cs_pin Chip select GPIO the driver uses, checked like addDevice() does
+     * @param name Device name used in statistics
+     * @return Device id, or SPI_BUS_INVALID_DEVICE on failure
+     */
+    int registerDevice(spi_host_device_t host, int cs_pin, const char* name);
+
+    /**
+     * @brief Remove a device from its host and the bus manager
+     *
+     * @param device_id Device to remove
+     */
+    void removeDevice(int device_id);
+
+    /**
+     * @brief Find the bus manager id of a device added with addDevice()
+     *
+     * @param handle SPI device handle
+     * @return Device id, or SPI_BUS_INVALID_DEVICE if unknown
+     */
+    int findDevice(spi_device_handle_t handle) const;
+
+    /**
+     * @brief Wait for exclusive access to the device's bus
+     *
+     * @param device_id Device requesting the bus
+     * @param timeout Max time to wait
+     * @return ESP_OK once granted, ESP_ERR_TIMEOUT on timeout
+     */
+    esp_err_t acquire(int device_id, TickType_t timeout);
+
+    /**
+     * @brief Release the bus
+     *
+     * @param device_id Device holding the bus
+     * @param bytes Bytes transferred during this grant, for statistics
+     */
+    void release(int device_id, size_t bytes);
+
+    /**
+     * @brief Run a polling transaction with the bus held
+     *
+     * @param device_id Device added with addDevice()
+     * @param trans Transaction descriptor
+     * @return ESP_OK on success, or error code
+     */
+    esp_err_t transmit(int device_id, spi_transaction_t* trans);
+
+    /**
+     * @brief Get bus statistics for a device
+     *
+     * @param device_id Device id
+     * @param out Destination for the statistics
+     */
+    void getStats(int device_id, spi_bus_device_stats_t* out);
+
+    /**
+     * @brief Log utilization and wait times of all devices and start a new window
+     */
+    void logStats();
+};
+
+// Global instance
+extern SpiBusManager spi_bus_manager;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t spi_bus_manager_init_host(spi_host_device_t host,
+                                    const spi_bus_config_t* config,
+                                    spi_dma_chan_t dma_chan);
+esp_err_t spi_bus_manager_acquire(int device_id, TickType_t timeout);
+void spi_bus_manager_release(int device_id, size_t bytes);
+esp_err_t spi_bus_manager_transmit(int device_id, spi_transaction_t* trans);
+void spi_bus_manager_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPI_BUS_MANAGER_H */
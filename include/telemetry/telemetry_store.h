@@ -0,0 +1,226 @@
+#ifndef TELEMETRY_STORE_H
+#define TELEMETRY_STORE_H
+
+#include <atomic>
+#include <cstdbool>
+#include <cstddef>
+#include <cstdint>
+
+#include "common/spsc_queue.h"
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sensor_manager/sensor_manager.h"
+
+// Partition, see partitions.csv
+#define TELEMETRY_PARTITION_LABEL "telemetry"
+#define TELEMETRY_PARTITION_SUBTYPE ((esp_partition_subtype_t)0x41)
+
+// Sampling and write batching
+#define TELEMETRY_SAMPLE_INTERVAL_MS 10000  // One record per interval, averaged over it
+#define TELEMETRY_PAGE_RECORDS 16           // Records per flash page, the most written at once
+#define TELEMETRY_FLUSH_INTERVAL_MS 60000   // Write a partial page after this long
+#define TELEMETRY_QUEUE_SIZE 8              // Records waiting for the writer, power of two
+#define TELEMETRY_TASK_STACK 3072
+#define TELEMETRY_TASK_PRIORITY 1  // Just above idle
+#define TELEMETRY_TASK_CORE 0      // Away from the safety interlock
+
+// Sector layout: a header alone in the first page, then fixed-size records from the
+// second page to the end of the sector
+#define TELEMETRY_SECTOR_SIZE 4096  // Flash erase unit
+#define TELEMETRY_PAGE_SIZE 256     // Flash program unit
+#define TELEMETRY_MAGIC 0x42445354  // "TSDB"
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_MAX_SECTORS 512  // Size of the RAM index; larger partitions are truncated
+
+// Fault bits of a record
+#define TELEMETRY_FAULT_SENSOR (1u << 15)  // Temperature sensor returned an error
+// Bits 0-14: interlock rule that tripped (1 << rule index)
+
+// One telemetry record as stored in flash
+typedef struct __attribute__((packed)) {
+    uint32_t time_s;      // Store time, see TelemetryStore::now()
+    int16_t temperature;  // 0.1 °C, INT16_MIN if the sensor failed all interval
+    uint16_t pressure;    // 0.01 PSI
+    uint8_t heater_duty;  // SSR 0 duty, 0-255
+    uint8_t pump_duty;    // Dimmer level, 0-255
+    uint16_t flow;        // 0.1 mL/min
+    uint16_t faults;      // TELEMETRY_FAULT_* and interlock rule bits seen in the interval
+    uint16_t crc;         // CRC16 of the bytes above; a torn write fails it
+} telemetry_record_t;
+
+// Header at the start of every written sector; the rest of its page stays erased
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t sequence;    // Increments with every sector written, never reused
+    uint32_t first_time;  // time_s of the first record in the sector
+    uint16_t version;
+    uint16_t crc;  // CRC16 of the bytes above
+} telemetry_sector_header_t;
+
+#define TELEMETRY_SECTOR_RECORDS \
+    ((TELEMETRY_SECTOR_SIZE - TELEMETRY_PAGE_SIZE) / sizeof(telemetry_record_t))
+
+// Store statistics since boot
+typedef struct {
+    uint32_t sectors;          // Sectors in the partition
+    uint32_t records_written;  // Records programmed to flash
+    uint32_t pages_written;    // Flash writes
+    uint32_t sectors_erased;   // Flash erases
+    uint32_t records_dropped;  // Records lost because the writer fell behind
+    uint32_t torn_records;     // Records that failed their CRC during recovery
+    uint32_t oldest_time;      // time_s of the oldest stored record
+    uint32_t newest_time;      // time_s of the newest stored record
+} telemetry_stats_t;
+
+/**
+ * @brief Append-only time-series store on a raw flash partition
+ *
+ * The partition is a ring of erase sectors written in order. Each sector starts
+ * with a header carrying a sequence number and the time of its first record,
+ * followed by fixed-size records with increasing times. The next sector is erased
+ * only when the current one is full, so every sector is erased once per pass over
+ * the partition. Records are programmed into the already-erased sector a flash page at
+ * a time; a partial page is completed by later writes, which never cross into the
+ * next page. Smaller writes add no erases and bound the data lost on power failure.
+ *
+ * The sector headers form a sparse time index kept in RAM. A range read scans that
+ * index, seeks straight to the first sector of the range and binary searches the
+ * records in it, reading no other flash.
+ *
+ * On boot the headers are scanned to find the newest sector, and its records are
+ * scanned up to the first erased slot. Records cut short by a power failure fail
+ * their CRC, are skipped by reads and are never overwritten.
+ *
+ * record() is called from the control task and only averages; a low-priority task
+ * does all flash writes.
+ */
+class TelemetryStore {
+private:
+    struct SectorIndex {
+        uint32_t sequence;    // 0 if the sector holds no valid header
+        uint32_t first_time;  // time_s of the first record
+    };
+
+    const esp_partition_t* partition;
+    int sector_count;
+    SectorIndex index[TELEMETRY_MAX_SECTORS];
+
+    // Append position, guarded by lock
+    int head_sector;        // Sector being filled, -1 before the first write
+    int head_records;       // Records programmed into the head sector
+    uint32_t next_sequence;
+    uint32_t last_time;     // time_s of the newest record
+    uint32_t time_base;     // Store time at boot, continues from the stored records
+
+    // Records waiting to be programmed, one page at most
+    telemetry_record_t page[TELEMETRY_PAGE_RECORDS];
+    int page_count;
+    int64_t page_started_us;
+
+    // Averages of the current sample interval, control task only
+    struct Accumulator {
+        float temperature;
+        uint32_t temperature_count;  // Cycles with a valid temperature
+        float pressure;
+        float heater;
+        float pump;
+        float flow;
+        uint16_t faults;
+        uint32_t count;
+        int64_t start_us;
+    } accumulator;
+
+    SpscQueue<telemetry_record_t, TELEMETRY_QUEUE_SIZE> queue;
+    SemaphoreHandle_t lock;
+    TaskHandle_t task_handle;
+    std::atomic<bool> flush_requested;
+    bool initialized;
+    telemetry_stats_t stats;
+
+    static void taskEntry(void* arg);
+    void recover();
+    void append(const telemetry_record_t& rec);
+    esp_err_t flushPage();
+    esp_err_t openSector(uint32_t first_time);
+    int oldestSector() const;
+    bool readRecord(int sector, int slot, telemetry_record_t* out) const;
+    int findSlot(int sector, uint32_t time_s) const;
+
+public:
+    TelemetryStore();
+
+    /**
+     * @brief Find the partition, rebuild the index, recover the tail and start the
+     *        writer task
+     *
+     * @return ESP_OK on success, ESP_ERR_NOT_FOUND without the partition
+     */
+    esp_err_t init();
+
+    /**
+     * @brief Add one control cycle to the current sample (control task only)
+     *
+     * Every TELEMETRY_SAMPLE_INTERVAL_MS the averages become a record and are handed
+     * to the writer task. Never blocks.
+     *
+     * @param data Sensor data of the cycle
+     * @param faults TELEMETRY_FAULT_* and interlock rule bits active in the cycle
+     */
+    void record(const sensor_data_t* data, uint16_t faults);
+
+    /**
+     * @brief Read stored records in a time range, oldest first
+     *
+     * Includes records not yet written to flash.
+     *
+     * @param from_s First time_s to return
+     * @param to_s Last time_s to return
+     * @param out Destination for the records
+     * @param max Capacity of out
+     * @return Number of records written to out
+     */
+    size_t query(uint32_t from_s, uint32_t to_s, telemetry_record_t* out, size_t max);
+
+    /**
+     * @brief Write records still waiting for a full page, e.g. before a restart
+     */
+    void flush();
+
+    /**
+     * @brief Current store time in seconds
+     *
+     * Seconds since the epoch once the system clock is set, otherwise continued from
+     * the newest stored record so times keep increasing across power cycles.
+     */
+    uint32_t now() const;
+
+    /**
+     * @brief Get store statistics
+     *
+     * @param out Destination for the statistics
+     */
+    void getStats(telemetry_stats_t* out);
+};
+
+// Global instance
+extern TelemetryStore telemetry_store;
+
+// C compatibility functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t telemetry_store_init(void);
+void telemetry_store_record(const sensor_data_t* data, uint16_t faults);
+size_t telemetry_store_query(uint32_t from_s, uint32_t to_s, telemetry_record_t* out, size_t max);
+void telemetry_store_flush(void);
+void telemetry_store_get_stats(telemetry_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_STORE_H */
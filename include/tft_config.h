@@ -19,11 +19,31 @@
 #define TFT_RST  14  // Reset pin
 #define TFT_BL   15  // Backlight control pin (might not be needed for OLED)
 
-// Touch screen configuration
-#define TOUCH_SPI_FREQUENCY 2500000  // Touch SPI frequency in Hz
+// Touch screen configuration: FT6236 on its own I2C bus, pins in platformio.ini
+#define TOUCH_I2C_PORT      I2C_NUM_0
+#define TOUCH_I2C_FREQUENCY 400000   // Touch I2C frequency in Hz
+
+// Display SPI configuration
 #define SPI_FREQUENCY       60000000 // Display SPI frequency in Hz - increased for larger display
 #define SPI_READ_FREQUENCY  20000000 // Display SPI read frequency in Hz
 
+// Render target, selectable at build time with -D DISPLAY_RENDER_MODE=...
+#define DISPLAY_RENDER_FRAMEBUFFER 0  // Two full RGB565 framebuffers in PSRAM
+#define DISPLAY_RENDER_LINES 1        // Line-by-line into small internal DMA buffers
+#ifndef DISPLAY_RENDER_MODE
+#define DISPLAY_RENDER_MODE DISPLAY_RENDER_FRAMEBUFFER
+#endif
+
+// Draw the static UI from a pre-rendered image (LayerCache). Off until the
+// DISPLAY_BENCHMARK_FRAMES log shows it shortens frames at the dirty-region sizes we see.
+#ifndef DISPLAY_LAYER_CACHE
+#define DISPLAY_LAYER_CACHE 0
+#endif
+
+// Line mode buffers: each holds up to DISPLAY_LINE_BUFFER_LINES full-width lines
+#define DISPLAY_LINE_BUFFER_LINES 8
+#define DISPLAY_LINE_BUFFER_COUNT 3
+
 // Rotation of the display (0-3)
 #define TFT_ROTATION 0
 
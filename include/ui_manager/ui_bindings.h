@@ -0,0 +1,176 @@
+#ifndef UI_BINDINGS_H
+#define UI_BINDINGS_H
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+// Display precision of bound values; changes the UI cannot show are not forwarded
+#define UI_TEMPERATURE_STEP 0.1f  // °C, shown with one decimal
+#define UI_PRESSURE_STEP 0.1f     // Shown with one decimal
+#define UI_FLOW_STEP 0.1f         // Shown with one decimal
+#define UI_DIMMER_STEP 0.01f      // Pump power, shown in whole percent
+#define UI_SETPOINT_STEP 0.1f     // Setpoints, shown with one decimal
+#define UI_SHOT_VOLUME_STEP 1.0f  // mL, shown in whole mL
+#define UI_SHOT_TIME_STEP 1.0f    // Seconds, shown in whole seconds
+
+#define UI_BINDING_MAX_SSRS 16
+
+// Refresh budgets of published values; SSR indicators are refreshed on every change
+#define UI_READOUT_INTERVAL_MS 200      // Numeric readouts, 5 Hz
+#define UI_RENDER_BUDGET_US 30000       // Slower frames stretch the budgets
+#define UI_MAX_BACKOFF_SHIFT 2          // Budgets stretch at most 4x
+
+// Window property set statistics since boot
+typedef struct {
+    uint32_t requested;  // Sets the UI manager would make without bindings
+    uint32_t forwarded;  // Sets that reached the window
+    uint32_t batches;    // UI mutex acquisitions that applied at least one set
+} ui_binding_stats_t;
+
+/**
+ * @brief Last value pushed to one window property
+ *
+ * A staged value is forwarded only if it would display differently from the one the
+ * window already shows. Floats are compared after rounding to their display step,
+ * other types for equality.
+ *
+ * @tparam T Property type
+ */
+template <typename T>
+class Binding {
+public:
+    explicit Binding(T step = T()) : step(step), value(), valid(false), dirty(false) {}
+
+    /**
+     * @brief Stage a new value
+     *
+     * @return true if the window has to be updated
+     */
+    bool set(T next)
+    {
+        if (!valid || differs(next)) {
+            value = next;
+            valid = true;
+            dirty = true;
+        }
+        return dirty;
+    }
+
+    /**
+     * @brief Record a value the window already shows, e.g. one the user just edited
+     */
+    void sync(T shown)
+    {
+        value = shown;
+        valid = true;
+        dirty = false;
+    }
+
+    /**
+     * @brief Take the staged value for forwarding to the window
+     */
+    T take()
+    {
+        dirty = false;
+        return value;
+    }
+
+    bool pending() const { return dirty; }
+    const T& get() const { return value; }
+
+private:
+    bool differs(T next) const
+    {
+        if constexpr (std::is_floating_point<T>::value) {
+            if (step > 0) {
+                return lroundf(next / step) != lroundf(value / step);
+            }
+        }
+        return next != value;
+    }
+
+    T step;
+    T value;
+    bool valid;  // value has been forwarded or synced at least once
+    bool dirty;  // value has not been forwarded yet
+};
+
+// Bound properties of the main window
+struct MainWindowBindings {
+    Binding<float> temperature{UI_TEMPERATURE_STEP};
+    Binding<float> pressure{UI_PRESSURE_STEP};
+    Binding<float> flow_rate1{UI_FLOW_STEP};
+    Binding<float> flow_rate2{UI_FLOW_STEP};
+    Binding<float> dimmer_level{UI_DIMMER_STEP};
+    Binding<float> temp_setpoint{UI_SETPOINT_STEP};
+    Binding<float> pressure_setpoint{UI_SETPOINT_STEP};
+    Binding<bool> ssr_state[UI_BINDING_MAX_SSRS];
+    Binding<float> ssr_setpoint[UI_BINDING_MAX_SSRS];
+    Binding<bool> shot_running;
+    Binding<const char*> shot_step;  // Segment names are constants, compared by address
+    Binding<float> shot_volume{UI_SHOT_VOLUME_STEP};
+    Binding<float> shot_time{UI_SHOT_TIME_STEP};
+
+    MainWindowBindings()
+    {
+        for (auto& setpoint : ssr_setpoint) {
+            setpoint = Binding<float>(UI_SETPOINT_STEP);
+        }
+    }
+
+    bool sensorPending() const
+    {
+        return temperature.pending() || pressure.pending() || flow_rate1.pending() ||
+               flow_rate2.pending();
+    }
+
+    bool shotPending() const
+    {
+        return shot_running.pending() || shot_step.pending() || shot_volume.pending() ||
+               shot_time.pending();
+    }
+
+    bool ssrPending(int count) const
+    {
+        for (int i = 0; i < count; i++) {
+            if (ssr_state[i].pending() || ssr_setpoint[i].pending()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Write the staged SSR values into the rows of the SSR model, in place
+     *
+     * Only the rows of SSRs whose state or setpoint changed are written. The row copy
+     * shares the name string, so nothing is allocated.
+     *
+     * @param model Model whose row_data(i) returns an optional row with state and
+     *              setpoint fields, written back with set_row_data(i, row)
+     * @param count SSRs in the model
+     * @return Rows written
+     */
+    template <typename Model>
+    int applySsrRows(Model& model, int count)
+    {
+        int written = 0;
+        for (int i = 0; i < count; i++) {
+            if (!ssr_state[i].pending() && !ssr_setpoint[i].pending()) {
+                continue;
+            }
+            auto row = model.row_data(i);
+            if (!row) {
+                continue;
+            }
+            row->state    = ssr_state[i].take();
+            row->setpoint = ssr_setpoint[i].take();
+            model.set_row_data(i, *row);
+            written++;
+        }
+        return written;
+    }
+};
+
+#endif /* UI_BINDINGS_H */
@@ -2,10 +2,11 @@
 #define UI_MANAGER_H
 
 #include <cstdbool>
+#include "common/seqlock.h"
+#include "display/chart_engine.h"
+#include "profile/profile_engine.h"
 #include "sensor_manager/sensor_manager.h"
-
-// Forward declarations
-struct MainWindow;
+#include "ui_manager/ui_bindings.h"
 
 // Chart types
 enum class ChartType {
@@ -16,17 +17,26 @@ enum class ChartType {
     COUNT  // Total number of chart types
 };
 
+// Control-side state published for the UI
+typedef struct {
+    sensor_data_t sensor;
+    profile_status_t profile;      // Shot progress for the machine status panel
+    const SensorHistory* history;  // History the chart follows, or NULL
+    uint32_t history_samples;      // history->sample_count when published
+} ui_snapshot_t;
+
 // Callback types
 using SSRCallback = void (*)(int index, bool state);
 using DimmerCallback = void (*)(uint32_t level);
 using PIDSetpointCallback = void (*)(int index, float setpoint);
 using PIDToggleCallback = void (*)(bool enabled);
+using SafetyResetCallback = void (*)(void);
+using ShotCallback = void (*)(bool start);
 
 // UI Manager class
 class UIManager {
 private:
-    MainWindow* main_window;
-    bool initialized;
+    bool initialized;  // init() has created the main window
     int ssr_count;
     const char** ssr_names;
     const bool* ssr_pid_enabled;
@@ -36,22 +46,56 @@ private:
         CONTROL, 
         PLOTS 
     };
-    ViewType current_view;
+    ViewType current_view;  // Changed with the UI mutex held
+
+    // Extraction chart, drawn natively over the plots view; allocated only while shown
+    ScrollingChart plot_chart;
+
+    // Latest state from the control side, applied by the render task at frame start
+    SeqlockMailbox<ui_snapshot_t> mailbox;
+    uint32_t applied_version;
+
+    // Per-widget refresh budgets: earliest time each widget may be updated again
+    int64_t readout_due_us;
+    int64_t chart_due_us;
+    uint32_t charted_samples;  // History samples the chart was last updated with
+    int backoff_shift;  // Budgets are stretched by 2^backoff_shift while frames run slow
+
+    // Values last pushed to the window; only changes the display can show are forwarded
+    MainWindowBindings bindings;
+    ui_binding_stats_t binding_stats;
+    int64_t stats_start_us;
+    ui_binding_stats_t stats_start;
+    uint32_t stats_start_pixels;
     
     // Callback handlers
     SSRCallback ssr_callback;
     DimmerCallback dimmer_callback;
     PIDSetpointCallback setpoint_callback;
     PIDToggleCallback pid_toggle_callback;
+    SafetyResetCallback safety_reset_callback;
+    ShotCallback shot_callback;
     
-    // Private methods for event handling
-    static void slintSSRToggled(void* context, int index, bool state);
-    static void slintDimmerChanged(void* context, float level);
-    static void slintTempSetpointChanged(void* context, float setpoint);
-    static void slintPressureSetpointChanged(void* context, float setpoint);
-    static void slintSSRSetpointChanged(void* context, int index, float setpoint);
-    static void slintPIDToggled(void* context, bool enabled);
-    static void slintToggleView(void* context);
+    // Connect the window callbacks; they run on the render task with the UI mutex held
+    void bindCallbacks();
+
+    static void frameStart();
+    void stageReadouts(const sensor_data_t* data);
+    void stageShot(const profile_status_t* profile);
+    void updateBackoff();
+    // Also records what was charted and when the next update is due
+    void updateCharts(const SensorHistory* history, uint32_t sample_count);
+
+    // Switch views; the UI mutex must be held
+    void setView(ViewType view);
+
+    // Plots view content, created on show and released on hide; the UI mutex must be held
+    bool createPlotsView();
+    void releasePlotsView();
+
+    // Forward staged binding changes to the window; the UI mutex must be held
+    void applyBindings();
+    void logBindingStats();
     
 public:
     UIManager();
@@ -68,11 +112,15 @@ public:
      * @param dimmer_cb Callback for dimmer change events
      * @param setpoint_cb Callback for setpoint change events
      * @param pid_toggle_cb Callback for PID toggle events
+     * @param safety_reset_cb Callback for safety interlock reset requests
+     * @param shot_cb Callback for the start/stop button, true to start a shot
      */
     void registerCallbacks(SSRCallback ssr_cb, 
                           DimmerCallback dimmer_cb,
                           PIDSetpointCallback setpoint_cb,
-                          PIDToggleCallback pid_toggle_cb);
+                          PIDToggleCallback pid_toggle_cb,
+                          SafetyResetCallback safety_reset_cb,
+                          ShotCallback shot_cb);
     
     /**
      * @brief Create the UI elements
@@ -85,11 +133,16 @@ public:
     
     /**
      * @brief Switch to main control view
+     *
+     * Releases the chart surface of the plots view; the chart is not drawn while hidden.
      */
     void showControlView();
     
     /**
      * @brief Switch to plots view
+     *
+     * Allocates the chart surface and draws everything recorded while the view was
+     * hidden in one batch.
      */
     void showPlotsView();
     
@@ -99,34 +152,29 @@ public:
     void toggleView();
     
     /**
-     * @brief Update the UI with sensor data
+     * @brief Publish sensor data and history for display
      *
-     * @param data Sensor data to display
-     */
-    void updateSensorData(const sensor_data_t* data);
-    
-    /**
-     * @brief Update charts with sensor history data
+     * Never blocks and takes no lock, so it is safe from the highest-priority task.
+     * The render task picks up the latest published state at the start of its next
+     * tick and refreshes each widget within its budget: SSR indicators on every
+     * change, numeric readouts at UI_READOUT_INTERVAL_MS and the chart when the
+     * history gains a sample. The chart is only updated while the plots view is shown.
      *
-     * @param history Sensor history data to plot
+     * @param data Sensor data to display
+     * @param profile Progress of the running or last shot, or NULL
+     * @param history Sensor history to plot, or NULL; samples must be recorded before
+     *                publishing
      */
-    void updateCharts(const SensorHistory* history);
-    
+    void publish(const sensor_data_t* data,
+                 const profile_status_t* profile,
+                 const SensorHistory* history);
+
     /**
-     * @brief Update UI elements to reflect PID output states
-     *
-     * @param pressure_output Current pressure PID output
-     * @param ssr_states Array of current SSR states
+     * @brief Apply the latest published state; render task only, UI mutex held
      */
-    void updatePIDOutputs(float pressure_output, const bool* ssr_states);
+    void applyPublished();
     
-    /**
-     * @brief Update UI elements to reflect PID setpoints
-     *
-     * @param pressure_setpoint Pressure PID setpoint
-     * @param ssr_setpoints Array of SSR PID setpoints
-     */
-    void updatePIDSetpoints(float pressure_setpoint, const float* ssr_setpoints);
+    const ui_binding_stats_t& getBindingStats() const { return binding_stats; }
 };
 
 // Global instance
@@ -141,15 +189,16 @@ void ui_manager_init(void);
 void ui_manager_register_callbacks(SSRCallback ssr_cb,
                                  DimmerCallback dimmer_cb,
                                  PIDSetpointCallback setpoint_cb,
-                                 PIDToggleCallback pid_toggle_cb);
+                                 PIDToggleCallback pid_toggle_cb,
+                                 SafetyResetCallback safety_reset_cb,
+                                 ShotCallback shot_cb);
 void ui_create(int ssr_count, const char** ssr_names, const bool* ssr_pid_enabled);
 void ui_show_control_view(void);
 void ui_show_plots_view(void);
 void ui_toggle_view(void);
-void ui_update_sensor_data(const sensor_data_t* data);
-void ui_update_charts(const SensorHistory* history);
-void ui_update_pid_outputs(float pressure_output, const bool* ssr_states);
-void ui_update_pid_setpoints(float pressure_setpoint, const float* ssr_setpoints);
+void ui_publish(const sensor_data_t* data,
+                const profile_status_t* profile,
+                const SensorHistory* history);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,210 @@
+"""PlatformIO pre-build step: compile extraction profiles into segment tables.
+
+Profiles are authored as JSON files in profiles/, one profile per file, in the
+units people brew with (bar, seconds, mL). This script validates them and writes
+profiles_generated.h: constant profile_segment_t tables in controller units (PSI,
+ms, mL) that the firmware links into flash (see include/profile/profile_engine.h).
+Nothing is parsed on the device.
+
+Profile format:
+
+    {
+      "name": "CLASSIC 9 BAR",
+      "segments": [
+        {"name": "Preinfuse", "type": "step", "bar": 2.0, "exit": {"seconds": 6}},
+        {"name": "Ramp",      "type": "ramp", "bar": 9.0, "seconds": 3},
+        {"name": "Extract",   "type": "hold", "exit": {"ml": 36, "seconds": 30}}
+      ]
+    }
+
+Segment types:
+
+    step   jump to "bar"
+    ramp   move linearly to "bar" over "seconds", starting from where the previous
+           segment ended; without an "exit" it ends when the ramp does
+    hold   keep the setpoint the segment was entered with
+
+Exit conditions, any of which ends the segment: "seconds" in the segment, "ml"
+since the shot started, "bar_above" and "bar_below" for the measured pressure.
+Profiles are ordered by file name.
+
+Run standalone to check the profiles and print the compiled tables:
+
+    python scripts/build_profiles.py [profiles_dir]
+"""
+
+import glob
+import json
+import os
+import sys
+
+PROFILE_DIR = "profiles"
+GENERATED_HEADER = "profiles_generated.h"
+
+MAX_SEGMENTS = 16  # PROFILE_MAX_SEGMENTS
+PSI_PER_BAR = 14.5038
+MAX_BAR = 12.0
+
+SEGMENT_TYPES = {"step": "PROFILE_SEG_STEP", "ramp": "PROFILE_SEG_RAMP", "hold": "PROFILE_SEG_HOLD"}
+EXITS = {
+    "seconds": "PROFILE_EXIT_TIME",
+    "ml": "PROFILE_EXIT_VOLUME",
+    "bar_above": "PROFILE_EXIT_PRESSURE_ABOVE",
+    "bar_below": "PROFILE_EXIT_PRESSURE_BELOW",
+}
+
+
+class ProfileError(Exception):
+    pass
+
+
+def number(value, what, low, high):
+    if isinstance(value, bool) or not isinstance(value, (int, float)):
+        raise ProfileError("%s must be a number" % what)
+    if not low <= value <= high:
+        raise ProfileError("%s must be between %g and %g" % (what, low, high))
+    return float(value)
+
+
+def compile_segment(seg, index):
+    """Return the profile_segment_t fields of one authored segment."""
+    name = seg.get("name", "STEP %d" % (index + 1))
+    where = "segment %d (%s)" % (index + 1, name)
+
+    kind = seg.get("type")
+    if kind not in SEGMENT_TYPES:
+        raise ProfileError("%s: type must be one of %s" % (where, ", ".join(SEGMENT_TYPES)))
+
+    target = 0.0
+    if kind != "hold":
+        target = number(seg.get("bar"), where + ": bar", 0.0, MAX_BAR)
+
+    ramp_ms = 0
+    if kind == "ramp":
+        ramp_ms = round(number(seg.get("seconds"), where + ": seconds", 0.1, 600.0) * 1000)
+
+    exit_cond = dict(seg.get("exit", {}))
+    if kind == "ramp" and not exit_cond:
+        exit_cond["seconds"] = ramp_ms / 1000.0
+    unknown = set(exit_cond) - set(EXITS)
+    if unknown:
+        raise ProfileError("%s: unknown exit %s" % (where, ", ".join(sorted(unknown))))
+    if not exit_cond:
+        raise ProfileError("%s: needs an exit condition" % where)
+    if "bar_above" in exit_cond and "bar_below" in exit_cond:
+        raise ProfileError("%s: bar_above and bar_below share one threshold" % where)
+
+    exit_ms = 0
+    exit_ml = 0.0
+    exit_psi = 0.0
+    if "seconds" in exit_cond:
+        exit_ms = round(number(exit_cond["seconds"], where + ": exit seconds", 0.0, 600.0) * 1000)
+    if "ml" in exit_cond:
+        exit_ml = number(exit_cond["ml"], where + ": exit ml", 0.0, 1000.0)
+    for key in ("bar_above", "bar_below"):
+        if key in exit_cond:
+            exit_psi = number(exit_cond[key], where + ": " + key, 0.0, MAX_BAR) * PSI_PER_BAR
+
+    return {
+        "type": SEGMENT_TYPES[kind],
+        "exits": " | ".join(EXITS[k] for k in EXITS if k in exit_cond),
+        "target": target * PSI_PER_BAR,
+        "ramp_ms": ramp_ms,
+        "exit_ms": exit_ms,
+        "exit_ml": exit_ml,
+        "exit_psi": exit_psi,
+        "name": name,
+    }
+
+
+def compile_profile(path):
+    with open(path, encoding="utf-8") as f:
+        try:
+            doc = json.load(f)
+        except ValueError as e:
+            raise ProfileError("%s: %s" % (path, e))
+
+    try:
+        name = doc.get("name")
+        if not isinstance(name, str) or not name:
+            raise ProfileError("missing name")
+        segments = doc.get("segments")
+        if not isinstance(segments, list) or not segments:
+            raise ProfileError("missing segments")
+        if len(segments) > MAX_SEGMENTS:
+            raise ProfileError("%d segments, at most %d" % (len(segments), MAX_SEGMENTS))
+        return name, [compile_segment(seg, i) for i, seg in enumerate(segments)]
+    except ProfileError as e:
+        raise ProfileError("%s: %s" % (path, e))
+
+
+def c_string(text):
+    return json.dumps(text, ensure_ascii=False)
+
+
+def generate(profiles):
+    lines = [
+        "// Generated by scripts/build_profiles.py from %s/*.json, do not edit" % PROFILE_DIR,
+        "#pragma once",
+        "",
+        '#include "profile/profile_engine.h"',
+        "",
+    ]
+    for i, (_, segments) in enumerate(profiles):
+        lines.append("static const profile_segment_t PROFILE_SEGMENTS_%d[] = {" % i)
+        for s in segments:
+            lines.append("    {%s, %s, %.3ff, %d, %d, %.3ff, %.3ff, %s},"
+                         % (s["type"], s["exits"], s["target"], s["ramp_ms"], s["exit_ms"],
+                            s["exit_ml"], s["exit_psi"], c_string(s["name"])))
+        lines.append("};")
+        lines.append("")
+
+    lines.append("static const profile_t PROFILE_TABLE[] = {")
+    for i, (name, segments) in enumerate(profiles):
+        lines.append("    {%s, PROFILE_SEGMENTS_%d, %d}," % (c_string(name), i, len(segments)))
+    lines.append("};")
+    lines.append("")
+    lines.append("#define PROFILE_COUNT %d" % len(profiles))
+    return "\n".join(lines) + "\n"
+
+
+def build(profile_dir):
+    paths = sorted(glob.glob(os.path.join(profile_dir, "*.json")))
+    if not paths:
+        raise ProfileError("no profiles in %s" % profile_dir)
+    profiles = [compile_profile(p) for p in paths]
+    names = [name for name, _ in profiles]
+    duplicates = sorted({n for n in names if names.count(n) > 1})
+    if duplicates:
+        raise ProfileError("duplicate profile names: %s" % ", ".join(duplicates))
+
+    for path, (name, segments) in zip(paths, profiles):
+        print("build_profiles: %s -> \"%s\", %d segments" % (path, name, len(segments)))
+    return generate(profiles)
+
+
+def write_if_changed(path, text):
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    try:
+        sys.stdout.write(build(sys.argv[1] if len(sys.argv) > 1 else PROFILE_DIR))
+    except ProfileError as e:
+        sys.exit("build_profiles: %s" % e)
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+
+    project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "profiles")  # noqa: F821
+    os.makedirs(out_dir, exist_ok=True)
+
+    # A broken profile fails the build instead of shipping without it
+    write_if_changed(os.path.join(out_dir, GENERATED_HEADER),
+                     build(os.path.join(project_dir, PROFILE_DIR)))
+    env.Append(CPPPATH=[out_dir])  # noqa: F821
@@ -0,0 +1,122 @@
+"""Decode shot files written by the shot recorder into CSV.
+
+The recorder (src/recorder/shot_recorder.cpp) stores each shot as fixed-point
+columns, one per channel, plus a time column. The channel names, units and scales
+are part of the file, so this script needs no knowledge of the firmware version
+that wrote it.
+
+File layout (little endian, must match include/recorder/shot_file.h):
+
+    header   magic "SHOT", u16 version, u16 channel_count, u32 frame_count,
+             u32 shot_index, u32 start_ms
+    channels channel_count x { char name[12], char unit[8], f32 scale }
+    data     u32 time_ms[frame_count], then i16 value[frame_count] per channel
+
+Copy the files off the "shots" SPIFFS partition, e.g. with esptool read_flash and
+mkspiffs -u, then:
+
+    python scripts/decode_shot.py shot_0007.bin            # CSV to stdout
+    python scripts/decode_shot.py shot_0007.bin -o 7.csv   # CSV to a file
+    python scripts/decode_shot.py --summary shot_*.bin     # One line per shot
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = b"SHOT"
+VERSION = 1
+NAME_LEN = 12
+UNIT_LEN = 8
+HEADER = struct.Struct("<4sHHIII")
+CHANNEL = struct.Struct("<%ds%dsf" % (NAME_LEN, UNIT_LEN))
+
+
+class Shot:
+    """One decoded shot: time in seconds and one list of values per channel."""
+
+    def __init__(self, index, start_ms, channels, times, columns):
+        self.index = index
+        self.start_ms = start_ms
+        self.channels = channels  # [(name, unit)]
+        self.times = times
+        self.columns = columns
+
+
+def decode(data):
+    """Parse the bytes of one shot file."""
+    if len(data) < HEADER.size:
+        raise ValueError("file too short for a shot header")
+    magic, version, channel_count, frame_count, index, start_ms = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError("not a shot file (magic %r)" % magic)
+    if version != VERSION:
+        raise ValueError("unsupported shot file version %d" % version)
+
+    offset = HEADER.size
+    channels = []
+    scales = []
+    for _ in range(channel_count):
+        name, unit, scale = CHANNEL.unpack_from(data, offset)
+        offset += CHANNEL.size
+        channels.append((name.split(b"\0")[0].decode(), unit.split(b"\0")[0].decode()))
+        scales.append(scale)
+
+    expected = offset + frame_count * (4 + 2 * channel_count)
+    if len(data) < expected:
+        raise ValueError("file truncated: %d of %d bytes" % (len(data), expected))
+
+    times = [t / 1000.0 for t in struct.unpack_from("<%dI" % frame_count, data, offset)]
+    offset += 4 * frame_count
+    columns = []
+    for scale in scales:
+        raw = struct.unpack_from("<%dh" % frame_count, data, offset)
+        offset += 2 * frame_count
+        columns.append([v * scale for v in raw])
+
+    return Shot(index, start_ms, channels, times, columns)
+
+
+def write_csv(shot, out):
+    writer = csv.writer(out)
+    writer.writerow(["time_s"] + ["%s_%s" % (n, u) if u else n for n, u in shot.channels])
+    for row, t in enumerate(shot.times):
+        writer.writerow(["%.3f" % t] + ["%g" % round(c[row], 4) for c in shot.columns])
+
+
+def summary(path, shot):
+    names = [n for n, _ in shot.channels]
+    duration = shot.times[-1] if shot.times else 0.0
+    rate = (len(shot.times) - 1) / duration if duration > 0 else 0.0
+    line = "%s: shot %d, %d frames over %.1f s (%.1f Hz)" % (
+        path, shot.index, len(shot.times), duration, rate)
+    if "pressure" in names:
+        line += ", peak %.1f PSI" % max(shot.columns[names.index("pressure")])
+    return line
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("files", nargs="+", help="shot files")
+    parser.add_argument("-o", "--output", help="CSV output file (one input file only)")
+    parser.add_argument("--summary", action="store_true", help="print one line per shot")
+    args = parser.parse_args()
+
+    if args.output and len(args.files) != 1:
+        parser.error("--output takes a single input file")
+
+    for path in args.files:
+        with open(path, "rb") as f:
+            shot = decode(f.read())
+        if args.summary:
+            print(summary(path, shot))
+        elif args.output:
+            with open(args.output, "w", newline="") as out:
+                write_csv(shot, out)
+        else:
+            write_csv(shot, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+"""PlatformIO pre-build step: compile the Slint UI with pre-rasterized fonts.
+
+The UI is compiled with ``--embed-resources=embed-for-software-renderer``. In that
+mode slint-compiler subsets every imported font to the glyphs the UI can show and
+pre-renders them as antialiased coverage bitmaps. The software renderer then draws
+text by blitting cached glyphs instead of rasterizing outlines at runtime, and the
+TTFs themselves are not linked into flash.
+
+Images are embedded the same way: every @image-url is decoded (SVGs rasterized) at
+build time and linked as texture data in rodata, which the software renderer reads in
+place from memory-mapped flash. That is why there is no separate asset partition.
+
+Glyphs are rendered only at the sizes listed in SLINT_FONT_SIZES. This script
+derives that list from the ``font-size`` values in the .slint file, so a size added
+to the UI is picked up without touching the build.
+
+Run standalone to inspect what would be embedded:
+
+    python scripts/slint_codegen.py src/ui_manager/main_ui.slint
+"""
+
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+SLINT_SOURCE = os.path.join("src", "ui_manager", "main_ui.slint")
+GENERATED_HEADER = "main_ui_slint.h"
+
+# Sizes not written as literals (e.g. bound to properties) can be appended here
+EXTRA_FONT_SIZES = []
+
+FONT_SIZE_RE = re.compile(r"font-size\s*:\s*([0-9]*\.?[0-9]+)\s*px")
+STRING_RE = re.compile(r'"((?:[^"\\]|\\.)*)"')
+
+
+def font_sizes(slint_text):
+    """Return the sorted pixel sizes used by the UI."""
+    sizes = {float(m) for m in FONT_SIZE_RE.findall(slint_text)}
+    sizes.update(EXTRA_FONT_SIZES)
+    return sorted(sizes)
+
+
+def literal_glyphs(slint_text):
+    """Return the non-ASCII characters used in string literals.
+
+    ASCII is always embedded by slint-compiler; anything else must appear in a
+    literal or it will render as a replacement glyph.
+    """
+    chars = set()
+    for literal in STRING_RE.findall(slint_text):
+        if literal.endswith((".ttf", ".otf", ".svg", ".png", ".slint")):
+            continue
+        chars.update(c for c in literal if ord(c) > 0x7E)
+    return "".join(sorted(chars))
+
+
+def format_sizes(sizes):
+    return ",".join(("%g" % s) for s in sizes)
+
+
+class CodegenError(Exception):
+    pass
+
+
+def compile_ui(source, output, sizes):
+    compiler = shutil.which("slint-compiler")
+    if compiler is None:
+        raise CodegenError("slint-compiler not found in PATH; install it with "
+                           "'cargo install slint-compiler' (ui_manager.cpp includes %s)"
+                           % GENERATED_HEADER)
+
+    if os.path.exists(output) and os.path.getmtime(output) >= os.path.getmtime(source):
+        return
+
+    env = dict(os.environ, SLINT_FONT_SIZES=format_sizes(sizes))
+    cmd = [
+        compiler,
+        source,
+        "--format", "cpp",
+        "--embed-resources", "embed-for-software-renderer",
+        "--output", output,
+    ]
+    print("slint_codegen: SLINT_FONT_SIZES=%s %s" % (env["SLINT_FONT_SIZES"], " ".join(cmd)))
+    if subprocess.call(cmd, env=env) != 0:
+        raise CodegenError("slint-compiler failed on %s" % source)
+
+
+def report(source):
+    with open(source, encoding="utf-8") as f:
+        text = f.read()
+    sizes = font_sizes(text)
+    print("Font sizes:        %s" % format_sizes(sizes))
+    print("Non-ASCII glyphs:  %s" % (literal_glyphs(text) or "(none)"))
+    return text, sizes
+
+
+if __name__ == "__main__":
+    report(sys.argv[1] if len(sys.argv) > 1 else SLINT_SOURCE)
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+
+    project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "slint")  # noqa: F821
+    os.makedirs(out_dir, exist_ok=True)
+
+    # The UI cannot be built without the generated header, so fail here rather than
+    # at the #include
+    source = os.path.join(project_dir, SLINT_SOURCE)
+    _, sizes = report(source)
+    try:
+        compile_ui(source, os.path.join(out_dir, GENERATED_HEADER), sizes)
+    except CodegenError as e:
+        sys.exit("slint_codegen: %s" % e)
+    env.Append(CPPPATH=[out_dir])  # noqa: F821
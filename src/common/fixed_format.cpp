@@ -0,0 +1,186 @@
+#include "common/fixed_format.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "format";
+
+/* Benchmark: readouts from -50.0 to 1000.0 in FIXED_FORMAT_BENCHMARK_VALUES steps */
+#define FIXED_FORMAT_BENCHMARK_VALUES 2000
+#define FIXED_FORMAT_BENCHMARK_PASSES 5
+
+static const float pow10_table[FIXED_FORMAT_MAX_DECIMALS + 1] = {
+    1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f, 1000000.0f};
+
+extern "C" {
+
+// Lay out the padded number and suffix; digits is the number without sign or padding
+static size_t emit(char *buf,
+                   size_t size,
+                   bool negative,
+                   const char *digits,
+                   size_t digit_count,
+                   const fixed_format_t *format)
+{
+    size_t suffix_len = format->suffix ? strlen(format->suffix) : 0;
+    size_t number_len = digit_count + (negative ? 1 : 0);
+    size_t padding    = format->width > number_len ? format->width - number_len : 0;
+    size_t total      = padding + number_len + suffix_len;
+
+    if (!buf || size == 0) {
+        return 0;
+    }
+    if (total >= size) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    char *out = buf;
+    memset(out, ' ', padding);
+    out += padding;
+    if (negative) {
+        *out++ = '-';
+    }
+    memcpy(out, digits, digit_count);
+    out += digit_count;
+    memcpy(out, format->suffix, suffix_len);
+    out[suffix_len] = '\0';
+    return total;
+}
+
+size_t fixed_format_int(char *buf, size_t size, int32_t value, const fixed_format_t *format)
+{
+    if (!format || format->decimals > FIXED_FORMAT_MAX_DECIMALS) {
+        if (buf && size > 0) {
+            buf[0] = '\0';
+        }
+        return 0;
+    }
+
+    // Digits are produced backwards from the end of the scratch buffer
+    char scratch[16];
+    char *end          = scratch + sizeof(scratch);
+    char *p            = end;
+    bool negative      = value < 0;
+    uint32_t magnitude = negative ? 0u - (uint32_t)value : (uint32_t)value;
+
+    for (int i = 0; i < format->decimals; i++) {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    if (format->decimals > 0) {
+        *--p = '.';
+    }
+    do {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    // "-0.0" reads as noise on a readout
+    bool zero = true;
+    for (const char *c = p; c < end; c++) {
+        if (*c != '0' && *c != '.') {
+            zero = false;
+            break;
+        }
+    }
+
+    return emit(buf, size, negative && !zero, p, end - p, format);
+}
+
+size_t fixed_format_float(char *buf, size_t size, float value, const fixed_format_t *format)
+{
+    if (!format || format->decimals > FIXED_FORMAT_MAX_DECIMALS) {
+        return fixed_format_int(buf, size, 0, format);
+    }
+
+    float scale = pow10_table[format->decimals];
+    if (std::isnan(value) || fabsf(value) * scale >= 2147483520.0f) {
+        return emit(buf, size, false, "--", 2, format);
+    }
+
+    // Scaling the whole value would round away the decimals of large values; scale
+    // the integer part exactly and round only the fraction
+    float magnitude = fabsf(value);
+    float whole     = truncf(magnitude);
+    float fraction  = magnitude - whole;
+    int32_t digits  = (int32_t)(fraction * scale);
+
+    // The product above is rounded, so decide on the exact one with a fused
+    // multiply-add: values just below a half round down, as with printf
+    if (fmaf(fraction, scale, -((float)digits + 0.5f)) >= 0.0f) {
+        digits++;
+    }
+
+    int32_t fixed = (int32_t)whole * (int32_t)scale + digits;
+    if (value < 0) {
+        fixed = -fixed;
+    }
+    return fixed_format_int(buf, size, fixed, format);
+}
+
+void fixed_format_benchmark(void)
+{
+    const fixed_format_t format = {1, 6, " mL/min"};
+    char fixed_buf[FIXED_FORMAT_MAX_CHARS];
+    char printf_buf[FIXED_FORMAT_MAX_CHARS];
+    const float step  = 1050.0f / FIXED_FORMAT_BENCHMARK_VALUES;
+    const size_t size = sizeof(fixed_buf);
+    int64_t start_us;
+
+    // The checksum keeps the calls from being optimized out
+    uint32_t checksum = 0;
+
+    start_us = esp_timer_get_time();
+    for (int pass = 0; pass < FIXED_FORMAT_BENCHMARK_PASSES; pass++) {
+        for (int i = 0; i < FIXED_FORMAT_BENCHMARK_VALUES; i++) {
+            checksum += fixed_format_float(fixed_buf, size, -50.0f + i * step, &format);
+        }
+    }
+    int64_t fixed_us = esp_timer_get_time() - start_us;
+
+    start_us = esp_timer_get_time();
+    for (int pass = 0; pass < FIXED_FORMAT_BENCHMARK_PASSES; pass++) {
+        for (int i = 0; i < FIXED_FORMAT_BENCHMARK_VALUES; i++) {
+            checksum += snprintf(printf_buf,
+                                 sizeof(printf_buf),
+                                 "%*.*f%s",
+                                 format.width,
+                                 format.decimals,
+                                 -50.0f + i * step,
+                                 format.suffix);
+        }
+    }
+    int64_t printf_us = esp_timer_get_time() - start_us;
+
+    int mismatches = 0;
+    for (int i = 0; i < FIXED_FORMAT_BENCHMARK_VALUES; i++) {
+        float value = -50.0f + i * step;
+        fixed_format_float(fixed_buf, sizeof(fixed_buf), value, &format);
+        snprintf(printf_buf,
+                 sizeof(printf_buf),
+                 "%*.*f%s",
+                 format.width,
+                 format.decimals,
+                 value,
+                 format.suffix);
+        if (strcmp(fixed_buf, printf_buf) != 0) {
+            mismatches++;
+        }
+    }
+
+    const int calls = FIXED_FORMAT_BENCHMARK_VALUES * FIXED_FORMAT_BENCHMARK_PASSES;
+    ESP_LOGI(TAG,
+             "%d readouts: fixed %u ns/call, snprintf %u ns/call, %d differ (checksum %u)",
+             calls,
+             (unsigned)(fixed_us * 1000 / calls),
+             (unsigned)(printf_us * 1000 / calls),
+             mismatches,
+             (unsigned)checksum);
+}
+
+}  // extern "C"
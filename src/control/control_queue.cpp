@@ -0,0 +1,102 @@
+#include "control/control_queue.h"
+
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "control";
+
+// Global instance
+ControlQueue control_queue;
+
+// ControlQueue implementation
+ControlQueue::ControlQueue()
+    : last_report_us(0), window_applied(0), window_max_us(0), window_latency_us(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool ControlQueue::post(control_cmd_t cmd)
+{
+    cmd.queued_us = esp_timer_get_time();
+    if (!commands.push(cmd)) {
+        stats.dropped++;
+        ESP_LOGW(TAG, "Command queue full, dropped command type %d", (int)cmd.type);
+        return false;
+    }
+    stats.posted++;
+    return true;
+}
+
+bool ControlQueue::pop(control_cmd_t *out)
+{
+    return out != nullptr && commands.pop(*out);
+}
+
+void ControlQueue::complete(const control_cmd_t *cmd)
+{
+    if (!cmd) {
+        return;
+    }
+
+    int64_t now_us      = esp_timer_get_time();
+    uint32_t latency_us = (uint32_t)(now_us - cmd->queued_us);
+
+    stats.applied++;
+    stats.total_latency_us += latency_us;
+    if (latency_us > stats.max_latency_us) {
+        stats.max_latency_us = latency_us;
+    }
+
+    window_applied++;
+    window_latency_us += latency_us;
+    if (latency_us > window_max_us) {
+        window_max_us = latency_us;
+    }
+
+    if (now_us - last_report_us >= CONTROL_STATS_INTERVAL_MS * 1000LL) {
+        ESP_LOGI(TAG,
+                 "UI to actuator: %u commands, latency avg %u us max %u us, %u dropped",
+                 (unsigned)window_applied,
+                 (unsigned)(window_latency_us / window_applied),
+                 (unsigned)window_max_us,
+                 (unsigned)stats.dropped);
+        last_report_us    = now_us;
+        window_applied    = 0;
+        window_max_us     = 0;
+        window_latency_us = 0;
+    }
+}
+
+void ControlQueue::getStats(control_stats_t *out) const
+{
+    if (out) {
+        *out = stats;
+    }
+}
+
+// C compatibility wrappers
+extern "C" {
+
+bool control_queue_post(const control_cmd_t *cmd)
+{
+    return cmd != nullptr && control_queue.post(*cmd);
+}
+
+bool control_queue_pop(control_cmd_t *out)
+{
+    return control_queue.pop(out);
+}
+
+void control_queue_complete(const control_cmd_t *cmd)
+{
+    control_queue.complete(cmd);
+}
+
+void control_queue_get_stats(control_stats_t *out)
+{
+    control_queue.getStats(out);
+}
+
+}  // extern "C"
@@ -0,0 +1,363 @@
+#include "display/chart_engine.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "display/pixel_kernels.h"
+#include "display/raster.h"
+#include "display/slint_platform.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "chart";
+
+/* Benchmark chart: the plot of the sensor view with four traces */
+#define CHART_BENCHMARK_SAMPLES SENSOR_HISTORY_LENGTH
+#define CHART_BENCHMARK_STEP 3
+#define CHART_BENCHMARK_HEIGHT 200
+#define CHART_BENCHMARK_SCROLLS 50
+
+ScrollingChart::ScrollingChart()
+    : pixels(nullptr),
+      format(CHART_FORMAT_RGB565),
+      pixel_bytes(sizeof(uint16_t)),
+      x(0),
+      y(0),
+      width(0),
+      height(0),
+      column_step(1),
+      palette{},
+      traces{},
+      trace_count(0),
+      drawn_count(0),
+      valid(false),
+      attached(false)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+esp_err_t ScrollingChart::init(int x,
+                               int y,
+                               int samples,
+                               int column_step,
+                               int height,
+                               uint16_t background,
+                               uint16_t grid_color,
+                               chart_format_t format)
+{
+    if (pixels) {
+        return ESP_OK;
+    }
+
+    int bpp      = format == CHART_FORMAT_INDEX8 ? 1 : sizeof(uint16_t);
+    size_t bytes = (size_t)samples * column_step * height * bpp;
+    pixels       = (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (!pixels) {
+        ESP_LOGE(TAG, "Failed to allocate %u byte chart surface", (unsigned)bytes);
+        return ESP_ERR_NO_MEM;
+    }
+
+    this->x           = x;
+    this->y           = y;
+    this->width       = samples * column_step;
+    this->height      = height;
+    this->column_step = column_step;
+    this->format      = format;
+    pixel_bytes       = bpp;
+    valid             = false;
+
+    stats.surface_bytes = (uint32_t)bytes;
+
+    palette[CHART_PALETTE_BACKGROUND] = background;
+    palette[CHART_PALETTE_GRID]       = grid_color;
+
+    ESP_LOGI(TAG,
+             "Chart %dx%d at (%d,%d), %d px per sample, %s, %u bytes",
+             width,
+             height,
+             x,
+             y,
+             column_step,
+             format == CHART_FORMAT_INDEX8 ? "indexed" : "RGB565",
+             (unsigned)bytes);
+    return ESP_OK;
+}
+
+void ScrollingChart::deinit()
+{
+    heap_caps_free(pixels);
+    pixels      = nullptr;
+    trace_count = 0;
+    valid       = false;
+}
+
+int ScrollingChart::addTrace(uint16_t color, float min, float max)
+{
+    if (trace_count >= CHART_MAX_TRACES || max <= min) {
+        return -1;
+    }
+    traces[trace_count] = {color, min, max};
+    valid               = false;
+
+    // Edge shades of the trace over the background, for the indexed format
+    uint16_t *ramp = palette + CHART_PALETTE_TRACES + trace_count * CHART_RAMP_STEPS;
+    for (int k = 0; k < CHART_RAMP_STEPS; k++) {
+        uint8_t alpha = (uint8_t)((k + 1) * 255 / CHART_RAMP_STEPS);
+        ramp[k]       = pixel_mix_rgb565(palette[CHART_PALETTE_BACKGROUND], color, alpha);
+    }
+    return trace_count++;
+}
+
+int32_t ScrollingChart::valueToY(const chart_trace_t &trace, float value) const
+{
+    float t = (value - trace.min) / (trace.max - trace.min);
+    if (t < 0.0f) {
+        t = 0.0f;
+    }
+    else if (t > 1.0f) {
+        t = 1.0f;
+    }
+
+    // Centers of the bottom and top pixel rows, fixed point
+    return RASTER_FX((height - 1) * (1.0f - t)) + RASTER_FX_ONE / 2;
+}
+
+void ScrollingChart::scroll(int columns)
+{
+    // Rows are independent, so each one is a single overlapping move
+    size_t keep  = (size_t)(width - columns) * pixel_bytes;
+    size_t shift = (size_t)columns * pixel_bytes;
+    for (int row = 0; row < height; row++) {
+        uint8_t *line = pixels + (size_t)row * width * pixel_bytes;
+        memmove(line, line + shift, keep);
+    }
+}
+
+// Fill pixels of one row with a palette entry
+void ScrollingChart::fill(int row, int column, int count, uint8_t entry)
+{
+    size_t offset = (size_t)row * width + column;
+    if (format == CHART_FORMAT_INDEX8) {
+        memset(pixels + offset, entry, count);
+    }
+    else {
+        pixel_fill_rgb565((uint16_t *)pixels + offset, palette[entry], count);
+    }
+}
+
+// Draw the columns of one sample. index is the sample's position in the views, or
+// negative for a column left of the oldest sample; sample is its absolute number,
+// which keeps the vertical grid fixed to the data while it scrolls.
+void ScrollingChart::drawSample(const HistoryView *views, int index, int column, uint32_t sample)
+{
+    for (int row = 0; row < height; row++) {
+        fill(row, column, column_step, CHART_PALETTE_BACKGROUND);
+    }
+
+    // Grid
+    for (int i = 0; i < CHART_GRID_ROWS; i++) {
+        fill(i * height / CHART_GRID_ROWS, column, column_step, CHART_PALETTE_GRID);
+    }
+    fill(height - 1, column, column_step, CHART_PALETTE_GRID);
+    if (sample % CHART_GRID_SAMPLES == 0) {
+        for (int row = 0; row < height; row++) {
+            fill(row, column, 1, CHART_PALETTE_GRID);
+        }
+    }
+
+    if (index < 0) {
+        return;
+    }
+
+    // Traces: the segment from the previous sample to this one, clipped to this sample's
+    // columns so pixels scrolled in from earlier updates are never touched again
+    raster_surface_t block         = {(uint16_t *)pixels + column, column_step, height, width};
+    raster_index8_surface_t block8 = {pixels + column, column_step, height, width};
+    int32_t x1                     = RASTER_FX(column_step) - RASTER_FX_ONE / 2;
+    int32_t x0                     = x1 - RASTER_FX(column_step);
+    for (int t = 0; t < trace_count; t++) {
+        int32_t y1 = valueToY(traces[t], views[t][index]);
+        int32_t y0 = index > 0 ? valueToY(traces[t], views[t][index - 1]) : y1;
+        if (format == CHART_FORMAT_INDEX8) {
+            raster_ramp_t ramp = {(uint8_t)(CHART_PALETTE_TRACES + t * CHART_RAMP_STEPS),
+                                  CHART_RAMP_STEPS,
+                                  CHART_PALETTE_BACKGROUND};
+            raster_line_aa_index8(&block8, x0, y0, x1, y1, CHART_TRACE_WIDTH, &ramp);
+        }
+        else {
+            raster_line_aa(&block, x0, y0, x1, y1, CHART_TRACE_WIDTH, traces[t].color);
+        }
+    }
+}
+
+void ScrollingChart::redraw(const HistoryView *views, uint32_t sample_count)
+{
+    int samples = width / column_step;
+    int n       = views[0].size();
+
+    // Oldest visible sample on the left; columns before the first sample stay empty
+    for (int s = 0; s < samples; s++) {
+        int index = n - samples + s;
+        drawSample(views, index, s * column_step, sample_count - n + index);
+    }
+}
+
+int ScrollingChart::update(const HistoryView *views, uint32_t sample_count)
+{
+    if (!pixels || trace_count == 0 || !views) {
+        return 0;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    int samples      = width / column_step;
+    int n            = views[0].size();
+    int columns;
+
+    if (!valid || sample_count < drawn_count || sample_count - drawn_count >= (uint32_t)samples ||
+        sample_count - drawn_count > (uint32_t)n) {
+        // First draw, history reset or more new samples than fit: start over
+        redraw(views, sample_count);
+        columns = width;
+        stats.full_redraws++;
+    }
+    else {
+        int fresh = (int)(sample_count - drawn_count);
+        if (fresh == 0) {
+            return 0;
+        }
+
+        scroll(fresh * column_step);
+        for (int k = 0; k < fresh; k++) {
+            int index = n - fresh + k;
+            drawSample(views, index, width - (fresh - k) * column_step, sample_count - fresh + k);
+        }
+        columns = fresh * column_step;
+    }
+
+    drawn_count = sample_count;
+    valid       = true;
+
+    stats.updates++;
+    stats.columns_drawn += columns;
+    stats.last_update_us = (uint32_t)(esp_timer_get_time() - start_us);
+    ESP_LOGD(TAG, "Drew %d columns in %u us", columns, (unsigned)stats.last_update_us);
+
+    if (attached) {
+        slint_platform_overlay_changed();
+    }
+    return columns;
+}
+
+void ScrollingChart::setVisible(bool visible)
+{
+    if (!pixels || visible == attached) {
+        return;
+    }
+
+    attached = visible;
+    if (visible && format == CHART_FORMAT_INDEX8) {
+        slint_platform_set_overlay_index8(pixels, palette, x, y, width, height);
+    }
+    else if (visible) {
+        slint_platform_set_overlay((const uint16_t *)pixels, x, y, width, height);
+    }
+    else {
+        slint_platform_set_overlay(nullptr, 0, 0, 0, 0);
+    }
+}
+
+void chart_benchmark(void)
+{
+    static const chart_format_t formats[] = {CHART_FORMAT_RGB565, CHART_FORMAT_INDEX8};
+
+    // Four slowly drifting waves, like a shot in progress
+    float *ring  = (float *)heap_caps_malloc(4 * SENSOR_HISTORY_LENGTH * sizeof(float),
+                                            MALLOC_CAP_SPIRAM);
+    size_t bytes = (size_t)CHART_BENCHMARK_SAMPLES * CHART_BENCHMARK_STEP *
+                   CHART_BENCHMARK_HEIGHT * sizeof(uint16_t);
+    uint16_t *frame = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (!ring || !frame) {
+        ESP_LOGE(TAG, "Not enough PSRAM for the chart benchmark");
+        heap_caps_free(ring);
+        heap_caps_free(frame);
+        return;
+    }
+    for (int t = 0; t < 4; t++) {
+        for (int i = 0; i < SENSOR_HISTORY_LENGTH; i++) {
+            ring[t * SENSOR_HISTORY_LENGTH + i] = 50.0f + 45.0f * sinf((i + 13 * t) * 0.11f);
+        }
+    }
+
+    for (chart_format_t format : formats) {
+        ScrollingChart chart;
+        if (chart.init(0,
+                       0,
+                       CHART_BENCHMARK_SAMPLES,
+                       CHART_BENCHMARK_STEP,
+                       CHART_BENCHMARK_HEIGHT,
+                       0x18C3,
+                       0x2945,
+                       format) != ESP_OK) {
+            break;
+        }
+        static const uint16_t colors[4] = {0xFAC0, 0xF945, 0x045B, 0x5DDD};  // Plot traces
+        for (int t = 0; t < 4; t++) {
+            chart.addTrace(colors[t], 0.0f, 100.0f);
+        }
+
+        HistoryView views[4] = {
+            HistoryView(ring, 0, CHART_BENCHMARK_SAMPLES),
+            HistoryView(ring + SENSOR_HISTORY_LENGTH, 0, CHART_BENCHMARK_SAMPLES),
+            HistoryView(ring + 2 * SENSOR_HISTORY_LENGTH, 0, CHART_BENCHMARK_SAMPLES),
+            HistoryView(ring + 3 * SENSOR_HISTORY_LENGTH, 0, CHART_BENCHMARK_SAMPLES),
+        };
+        uint32_t count = CHART_BENCHMARK_SAMPLES;
+
+        chart.update(views, count);
+        uint32_t redraw_us = chart.getStats().last_update_us;
+
+        // One new sample per update, the steady state while a shot runs
+        uint64_t scroll_us = 0;
+        for (int i = 0; i < CHART_BENCHMARK_SCROLLS; i++) {
+            int head = (i + 1) % SENSOR_HISTORY_LENGTH;
+            for (int t = 0; t < 4; t++) {
+                views[t] = HistoryView(ring + t * SENSOR_HISTORY_LENGTH,
+                                       head,
+                                       CHART_BENCHMARK_SAMPLES);
+            }
+            chart.update(views, ++count);
+            scroll_us += chart.getStats().last_update_us;
+        }
+
+        // What the overlay costs per frame it is sent in
+        int64_t start_us = esp_timer_get_time();
+        int w = CHART_BENCHMARK_SAMPLES * CHART_BENCHMARK_STEP;
+        for (int row = 0; row < CHART_BENCHMARK_HEIGHT; row++) {
+            if (format == CHART_FORMAT_INDEX8) {
+                pixel_index8_to_rgb565(frame + (size_t)row * w,
+                                       chart.pixels + (size_t)row * w,
+                                       chart.palette,
+                                       w);
+            }
+            else {
+                memcpy(frame + (size_t)row * w,
+                       (const uint16_t *)chart.pixels + (size_t)row * w,
+                       w * sizeof(uint16_t));
+            }
+        }
+        uint32_t copy_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+        ESP_LOGI(TAG,
+                 "%-7s surface %6u bytes, redraw %5u us, scroll %4u us, copy to frame %4u us",
+                 format == CHART_FORMAT_INDEX8 ? "indexed" : "RGB565",
+                 (unsigned)chart.getStats().surface_bytes,
+                 (unsigned)redraw_us,
+                 (unsigned)(scroll_us / CHART_BENCHMARK_SCROLLS),
+                 (unsigned)copy_us);
+        chart.deinit();
+    }
+
+    heap_caps_free(ring);
+    heap_caps_free(frame);
+}
@@ -0,0 +1,247 @@
+#include "display/pixel_kernels.h"
+
+#include <cstring>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "tft_config.h"
+
+static const char *TAG = "pixels";
+
+/* Benchmark working set: 16 full-width lines, iterated PIXEL_BENCHMARK_PASSES times */
+#define PIXEL_BENCHMARK_PIXELS (TFT_WIDTH * 16)
+#define PIXEL_BENCHMARK_PASSES 20
+
+static inline bool aligned(const void *ptr, uintptr_t bytes)
+{
+    return ((uintptr_t)ptr & (bytes - 1)) == 0;
+}
+
+static inline uint16_t swap16(uint16_t px)
+{
+    return (uint16_t)((px << 8) | (px >> 8));
+}
+
+// -------------------------------------------------------------
+// PORTABLE KERNELS
+// -------------------------------------------------------------
+
+static void fill_scalar(uint16_t *dst, uint16_t color, size_t count)
+{
+    if (count > 0 && !aligned(dst, 4)) {
+        *dst++ = color;
+        count--;
+    }
+
+    // Two pixels per 32-bit store
+    uint32_t pair   = color | ((uint32_t)color << 16);
+    uint32_t *dst32 = (uint32_t *)dst;
+    size_t pairs    = count / 2;
+    for (size_t i = 0; i < pairs; i++) {
+        dst32[i] = pair;
+    }
+
+    if (count & 1) {
+        dst[count - 1] = color;
+    }
+}
+
+static void copy_swap_scalar(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    if (count > 0 && !aligned(dst, 4)) {
+        *dst++ = swap16(*src++);
+        count--;
+    }
+
+    if (!aligned(src, 4)) {
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = swap16(src[i]);
+        }
+        return;
+    }
+
+    // Swap two pixels per 32-bit word
+    const uint32_t *src32 = (const uint32_t *)src;
+    uint32_t *dst32       = (uint32_t *)dst;
+    size_t pairs          = count / 2;
+    for (size_t i = 0; i < pairs; i++) {
+        uint32_t v = src32[i];
+        dst32[i]   = ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu);
+    }
+
+    if (count & 1) {
+        dst[count - 1] = swap16(src[count - 1]);
+    }
+}
+
+static void index8_to_rgb565_scalar(uint16_t *dst,
+                                    const uint8_t *src,
+                                    const uint16_t *palette,
+                                    size_t count)
+{
+    while (count > 0 && !aligned(src, 4)) {
+        *dst++ = palette[*src++];
+        count--;
+    }
+
+    // One 32-bit load per four indices; the lookups dominate
+    const uint32_t *src32 = (const uint32_t *)src;
+    size_t quads          = count / 4;
+    for (size_t i = 0; i < quads; i++, dst += 4) {
+        uint32_t v = src32[i];
+        dst[0]     = palette[v & 0xFF];
+        dst[1]     = palette[(v >> 8) & 0xFF];
+        dst[2]     = palette[(v >> 16) & 0xFF];
+        dst[3]     = palette[v >> 24];
+    }
+
+    src += quads * 4;
+    for (size_t i = 0; i < (count & 3); i++) {
+        dst[i] = palette[src[i]];
+    }
+}
+
+// -------------------------------------------------------------
+// ESP32-S3 PIE KERNELS
+// -------------------------------------------------------------
+
+#if PIXEL_KERNELS_PIE
+// Store blocks of 16 pixels; dst must be 16-byte aligned
+static void fill_pie(uint16_t *dst, uint16_t color, size_t blocks)
+{
+    asm volatile(
+        "ee.vldbc.16 q0, %[color]\n"
+        "loopnez %[blocks], 1f\n"
+        "ee.vst.128.ip q0, %[dst], 16\n"
+        "ee.vst.128.ip q0, %[dst], 16\n"
+        "1:\n"
+        : [dst] "+r"(dst)
+        : [color] "r"(&color), [blocks] "r"(blocks)
+        : "memory");
+}
+
+// Byte-swap blocks of 16 pixels; src and dst must be 16-byte aligned. Unzipping two
+// registers separates low and high bytes, zipping them back in reverse order swaps them.
+static void copy_swap_pie(uint16_t *dst, const uint16_t *src, size_t blocks)
+{
+    asm volatile(
+        "loopnez %[blocks], 1f\n"
+        "ee.vld.128.ip q0, %[src], 16\n"
+        "ee.vld.128.ip q1, %[src], 16\n"
+        "ee.vunzip.8 q0, q1\n"
+        "ee.vzip.8 q1, q0\n"
+        "ee.vst.128.ip q1, %[dst], 16\n"
+        "ee.vst.128.ip q0, %[dst], 16\n"
+        "1:\n"
+        : [dst] "+r"(dst), [src] "+r"(src)
+        : [blocks] "r"(blocks)
+        : "memory");
+}
+#endif
+
+// -------------------------------------------------------------
+// PUBLIC API
+// -------------------------------------------------------------
+
+extern "C" {
+
+void pixel_fill_rgb565(uint16_t *dst, uint16_t color, size_t count)
+{
+#if PIXEL_KERNELS_PIE
+    // Reach 16-byte alignment with scalar stores, then fill whole vector blocks
+    size_t head = ((16 - ((uintptr_t)dst & 15)) & 15) / sizeof(uint16_t);
+    if (aligned(dst, 2) && count >= head + PIXEL_PIE_BLOCK) {
+        fill_scalar(dst, color, head);
+        dst += head;
+        count -= head;
+
+        size_t blocks = count / PIXEL_PIE_BLOCK;
+        fill_pie(dst, color, blocks);
+        dst += blocks * PIXEL_PIE_BLOCK;
+        count -= blocks * PIXEL_PIE_BLOCK;
+    }
+#endif
+    fill_scalar(dst, color, count);
+}
+
+void pixel_copy_swap_rgb565(uint16_t *dst, const uint16_t *src, size_t count)
+{
+#if PIXEL_KERNELS_PIE
+    size_t head = ((16 - ((uintptr_t)dst & 15)) & 15) / sizeof(uint16_t);
+    if (aligned(dst, 2) && count >= head + PIXEL_PIE_BLOCK && aligned(src + head, 16)) {
+        copy_swap_scalar(dst, src, head);
+        dst += head;
+        src += head;
+        count -= head;
+
+        size_t blocks = count / PIXEL_PIE_BLOCK;
+        copy_swap_pie(dst, src, blocks);
+        dst += blocks * PIXEL_PIE_BLOCK;
+        src += blocks * PIXEL_PIE_BLOCK;
+        count -= blocks * PIXEL_PIE_BLOCK;
+    }
+#endif
+    copy_swap_scalar(dst, src, count);
+}
+
+void pixel_index8_to_rgb565(uint16_t *dst,
+                            const uint8_t *src,
+                            const uint16_t *palette,
+                            size_t count)
+{
+    index8_to_rgb565_scalar(dst, src, palette, count);
+}
+
+void pixel_kernels_benchmark(void)
+{
+    size_t bytes = PIXEL_BENCHMARK_PIXELS * sizeof(uint16_t);
+    uint16_t *a  = (uint16_t *)heap_caps_aligned_alloc(16, bytes, MALLOC_CAP_INTERNAL);
+    uint16_t *b  = (uint16_t *)heap_caps_aligned_alloc(16, bytes, MALLOC_CAP_INTERNAL);
+    uint8_t *idx = (uint8_t *)heap_caps_malloc(PIXEL_BENCHMARK_PIXELS, MALLOC_CAP_INTERNAL);
+    if (!a || !b || !idx) {
+        ESP_LOGE(TAG, "Not enough internal RAM for the pixel benchmark");
+        heap_caps_free(a);
+        heap_caps_free(b);
+        heap_caps_free(idx);
+        return;
+    }
+    memset(a, 0x5A, bytes);
+    memset(idx, 0xA5, PIXEL_BENCHMARK_PIXELS);
+
+    const uint32_t pixels = PIXEL_BENCHMARK_PIXELS * PIXEL_BENCHMARK_PASSES;
+    int64_t start_us;
+
+// Run one kernel for all passes and log megapixels per second (pixels per microsecond)
+#define PIXEL_BENCH(name, call)                                                    \
+    start_us = esp_timer_get_time();                                               \
+    for (int pass = 0; pass < PIXEL_BENCHMARK_PASSES; pass++) {                    \
+        call;                                                                      \
+    }                                                                              \
+    ESP_LOGI(TAG,                                                                  \
+             "%-18s %6.1f MP/s",                                                   \
+             name,                                                                 \
+             pixels / (float)(esp_timer_get_time() - start_us + 1))
+
+    ESP_LOGI(TAG,
+             "Pixel kernels: %d pixels x %d passes, PIE %s",
+             PIXEL_BENCHMARK_PIXELS,
+             PIXEL_BENCHMARK_PASSES,
+             PIXEL_KERNELS_PIE ? "enabled" : "disabled");
+
+    PIXEL_BENCH("fill", pixel_fill_rgb565(b, 0x1234, PIXEL_BENCHMARK_PIXELS));
+    PIXEL_BENCH("fill scalar", fill_scalar(b, 0x1234, PIXEL_BENCHMARK_PIXELS));
+    PIXEL_BENCH("copy swap", pixel_copy_swap_rgb565(b, a, PIXEL_BENCHMARK_PIXELS));
+    PIXEL_BENCH("copy swap scalar", copy_swap_scalar(b, a, PIXEL_BENCHMARK_PIXELS));
+    PIXEL_BENCH("index8 to rgb565",
+                pixel_index8_to_rgb565(b, idx, (const uint16_t *)a, PIXEL_BENCHMARK_PIXELS));
+    PIXEL_BENCH("memcpy reference", memcpy(b, a, bytes));
+
+#undef PIXEL_BENCH
+
+    heap_caps_free(a);
+    heap_caps_free(b);
+    heap_caps_free(idx);
+}
+
+}  // extern "C"
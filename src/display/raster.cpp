@@ -0,0 +1,536 @@
+#include "display/raster.h"
+
+#include <cstring>
+
+#include "display/pixel_kernels.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "raster";
+
+/* Unit vectors are fixed point with 12 fractional bits, so products with fixed point
+ * coordinates anywhere on the panel fit in 32 bits */
+#define UNIT_SHIFT 12
+#define UNIT_ONE (1 << UNIT_SHIFT)
+
+#define HALF (RASTER_FX_ONE / 2)
+
+/* Benchmark surface and workload */
+#define RASTER_BENCHMARK_WIDTH 240
+#define RASTER_BENCHMARK_HEIGHT 200
+#define RASTER_BENCHMARK_LINES 500
+#define RASTER_BENCHMARK_POINTS 120
+#define RASTER_BENCHMARK_ARCS 50
+
+// sin() of 0..90 degrees, fixed point with UNIT_SHIFT fractional bits
+static const int16_t sine_table[91] = {
+    0,    71,   143,  214,  286,  357,  428,  499,  570,  641,  711,  782,  852,  921,
+    991,  1060, 1129, 1198, 1266, 1334, 1401, 1468, 1534, 1600, 1666, 1731, 1796, 1860,
+    1923, 1986, 2048, 2110, 2171, 2231, 2290, 2349, 2408, 2465, 2522, 2578, 2633, 2687,
+    2741, 2793, 2845, 2896, 2946, 2996, 3044, 3091, 3138, 3183, 3228, 3271, 3314, 3355,
+    3396, 3435, 3474, 3511, 3547, 3582, 3617, 3650, 3681, 3712, 3742, 3770, 3798, 3824,
+    3849, 3873, 3896, 3917, 3937, 3956, 3974, 3991, 4006, 4021, 4034, 4046, 4056, 4065,
+    4074, 4080, 4086, 4090, 4094, 4095, 4096};
+
+static inline int32_t clamp_coverage(int32_t c)
+{
+    return c < 0 ? 0 : (c > RASTER_FX_ONE ? RASTER_FX_ONE : c);
+}
+
+static uint32_t isqrt32(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit  = 1u << 30;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static int32_t sine_deg(int deg)
+{
+    deg %= 360;
+    if (deg < 0) {
+        deg += 360;
+    }
+    if (deg <= 90) {
+        return sine_table[deg];
+    }
+    if (deg <= 180) {
+        return sine_table[180 - deg];
+    }
+    if (deg <= 270) {
+        return -sine_table[deg - 180];
+    }
+    return -sine_table[360 - deg];
+}
+
+// Writes pixels of one row, merging fully covered pixels into span fills
+class RowWriter {
+public:
+    RowWriter(uint16_t *row, uint16_t color)
+        : row(row), color(color), run_start(-1), run_end(0), written(0)
+    {
+    }
+
+    // coverage is fixed point, 0 to RASTER_FX_ONE
+    inline void put(int x, int32_t coverage)
+    {
+        if (coverage >= RASTER_FX_ONE) {
+            if (run_start < 0) {
+                run_start = x;
+            }
+            run_end = x + 1;
+            return;
+        }
+
+        flush();
+        if (coverage > 0) {
+            uint8_t alpha = (uint8_t)(coverage - (coverage >> RASTER_FX_SHIFT));
+            row[x]        = pixel_mix_rgb565(row[x], color, alpha);
+            written++;
+        }
+    }
+
+    inline void flush()
+    {
+        if (run_start >= 0) {
+            pixel_fill_rgb565(row + run_start, color, run_end - run_start);
+            written += run_end - run_start;
+            run_start = -1;
+        }
+    }
+
+    uint32_t count() const { return written; }
+
+private:
+    uint16_t *row;
+    uint16_t color;
+    int run_start;
+    int run_end;
+    uint32_t written;
+};
+
+// Writes pixels of one row of an indexed surface as steps of a palette ramp. Indexed
+// pixels cannot be blended, so a partly covered pixel of another color keeps that color
+// unless the new one covers most of it.
+class IndexRowWriter {
+public:
+    IndexRowWriter(uint8_t *row, const raster_ramp_t &ramp) : row(row), ramp(ramp), written(0)
+    {
+    }
+
+    inline void put(int x, int32_t coverage)
+    {
+        int level = ((coverage * ramp.steps) >> RASTER_FX_SHIFT) - 1;
+        if (level < 0) {
+            return;
+        }
+        if (level >= ramp.steps) {
+            level = ramp.steps - 1;
+        }
+
+        uint8_t px    = row[x];
+        int own_level = px - ramp.base;
+        if (own_level >= 0 && own_level < ramp.steps) {
+            // Overlapping rims of the same color keep the stronger one
+            if (level <= own_level) {
+                return;
+            }
+        }
+        else if (px != ramp.background && level < ramp.steps / 2) {
+            return;
+        }
+        row[x] = (uint8_t)(ramp.base + level);
+        written++;
+    }
+
+    inline void flush() {}
+
+    uint32_t count() const { return written; }
+
+private:
+    uint8_t *row;
+    const raster_ramp_t &ramp;
+    uint32_t written;
+};
+
+// -------------------------------------------------------------
+// LINES
+// -------------------------------------------------------------
+
+// Shared by all surface formats; Writer turns coverage into pixels of one row
+template <typename Writer, typename Surface, typename Paint>
+static uint32_t line_aa(const Surface *surface,
+                        int32_t x0,
+                        int32_t y0,
+                        int32_t x1,
+                        int32_t y1,
+                        int32_t width,
+                        const Paint &paint)
+{
+    if (!surface || width <= 0) {
+        return 0;
+    }
+
+    int32_t dx    = x1 - x0;
+    int32_t dy    = y1 - y0;
+    int32_t half  = width / 2;
+    int32_t reach = half + HALF;  // Distance from the centerline with nonzero coverage
+
+    // Direction as a unit vector; a zero-length segment draws a dot
+    uint32_t len = isqrt32((uint32_t)(((int64_t)dx * dx + (int64_t)dy * dy) >> 4)) << 2;
+    int32_t ux   = len ? (int32_t)(((int64_t)dx << UNIT_SHIFT) / len) : UNIT_ONE;
+    int32_t uy   = len ? (int32_t)(((int64_t)dy << UNIT_SHIFT) / len) : 0;
+
+    // Rows of the bounding box, clipped
+    int32_t top    = (y0 < y1 ? y0 : y1) - reach;
+    int32_t bottom = (y0 > y1 ? y0 : y1) + reach;
+    int32_t left   = (x0 < x1 ? x0 : x1) - reach;
+    int32_t right  = (x0 > x1 ? x0 : x1) + reach;
+    int row_first  = top >> RASTER_FX_SHIFT;
+    int row_last   = bottom >> RASTER_FX_SHIFT;
+    int col_first  = left >> RASTER_FX_SHIFT;
+    int col_last   = right >> RASTER_FX_SHIFT;
+    row_first      = row_first < 0 ? 0 : row_first;
+    row_last       = row_last >= surface->height ? surface->height - 1 : row_last;
+    col_first      = col_first < 0 ? 0 : col_first;
+    col_last       = col_last >= surface->width ? surface->width - 1 : col_last;
+
+    // Steep enough segments only cover a band around the centerline in each row
+    bool banded     = (int64_t)(dy < 0 ? -dy : dy) * 4 > (int64_t)len;
+    int32_t band_dx = banded ? (int32_t)((int64_t)reach * (int32_t)len / (dy < 0 ? -dy : dy)) : 0;
+
+    uint32_t written = 0;
+    for (int row = row_first; row <= row_last; row++) {
+        int32_t py = (row << RASTER_FX_SHIFT) + HALF - y0;
+
+        int first = col_first;
+        int last  = col_last;
+        if (banded) {
+            int32_t xc = x0 + (int32_t)((int64_t)dx * py / dy);
+            int lo     = (xc - band_dx) >> RASTER_FX_SHIFT;
+            int hi     = (xc + band_dx) >> RASTER_FX_SHIFT;
+            first      = lo > first ? lo : first;
+            last       = hi < last ? hi : last;
+        }
+        if (first > last) {
+            continue;
+        }
+
+        // Distance along and across the segment, stepped per pixel at full precision
+        int32_t px         = (first << RASTER_FX_SHIFT) + HALF - x0;
+        int32_t along_acc  = px * ux + py * uy;
+        int32_t across_acc = px * uy - py * ux;
+
+        Writer out(surface->pixels + (size_t)row * surface->stride, paint);
+        for (int x = first; x <= last; x++) {
+            int32_t along  = along_acc >> UNIT_SHIFT;
+            int32_t across = across_acc >> UNIT_SHIFT;
+            along_acc += ux << RASTER_FX_SHIFT;
+            across_acc += uy << RASTER_FX_SHIFT;
+
+            int32_t ac = across < 0 ? -across : across;
+            if (ac >= reach) {
+                out.put(x, 0);
+                continue;
+            }
+
+            // Past either end the distance is to the end point, giving round caps
+            int32_t dist = ac;
+            int32_t past = along < 0 ? -along : (along > (int32_t)len ? along - (int32_t)len : 0);
+            if (past >= reach) {
+                out.put(x, 0);
+                continue;
+            }
+            if (past > 0) {
+                dist = (int32_t)isqrt32((uint32_t)(past * past + ac * ac));
+            }
+            out.put(x, clamp_coverage(reach - dist));
+        }
+        out.flush();
+        written += out.count();
+    }
+    return written;
+}
+
+extern "C" {
+
+uint32_t raster_line_aa(const raster_surface_t *surface,
+                        int32_t x0,
+                        int32_t y0,
+                        int32_t x1,
+                        int32_t y1,
+                        int32_t width,
+                        uint16_t color)
+{
+    return line_aa<RowWriter>(surface, x0, y0, x1, y1, width, color);
+}
+
+uint32_t raster_line_aa_index8(const raster_index8_surface_t *surface,
+                               int32_t x0,
+                               int32_t y0,
+                               int32_t x1,
+                               int32_t y1,
+                               int32_t width,
+                               const raster_ramp_t *ramp)
+{
+    if (!ramp || ramp->steps == 0) {
+        return 0;
+    }
+    return line_aa<IndexRowWriter>(surface, x0, y0, x1, y1, width, *ramp);
+}
+
+uint32_t raster_polyline_aa(const raster_surface_t *surface,
+                            const raster_point_t *points,
+                            int count,
+                            int32_t width,
+                            uint16_t color)
+{
+    if (!points || count <= 0) {
+        return 0;
+    }
+    if (count == 1) {
+        return raster_line_aa(
+            surface, points[0].x, points[0].y, points[0].x, points[0].y, width, color);
+    }
+
+    uint32_t written = 0;
+    for (int i = 1; i < count; i++) {
+        written += raster_line_aa(
+            surface, points[i - 1].x, points[i - 1].y, points[i].x, points[i].y, width, color);
+    }
+    return written;
+}
+
+// -------------------------------------------------------------
+// ARCS
+// -------------------------------------------------------------
+
+// Half-width of a circle of the given fixed point radius at fixed point height y
+static uint16_t circle_half_width(int32_t radius, int32_t y)
+{
+    if (radius <= y) {
+        return 0;
+    }
+    return (uint16_t)isqrt32((uint32_t)(radius * radius - y * y));
+}
+
+bool raster_arc_table_init(raster_arc_table_t *table, int radius, int inner_radius)
+{
+    if (!table || radius <= 0 || radius > RASTER_ARC_MAX_RADIUS || inner_radius < 0 ||
+        inner_radius >= radius) {
+        return false;
+    }
+
+    int32_t outer = RASTER_FX(radius);
+    int32_t inner = RASTER_FX(inner_radius);
+
+    table->radius       = radius;
+    table->inner_radius = inner_radius;
+    for (int k = 0; k <= radius; k++) {
+        int32_t y = (k << RASTER_FX_SHIFT) + HALF;
+
+        table->rows[k].outer_edge = circle_half_width(outer + HALF, y);
+        table->rows[k].outer_full = circle_half_width(outer - HALF, y);
+        table->rows[k].inner_full = inner_radius ? circle_half_width(inner + HALF, y) : 0;
+        table->rows[k].inner_edge = inner_radius ? circle_half_width(inner - HALF, y) : 0;
+    }
+    return true;
+}
+
+uint32_t raster_arc_aa(const raster_surface_t *surface,
+                       const raster_arc_table_t *table,
+                       int cx,
+                       int cy,
+                       int start_deg,
+                       int end_deg,
+                       uint16_t color)
+{
+    if (!surface || !table) {
+        return 0;
+    }
+
+    int sweep = end_deg - start_deg;
+    if (sweep <= 0) {
+        return 0;
+    }
+    bool full = sweep >= 360;
+    bool wide = sweep > 180;  // The arc is the union, not the intersection, of two half-planes
+
+    // Directions of both ends; 0 degrees points up and angles grow clockwise on screen
+    int32_t sx = sine_deg(start_deg);
+    int32_t sy = -sine_deg(start_deg + 90);
+    int32_t ex = sine_deg(end_deg);
+    int32_t ey = -sine_deg(end_deg + 90);
+
+    int32_t outer = RASTER_FX(table->radius);
+    int32_t inner = RASTER_FX(table->inner_radius);
+
+    uint32_t written = 0;
+    for (int j = -table->radius - 1; j <= table->radius; j++) {
+        int row = cy + j;
+        if (row < 0 || row >= surface->height) {
+            continue;
+        }
+
+        const auto &span = table->rows[j >= 0 ? j : -1 - j];
+        if (span.outer_edge <= HALF) {
+            continue;
+        }
+
+        // Columns i whose center |i + 0.5| lies between the inner and outer edge
+        int i_min = 0;
+        int i_max = (span.outer_edge - HALF) >> RASTER_FX_SHIFT;
+        if (span.inner_edge > HALF) {
+            i_min = (span.inner_edge - HALF + RASTER_FX_ONE - 1) >> RASTER_FX_SHIFT;
+        }
+
+        int32_t py = (j << RASTER_FX_SHIFT) + HALF;
+        RowWriter out(surface->pixels + (size_t)row * surface->stride, color);
+
+        // Left span mirrored, then right span, so pixels are visited left to right
+        for (int side = 0; side < 2; side++) {
+            int first = side == 0 ? -1 - i_max : i_min;
+            int last  = side == 0 ? -1 - i_min : i_max;
+            first     = cx + first < 0 ? -cx : first;
+            last      = cx + last >= surface->width ? surface->width - 1 - cx : last;
+            if (first > last) {
+                continue;
+            }
+
+            // Signed distances to both end rays, stepped per pixel at full precision
+            int32_t px     = (first << RASTER_FX_SHIFT) + HALF;
+            int32_t d0_acc = sx * py - sy * px;
+            int32_t d1_acc = px * ey - py * ex;
+
+            for (int i = first; i <= last; i++, px += RASTER_FX_ONE) {
+                int32_t d0 = d0_acc >> UNIT_SHIFT;
+                int32_t d1 = d1_acc >> UNIT_SHIFT;
+                d0_acc -= sy << RASTER_FX_SHIFT;
+                d1_acc += ey << RASTER_FX_SHIFT;
+
+                int32_t ax = px < 0 ? -px : px;
+
+                // Ring coverage, exact only between the edge and full circles
+                int32_t coverage = RASTER_FX_ONE;
+                if (ax > span.outer_full || ax < span.inner_full) {
+                    // Quarter-pixel precision keeps the squares in 32 bits
+                    int32_t qx   = ax >> 2;
+                    int32_t qy   = (py < 0 ? -py : py) >> 2;
+                    int32_t dist = (int32_t)isqrt32((uint32_t)(qx * qx + qy * qy)) << 2;
+                    int32_t c_o  = clamp_coverage(outer + HALF - dist);
+                    int32_t c_i  = inner ? clamp_coverage(dist - inner + HALF) : RASTER_FX_ONE;
+                    coverage     = c_o < c_i ? c_o : c_i;
+                }
+
+                if (!full && coverage > 0) {
+                    int32_t a0    = clamp_coverage(d0 + HALF);
+                    int32_t a1    = clamp_coverage(d1 + HALF);
+                    int32_t angle = wide ? (a0 > a1 ? a0 : a1) : (a0 < a1 ? a0 : a1);
+                    coverage      = (coverage * angle) >> RASTER_FX_SHIFT;
+                }
+                out.put(cx + i, coverage);
+            }
+            out.flush();
+        }
+        written += out.count();
+    }
+    return written;
+}
+
+void raster_benchmark(void)
+{
+    raster_surface_t surface = {nullptr,
+                                RASTER_BENCHMARK_WIDTH,
+                                RASTER_BENCHMARK_HEIGHT,
+                                RASTER_BENCHMARK_WIDTH};
+    size_t bytes             = RASTER_BENCHMARK_WIDTH * RASTER_BENCHMARK_HEIGHT * sizeof(uint16_t);
+    surface.pixels           = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL);
+    raster_point_t *points   = (raster_point_t *)heap_caps_malloc(
+        RASTER_BENCHMARK_POINTS * sizeof(raster_point_t), MALLOC_CAP_INTERNAL);
+    raster_arc_table_t *table = (raster_arc_table_t *)heap_caps_malloc(sizeof(raster_arc_table_t),
+                                                                       MALLOC_CAP_INTERNAL);
+    if (!surface.pixels || !points || !table) {
+        ESP_LOGE(TAG, "Not enough internal RAM for the raster benchmark");
+        heap_caps_free(surface.pixels);
+        heap_caps_free(points);
+        heap_caps_free(table);
+        return;
+    }
+    memset(surface.pixels, 0, bytes);
+
+    // Chart-like trace: a ramp with a superimposed zigzag
+    for (int i = 0; i < RASTER_BENCHMARK_POINTS; i++) {
+        points[i].x = RASTER_FX(i * 2) + HALF;
+        points[i].y = RASTER_FX(180 - i) + ((i & 1) ? RASTER_FX(6) : 0);
+    }
+
+    int64_t start_us;
+    uint32_t pixels;
+    uint32_t elapsed_us;
+
+// Run a primitive n times and log cost per primitive and megapixels per second
+#define RASTER_BENCH(name, n, call)                                                \
+    pixels   = 0;                                                                  \
+    start_us = esp_timer_get_time();                                               \
+    for (int iter = 0; iter < (n); iter++) {                                       \
+        pixels += call;                                                            \
+    }                                                                              \
+    elapsed_us = (uint32_t)(esp_timer_get_time() - start_us) + 1;                  \
+    ESP_LOGI(TAG,                                                                  \
+             "%-22s %7.1f us each, %6.1f MP/s",                                    \
+             name,                                                                 \
+             elapsed_us / (float)(n),                                              \
+             pixels / (float)elapsed_us)
+
+    RASTER_BENCH("line 100px w1.5",
+                 RASTER_BENCHMARK_LINES,
+                 raster_line_aa(&surface,
+                                RASTER_FX(10 + (iter % 40)),
+                                RASTER_FX(20),
+                                RASTER_FX(100 + (iter % 40)),
+                                RASTER_FX(60),
+                                RASTER_FX(1.5),
+                                0xFAC0));
+    RASTER_BENCH("line 100px w4",
+                 RASTER_BENCHMARK_LINES,
+                 raster_line_aa(&surface,
+                                RASTER_FX(10),
+                                RASTER_FX(20 + (iter % 40)),
+                                RASTER_FX(110),
+                                RASTER_FX(40 + (iter % 40)),
+                                RASTER_FX(4),
+                                0xF945));
+    RASTER_BENCH("polyline 120 points",
+                 RASTER_BENCHMARK_ARCS,
+                 raster_polyline_aa(
+                     &surface, points, RASTER_BENCHMARK_POINTS, RASTER_FX(1.5), 0x045B));
+
+    raster_arc_table_init(table, 90, 78);
+    RASTER_BENCH("arc r90 w12 270deg",
+                 RASTER_BENCHMARK_ARCS,
+                 raster_arc_aa(&surface, table, 120, 100, -135, 135, 0x045B));
+    RASTER_BENCH("ring r90 w12",
+                 RASTER_BENCHMARK_ARCS,
+                 raster_arc_aa(&surface, table, 120, 100, 0, 360, 0x2945));
+
+#undef RASTER_BENCH
+
+    heap_caps_free(surface.pixels);
+    heap_caps_free(points);
+    heap_caps_free(table);
+}
+
+}  // extern "C"
@@ -0,0 +1,1105 @@
+#include "display/slint_platform.h"
+
+#include <slint-platform.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include "display/layer_cache.h"
+#include "display/pixel_kernels.h"
+#include "display_driver.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "tft_config.h"
+
+static const char *TAG = "slint_platform";
+
+/* Lines copied to the DMA bounce buffer per transfer */
+#define FLUSH_BAND_LINES 4
+
+/* Frames that may be rendered ahead of the panel; line mode streams a single frame */
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+#define FLUSH_QUEUE_DEPTH (DISPLAY_LINE_BUFFER_COUNT + 1)  // Every line buffer and a frame end
+#define MAX_FRAMES_IN_FLIGHT 1
+#define OVERLAY_COPIES 1  // Frames that must resend a changed overlay
+#define REPAINT_BUFFER_TYPE SoftwareRenderer::RepaintBufferType::ReusedBuffer
+#else
+#define FLUSH_QUEUE_DEPTH SLINT_FLUSH_QUEUE_DEPTH
+#define MAX_FRAMES_IN_FLIGHT 2
+#define OVERLAY_COPIES 2  // One per framebuffer
+#define REPAINT_BUFFER_TYPE SoftwareRenderer::RepaintBufferType::SwappedBuffers
+#endif
+
+using slint::platform::Rgb565Pixel;
+using slint::platform::SoftwareRenderer;
+
+// A band of rendered pixels waiting to be sent to the panel: rows of a framebuffer, or a
+// line buffer. Flush workers prepare bands in parallel but send them in seq order.
+struct FlushJob {
+    int buffer;      // Framebuffer or line buffer index
+    uint32_t seq;    // Position in the transfer order
+    bool frame_end;  // Last band of the frame
+    int x, y, w, h;  // h is 0 for a frame end without pixels
+};
+
+// Dirty rectangles of one frame
+struct DirtyRects {
+    int count;
+    struct {
+        int x, y, w, h;
+    } rects[SLINT_MAX_DIRTY_RECTS];
+};
+
+// -------------------------------------------------------------
+// WINDOW ADAPTER
+// -------------------------------------------------------------
+
+class EspWindowAdapter : public slint::platform::WindowAdapter {
+public:
+    EspWindowAdapter(int width,
+                     int height,
+                     SoftwareRenderer::RepaintBufferType buffer_type,
+                     bool offscreen)
+        : renderer_(buffer_type),
+          size_({(uint32_t)width, (uint32_t)height}),
+          needs_redraw(true),
+          offscreen(offscreen)
+    {
+    }
+
+    slint::platform::AbstractRenderer &renderer() override
+    {
+        return renderer_;
+    }
+
+    slint::PhysicalSize size() override
+    {
+        return size_;
+    }
+
+    void request_redraw() override
+    {
+        needs_redraw = true;
+        if (!offscreen) {
+            slint_platform_wake();
+        }
+    }
+
+    SoftwareRenderer renderer_;
+    slint::PhysicalSize size_;
+    bool needs_redraw;
+    bool offscreen;  // Layer rendered on demand, never shown on the panel
+};
+
+// -------------------------------------------------------------
+// PLATFORM
+// -------------------------------------------------------------
+
+class EspSlintPlatform : public slint::platform::Platform {
+public:
+    EspSlintPlatform(int width, int height);
+
+    esp_err_t init();
+    std::unique_ptr<slint::platform::WindowAdapter> create_window_adapter() override;
+    std::chrono::milliseconds duration_since_start() override;
+    void run_event_loop() override;
+    void quit_event_loop() override;
+    void run_in_event_loop(Task task) override;
+
+    void dispatchTouch(bool touched, uint16_t x, uint16_t y);
+    void setRenderTask(TaskHandle_t task);
+    void wake();
+    void wakeFromIsr();
+    TickType_t idleTimeout() const;
+    bool render();
+    void benchmark(int frames);
+    uint32_t benchmarkChanges(int frames, const std::function<void(int)> &change);
+    slint::Image renderOffscreen();
+    void setBeforeRender(std::function<void()> hook);
+    void setOverlay(const void *pixels, const uint16_t *palette, int x, int y, int w, int h);
+    void overlayChanged();
+    void getStats(slint_render_stats_t *out) const;
+
+private:
+    // Band being accumulated in line mode
+    struct Band {
+        int buffer;
+        int x, y, w;
+        int lines;
+    };
+
+    // Native surface drawn over the Slint frame
+    struct Overlay {
+        const void *pixels;
+        const uint16_t *palette;  // RGB565 of each index, or NULL if pixels are RGB565
+        int x, y, w, h;
+        int pending;  // Frames that still have to send the latest contents
+    };
+
+    // Flush worker, one pinned to each core. Slint's software renderer draws a window
+    // from one thread only, so rasterization stays on the render task; the workers
+    // byte-swap and send bands, one preparing while the other is on the bus.
+    struct Worker {
+        EspSlintPlatform *platform;
+        TaskHandle_t task;
+        uint16_t *bounce_buffer;  // Framebuffer mode; internal DMA-capable memory
+    };
+
+    static void workerEntry(void *arg);
+    esp_err_t allocBuffers();
+    uint32_t renderRegion();
+    void copyOverlay(uint16_t *dst, int stride, int x, int y, int w, int h) const;
+    void copyOverlayRow(uint16_t *dst, int row, int col, int count) const;
+    void queueBand(int buffer, bool frame_end, int x, int y, int w, int h);
+    void processBand(Worker &worker, const FlushJob &job);
+    void waitTurn(uint32_t seq);
+    void passTurn();
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+    void submitBand(Band &band, bool frame_end);
+    void streamOverlay(Band &band);
+#else
+    static void addDirtyRect(DirtyRects &dirty, int x, int y, int w, int h);
+#endif
+    void finishFrame();
+    void waitFlushIdle();
+    void runPendingTasks();
+
+    int width;
+    int height;
+    EspWindowAdapter *window;            // Owned by Slint
+    EspWindowAdapter *offscreen_window;  // Most recently created offscreen layer
+    std::function<void()> before_render;
+    Overlay overlay;
+
+    // Image of the offscreen layers, allocated by the first one and reused
+    slint::SharedPixelBuffer<slint::Rgb8Pixel> offscreen_pixels;
+
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+    Rgb565Pixel *line_buffers[DISPLAY_LINE_BUFFER_COUNT];  // Internal DMA-capable memory
+    SemaphoreHandle_t line_free;  // Counts line buffers not queued for transfer
+    int next_line_buffer;
+#else
+    Rgb565Pixel *framebuffers[2];  // PSRAM, swapped every frame
+    SemaphoreHandle_t buffer_free[2];
+    int back_buffer;
+#endif
+    Worker workers[SLINT_FLUSH_WORKERS];
+    QueueHandle_t flush_queue;       // Bands for the workers, in seq order
+    uint32_t submit_seq;             // Sequence number of the next band, render task only
+    std::atomic<uint32_t> send_seq;  // Sequence number of the band allowed on the bus
+    SemaphoreHandle_t frame_done;  // Given after the last job of a frame is flushed
+    std::atomic<int> frames_in_flight;
+    TaskHandle_t render_task;  // Notified on redraw requests and flush completion
+
+    std::deque<Task> pending_tasks;
+    SemaphoreHandle_t task_lock;
+    bool quit_requested;
+
+    bool touch_down;
+    slint::LogicalPosition last_touch;
+
+    // Statistics
+    slint_render_stats_t stats;
+    int64_t flush_start_us;
+    uint32_t frame_bytes;
+    uint64_t window_frame_us;
+    uint32_t window_frames;
+    uint32_t window_flushed;
+    int64_t window_start_us;
+};
+
+static EspSlintPlatform *esp_platform = nullptr;
+static std::atomic<uint32_t> layer_generation(0);
+
+EspSlintPlatform::EspSlintPlatform(int width, int height)
+    : width(width),
+      height(height),
+      window(nullptr),
+      offscreen_window(nullptr),
+      overlay({nullptr, nullptr, 0, 0, 0, 0, 0}),
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+      line_buffers{},
+      line_free(nullptr),
+      next_line_buffer(0),
+#else
+      framebuffers{nullptr, nullptr},
+      buffer_free{nullptr, nullptr},
+      back_buffer(0),
+#endif
+      workers{},
+      flush_queue(nullptr),
+      submit_seq(0),
+      send_seq(0),
+      frame_done(nullptr),
+      frames_in_flight(0),
+      render_task(nullptr),
+      task_lock(nullptr),
+      quit_requested(false),
+      touch_down(false),
+      last_touch({0, 0}),
+      flush_start_us(0),
+      frame_bytes(0),
+      window_frame_us(0),
+      window_frames(0),
+      window_flushed(0),
+      window_start_us(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+esp_err_t EspSlintPlatform::allocBuffers()
+{
+    size_t line_bytes = (size_t)width * DISPLAY_LINE_BUFFER_LINES * sizeof(Rgb565Pixel);
+
+    // 16-byte aligned so the in-place byte swap can use vector loads and stores
+    uint32_t caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+    for (int i = 0; i < DISPLAY_LINE_BUFFER_COUNT; i++) {
+        line_buffers[i] = (Rgb565Pixel *)heap_caps_aligned_alloc(16, line_bytes, caps);
+        if (!line_buffers[i]) {
+            ESP_LOGE(TAG, "Failed to allocate line buffer %d (%u bytes)", i, (unsigned)line_bytes);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    line_free = xSemaphoreCreateCounting(DISPLAY_LINE_BUFFER_COUNT, DISPLAY_LINE_BUFFER_COUNT);
+    if (!line_free) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    stats.buffer_bytes = line_bytes * DISPLAY_LINE_BUFFER_COUNT;
+    ESP_LOGI(TAG,
+             "Line mode: %d x %u byte buffers in internal SRAM",
+             DISPLAY_LINE_BUFFER_COUNT,
+             (unsigned)line_bytes);
+    return ESP_OK;
+}
+#else
+esp_err_t EspSlintPlatform::allocBuffers()
+{
+    size_t fb_bytes = (size_t)width * height * sizeof(Rgb565Pixel);
+
+    for (int i = 0; i < 2; i++) {
+        framebuffers[i] = (Rgb565Pixel *)heap_caps_malloc(fb_bytes, MALLOC_CAP_SPIRAM);
+        buffer_free[i]  = xSemaphoreCreateBinary();
+        if (!framebuffers[i] || !buffer_free[i]) {
+            ESP_LOGE(TAG, "Failed to allocate framebuffer %d (%u bytes)", i, (unsigned)fb_bytes);
+            return ESP_ERR_NO_MEM;
+        }
+        memset(framebuffers[i], 0, fb_bytes);
+        xSemaphoreGive(buffer_free[i]);
+    }
+
+    // Each worker gathers its band into its own bounce buffer
+    size_t bounce_bytes = width * FLUSH_BAND_LINES * sizeof(uint16_t);
+    for (int i = 0; i < SLINT_FLUSH_WORKERS; i++) {
+        workers[i].bounce_buffer = (uint16_t *)heap_caps_aligned_alloc(
+            16, bounce_bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!workers[i].bounce_buffer) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    stats.buffer_bytes = 2 * fb_bytes + SLINT_FLUSH_WORKERS * bounce_bytes;
+    ESP_LOGI(TAG, "Framebuffer mode: 2 x %u byte framebuffers in PSRAM", (unsigned)fb_bytes);
+    return ESP_OK;
+}
+#endif
+
+esp_err_t EspSlintPlatform::init()
+{
+    esp_err_t ret = allocBuffers();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    flush_queue = xQueueCreate(FLUSH_QUEUE_DEPTH, sizeof(FlushJob));
+    frame_done  = xSemaphoreCreateBinary();
+    task_lock   = xSemaphoreCreateMutex();
+    if (!flush_queue || !frame_done || !task_lock) {
+        ESP_LOGE(TAG, "Failed to allocate flush resources");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // One flush worker per core, both below the render task. The worker sharing the render
+    // core runs while the render task waits, so whichever core is idle takes the next band.
+    for (int i = 0; i < SLINT_FLUSH_WORKERS; i++) {
+        workers[i].platform = this;
+        if (xTaskCreatePinnedToCore(workerEntry,
+                                    "slint_flush",
+                                    SLINT_FLUSH_TASK_STACK,
+                                    &workers[i],
+                                    SLINT_FLUSH_TASK_PRIORITY,
+                                    &workers[i].task,
+                                    i % portNUM_PROCESSORS) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create flush worker %d", i);
+            return ESP_FAIL;
+        }
+    }
+
+    window_start_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+std::unique_ptr<slint::platform::WindowAdapter> EspSlintPlatform::create_window_adapter()
+{
+    // The first window is the panel; later ones are offscreen layers for the layer cache
+    if (window) {
+        auto buffer_type = SoftwareRenderer::RepaintBufferType::NewBuffer;
+        auto adapter     = std::make_unique<EspWindowAdapter>(width, height, buffer_type, true);
+        offscreen_window = adapter.get();
+        return adapter;
+    }
+
+    auto adapter = std::make_unique<EspWindowAdapter>(width, height, REPAINT_BUFFER_TYPE, false);
+    window       = adapter.get();
+    return adapter;
+}
+
+slint::Image EspSlintPlatform::renderOffscreen()
+{
+    if (!offscreen_window) {
+        return slint::Image();
+    }
+
+    int64_t start_us = esp_timer_get_time();
+
+    // One buffer for every layer, allocated by the first one; large Slint allocations land
+    // in PSRAM. The caller drops the previous image first, so the buffer has no other
+    // reference and writing to it does not copy it.
+    if (offscreen_pixels.width() != (uint32_t)width) {
+        offscreen_pixels = slint::SharedPixelBuffer<slint::Rgb8Pixel>(width, height);
+    }
+    const slint::Rgb8Pixel *shared = std::as_const(offscreen_pixels).begin();
+    slint::Rgb8Pixel *pixels       = offscreen_pixels.begin();
+    if (pixels != shared) {
+        ESP_LOGW(TAG, "Previous offscreen layer still referenced, buffer copied");
+    }
+
+    offscreen_window->renderer_.render(std::span<slint::Rgb8Pixel>(pixels, offscreen_pixels.end()),
+                                       width);
+    offscreen_window = nullptr;
+
+    ESP_LOGI(TAG,
+             "Rendered offscreen layer in %u us (%u bytes)",
+             (unsigned)(esp_timer_get_time() - start_us),
+             (unsigned)(width * height * sizeof(slint::Rgb8Pixel)));
+    return slint::Image(offscreen_pixels);
+}
+
+void EspSlintPlatform::setBeforeRender(std::function<void()> hook)
+{
+    before_render = std::move(hook);
+}
+
+void EspSlintPlatform::setOverlay(const void *pixels,
+                                  const uint16_t *palette,
+                                  int x,
+                                  int y,
+                                  int w,
+                                  int h)
+{
+    overlay = {pixels, palette, x, y, w, h, 0};
+    overlayChanged();
+}
+
+void EspSlintPlatform::overlayChanged()
+{
+    if (!overlay.pixels || !window) {
+        return;
+    }
+
+    overlay.pending      = OVERLAY_COPIES;
+    window->needs_redraw = true;
+    wake();
+}
+
+// Copy the part of the overlay inside a screen rectangle; dst points at the rectangle's
+// top-left pixel
+void EspSlintPlatform::copyOverlay(uint16_t *dst, int stride, int x, int y, int w, int h) const
+{
+    int x0 = (x > overlay.x) ? x : overlay.x;
+    int y0 = (y > overlay.y) ? y : overlay.y;
+    int x1 = (x + w < overlay.x + overlay.w) ? x + w : overlay.x + overlay.w;
+    int y1 = (y + h < overlay.y + overlay.h) ? y + h : overlay.y + overlay.h;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    for (int row = y0; row < y1; row++) {
+        copyOverlayRow(
+            dst + (size_t)(row - y) * stride + (x0 - x), row - overlay.y, x0 - overlay.x, x1 - x0);
+    }
+}
+
+// Copy pixels of one overlay row, expanding palette indices while copying
+void EspSlintPlatform::copyOverlayRow(uint16_t *dst, int row, int col, int count) const
+{
+    size_t offset = (size_t)row * overlay.w + col;
+    if (overlay.palette) {
+        const uint8_t *src = (const uint8_t *)overlay.pixels + offset;
+        pixel_index8_to_rgb565(dst, src, overlay.palette, count);
+    }
+    else {
+        memcpy(dst, (const uint16_t *)overlay.pixels + offset, count * sizeof(uint16_t));
+    }
+}
+
+std::chrono::milliseconds EspSlintPlatform::duration_since_start()
+{
+    return std::chrono::milliseconds(esp_timer_get_time() / 1000);
+}
+
+void EspSlintPlatform::run_event_loop()
+{
+    // The firmware normally drives rendering from slint_task; this keeps Slint's own
+    // event loop API usable for tools and tests
+    while (!quit_requested) {
+        render();
+        vTaskDelay(1);
+    }
+    quit_requested = false;
+}
+
+void EspSlintPlatform::quit_event_loop()
+{
+    quit_requested = true;
+}
+
+void EspSlintPlatform::run_in_event_loop(Task task)
+{
+    xSemaphoreTake(task_lock, portMAX_DELAY);
+    pending_tasks.push_back(std::move(task));
+    xSemaphoreGive(task_lock);
+    wake();
+}
+
+void EspSlintPlatform::runPendingTasks()
+{
+    while (true) {
+        xSemaphoreTake(task_lock, portMAX_DELAY);
+        if (pending_tasks.empty()) {
+            xSemaphoreGive(task_lock);
+            return;
+        }
+        Task task = std::move(pending_tasks.front());
+        pending_tasks.pop_front();
+        xSemaphoreGive(task_lock);
+
+        std::move(task).run();
+    }
+}
+
+void EspSlintPlatform::dispatchTouch(bool touched, uint16_t x, uint16_t y)
+{
+    if (!window) {
+        return;
+    }
+
+    if (touched) {
+        slint::LogicalPosition pos({(float)x, (float)y});
+        if (!touch_down) {
+            window->window().dispatch_pointer_press_event(pos, slint::PointerEventButton::Left);
+        }
+        else if (pos.x != last_touch.x || pos.y != last_touch.y) {
+            window->window().dispatch_pointer_move_event(pos);
+        }
+        last_touch = pos;
+        touch_down = true;
+    }
+    else if (touch_down) {
+        window->window().dispatch_pointer_release_event(last_touch,
+                                                        slint::PointerEventButton::Left);
+        window->window().dispatch_pointer_exit_event();
+        touch_down = false;
+    }
+}
+
+void EspSlintPlatform::setRenderTask(TaskHandle_t task)
+{
+    render_task = task;
+}
+
+void EspSlintPlatform::wake()
+{
+    if (render_task) {
+        xTaskNotifyGive(render_task);
+    }
+}
+
+void EspSlintPlatform::wakeFromIsr()
+{
+    BaseType_t higher_prio_woken = pdFALSE;
+    if (render_task) {
+        vTaskNotifyGiveFromISR(render_task, &higher_prio_woken);
+    }
+    portYIELD_FROM_ISR(higher_prio_woken);
+}
+
+TickType_t EspSlintPlatform::idleTimeout() const
+{
+    if (window && window->needs_redraw && frames_in_flight < MAX_FRAMES_IN_FLIGHT) {
+        return 0;
+    }
+
+    // Otherwise sleep until the next Slint timer or animation step; a pending redraw
+    // blocked on the panel is resumed by the flush task's notification
+    auto next = slint::platform::duration_until_next_timer_update();
+    if (!next) {
+        return portMAX_DELAY;
+    }
+
+    // Round up so a deadline shorter than a tick does not turn into a busy loop
+    TickType_t ticks = (TickType_t)((next->count() + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+    return ticks > 0 ? ticks : 1;
+}
+
+bool EspSlintPlatform::render()
+{
+    runPendingTasks();
+    if (before_render) {
+        before_render();
+    }
+    slint::platform::update_timers_and_animations();
+
+    if (!window || !window->needs_redraw) {
+        return false;
+    }
+
+    // Pace to the panel: keep the request pending until a frame has been flushed
+    if (frames_in_flight >= MAX_FRAMES_IN_FLIGHT) {
+        stats.paced++;
+        return false;
+    }
+
+    window->needs_redraw = false;
+    frames_in_flight++;
+    uint32_t frame_us = renderRegion();
+
+    stats.frames++;
+    stats.last_frame_us = frame_us;
+    if (frame_us > stats.max_frame_us) {
+        stats.max_frame_us = frame_us;
+    }
+    window_frame_us += frame_us;
+    window_frames++;
+
+    return true;
+}
+
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+uint32_t EspSlintPlatform::renderRegion()
+{
+    int64_t start_us = esp_timer_get_time();
+    Band band        = {0, 0, 0, 0, 0};
+
+    // Slint hands us the dirty span of each line in order. Consecutive lines with the same
+    // span are packed into one band so each panel transfer covers several lines.
+    window->renderer_.render_by_line(
+        [this, &band](std::size_t line, std::size_t start, std::size_t end, auto render_fn) {
+            int w = (int)(end - start);
+            if (band.lines > 0 &&
+                ((int)line != band.y + band.lines || (int)start != band.x || w != band.w ||
+                 band.lines == DISPLAY_LINE_BUFFER_LINES)) {
+                submitBand(band, false);
+            }
+
+            if (band.lines == 0) {
+                // Wait for a line buffer whose previous transfer has completed
+                xSemaphoreTake(line_free, portMAX_DELAY);
+                band.buffer      = next_line_buffer;
+                next_line_buffer = (next_line_buffer + 1) % DISPLAY_LINE_BUFFER_COUNT;
+                band.x           = (int)start;
+                band.y           = (int)line;
+                band.w           = w;
+            }
+
+            Rgb565Pixel *dst = line_buffers[band.buffer] + band.lines * w;
+            render_fn(std::span<Rgb565Pixel>(dst, w));
+            if (overlay.pixels) {
+                copyOverlay((uint16_t *)dst, w, (int)start, (int)line, w, 1);
+            }
+            band.lines++;
+        });
+
+    // A changed overlay is sent whole, after whatever Slint redrew
+    if (overlay.pixels && overlay.pending > 0) {
+        if (band.lines > 0) {
+            submitBand(band, false);
+        }
+        streamOverlay(band);
+        overlay.pending--;
+    }
+
+    submitBand(band, true);
+    return (uint32_t)(esp_timer_get_time() - start_us);
+}
+
+// Send the overlay through the line buffers; the last band is left in band for the caller
+// to submit as the end of the frame
+void EspSlintPlatform::streamOverlay(Band &band)
+{
+    for (int row = 0; row < overlay.h; row += DISPLAY_LINE_BUFFER_LINES) {
+        if (band.lines > 0) {
+            submitBand(band, false);
+        }
+
+        int lines = overlay.h - row;
+        if (lines > DISPLAY_LINE_BUFFER_LINES) {
+            lines = DISPLAY_LINE_BUFFER_LINES;
+        }
+
+        xSemaphoreTake(line_free, portMAX_DELAY);
+        band.buffer      = next_line_buffer;
+        next_line_buffer = (next_line_buffer + 1) % DISPLAY_LINE_BUFFER_COUNT;
+        band.x           = overlay.x;
+        band.y           = overlay.y + row;
+        band.w           = overlay.w;
+        band.lines       = lines;
+
+        // Rows are contiguous in both, so the band is one run; the worker swaps the bytes
+        copyOverlayRow((uint16_t *)line_buffers[band.buffer], row, 0, overlay.w * lines);
+    }
+}
+
+void EspSlintPlatform::submitBand(Band &band, bool frame_end)
+{
+    queueBand(band.buffer, frame_end, band.x, band.y, band.w, band.lines);
+    band.lines = 0;
+}
+#else
+uint32_t EspSlintPlatform::renderRegion()
+{
+    // Wait until the flush task is done with the buffer we are about to draw into
+    xSemaphoreTake(buffer_free[back_buffer], portMAX_DELAY);
+
+    int64_t start_us = esp_timer_get_time();
+
+    std::span<Rgb565Pixel> buffer(framebuffers[back_buffer], (size_t)width * height);
+    auto region = window->renderer_.render(buffer, width);
+
+    DirtyRects dirty;
+    dirty.count = 0;
+    for (auto &rect : region.rectangles()) {
+        addDirtyRect(dirty, rect.origin.x, rect.origin.y, rect.size.width, rect.size.height);
+    }
+
+    // Put the overlay back over whatever Slint drew beneath it, and send it whole if changed
+    if (overlay.pixels) {
+        uint16_t *fb = (uint16_t *)framebuffers[back_buffer];
+        for (int r = 0; r < dirty.count; r++) {
+            const auto &rect = dirty.rects[r];
+            copyOverlay(fb + (size_t)rect.y * width + rect.x,
+                        width,
+                        rect.x,
+                        rect.y,
+                        rect.w,
+                        rect.h);
+        }
+        if (overlay.pending > 0) {
+            copyOverlay(fb + (size_t)overlay.y * width + overlay.x,
+                        width,
+                        overlay.x,
+                        overlay.y,
+                        overlay.w,
+                        overlay.h);
+            addDirtyRect(dirty, overlay.x, overlay.y, overlay.w, overlay.h);
+            overlay.pending--;
+        }
+    }
+
+    uint32_t frame_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    // Split the dirty area into bands for the workers; the last one ends the frame
+    for (int r = 0; r < dirty.count; r++) {
+        const auto &rect = dirty.rects[r];
+        for (int row = 0; row < rect.h; row += FLUSH_BAND_LINES) {
+            int lines = (rect.h - row < FLUSH_BAND_LINES) ? rect.h - row : FLUSH_BAND_LINES;
+            bool last = r == dirty.count - 1 && row + lines == rect.h;
+            queueBand(back_buffer, last, rect.x, rect.y + row, rect.w, lines);
+        }
+    }
+    if (dirty.count == 0) {
+        queueBand(back_buffer, true, 0, 0, 0, 0);
+    }
+    back_buffer ^= 1;
+
+    return frame_us;
+}
+
+// Add a dirty rectangle, merging the tail into one box if there are too many
+void EspSlintPlatform::addDirtyRect(DirtyRects &dirty, int x, int y, int w, int h)
+{
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    if (dirty.count < SLINT_MAX_DIRTY_RECTS) {
+        dirty.rects[dirty.count++] = {x, y, w, h};
+        return;
+    }
+
+    auto &last = dirty.rects[SLINT_MAX_DIRTY_RECTS - 1];
+    int x1     = (x + w > last.x + last.w) ? x + w : last.x + last.w;
+    int y1     = (y + h > last.y + last.h) ? y + h : last.y + last.h;
+    last.x     = (x < last.x) ? x : last.x;
+    last.y     = (y < last.y) ? y : last.y;
+    last.w     = x1 - last.x;
+    last.h     = y1 - last.y;
+}
+#endif
+
+void EspSlintPlatform::queueBand(int buffer, bool frame_end, int x, int y, int w, int h)
+{
+    FlushJob job = {buffer, submit_seq++, frame_end, x, y, w, h};
+    xQueueSend(flush_queue, &job, portMAX_DELAY);
+}
+
+void EspSlintPlatform::workerEntry(void *arg)
+{
+    Worker *worker         = static_cast<Worker *>(arg);
+    EspSlintPlatform *self = worker->platform;
+    FlushJob job;
+
+    while (1) {
+        if (xQueueReceive(self->flush_queue, &job, portMAX_DELAY) == pdTRUE) {
+            self->processBand(*worker, job);
+        }
+    }
+}
+
+void EspSlintPlatform::processBand(Worker &worker, const FlushJob &job)
+{
+    // Convert to the panel's big-endian order while the other worker may still be sending
+    // the previous band
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+    uint16_t *pixels = (uint16_t *)line_buffers[job.buffer];
+    pixel_copy_swap_rgb565(pixels, pixels, (size_t)job.w * job.h);
+#else
+    uint16_t *pixels   = worker.bounce_buffer;
+    const uint16_t *fb = (const uint16_t *)framebuffers[job.buffer];
+    for (int line = 0; line < job.h; line++) {
+        pixel_copy_swap_rgb565(pixels + line * job.w,
+                               fb + (size_t)(job.y + line) * width + job.x,
+                               job.w);
+    }
+#endif
+
+    waitTurn(job.seq);
+
+    if (job.h > 0) {
+        if (frame_bytes == 0 && flush_start_us == 0) {
+            flush_start_us = esp_timer_get_time();
+        }
+        display_flush(job.x, job.y, job.w, job.h, pixels);
+        frame_bytes += job.w * job.h * sizeof(uint16_t);
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES
+        xSemaphoreGive(line_free);
+#endif
+    }
+
+    if (job.frame_end) {
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_FRAMEBUFFER
+        xSemaphoreGive(buffer_free[job.buffer]);
+#endif
+        finishFrame();
+    }
+
+    passTurn();
+}
+
+// Bands must reach the panel in queue order, or a band of an older frame could overwrite
+// a newer one. The queue hands out bands in order, so the band whose turn it is always
+// belongs to a worker that is not waiting.
+void EspSlintPlatform::waitTurn(uint32_t seq)
+{
+    while (send_seq.load() != seq) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void EspSlintPlatform::passTurn()
+{
+    send_seq++;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < SLINT_FLUSH_WORKERS; i++) {
+        if (workers[i].task != self) {
+            xTaskNotifyGive(workers[i].task);
+        }
+    }
+}
+
+void EspSlintPlatform::finishFrame()
+{
+    int64_t now_us = esp_timer_get_time();
+
+    stats.last_flush_us      = (uint32_t)(now_us - flush_start_us);
+    stats.last_bytes_flushed = frame_bytes;
+    flush_start_us           = 0;
+    stats.pixels_flushed += frame_bytes / sizeof(uint16_t);
+    frame_bytes = 0;
+    window_flushed++;
+    if (frames_in_flight > 0) {
+        frames_in_flight--;
+    }
+    xSemaphoreGive(frame_done);
+    wake();
+
+    // Time from reset to the first complete frame on the panel
+    static bool first_frame_logged = false;
+    if (!first_frame_logged) {
+        first_frame_logged = true;
+        ESP_LOGI(TAG, "First frame on panel %lld ms after boot", now_us / 1000);
+    }
+
+    // Periodic statistics report
+    if (now_us - window_start_us >= SLINT_STATS_INTERVAL_MS * 1000LL) {
+        stats.fps          = window_flushed * 1e6f / (float)(now_us - window_start_us);
+        stats.avg_frame_us = window_frames ? (uint32_t)(window_frame_us / window_frames) : 0;
+
+        ESP_LOGI(TAG,
+                 "%.1f fps, render avg %u us max %u us, last flush %u bytes in %u us",
+                 stats.fps,
+                 stats.avg_frame_us,
+                 stats.max_frame_us,
+                 stats.last_bytes_flushed,
+                 stats.last_flush_us);
+
+        stats.max_frame_us = 0;
+        window_frame_us    = 0;
+        window_frames      = 0;
+        window_flushed     = 0;
+        window_start_us    = now_us;
+    }
+}
+
+void EspSlintPlatform::waitFlushIdle()
+{
+    xSemaphoreTake(frame_done, portMAX_DELAY);
+}
+
+void EspSlintPlatform::benchmark(int frames)
+{
+    if (!window || frames <= 0) {
+        return;
+    }
+
+    const char *mode = DISPLAY_RENDER_MODE == DISPLAY_RENDER_LINES ? "line" : "framebuffer";
+    ESP_LOGI(TAG, "Benchmarking %s mode over %d full-screen frames", mode, frames);
+
+    uint64_t render_us     = 0;
+    uint64_t total_us      = 0;
+    uint32_t worst_render  = 0;
+    uint32_t worst_latency = 0;
+
+    xSemaphoreTake(frame_done, 0);
+    for (int i = 0; i < frames; i++) {
+        // A size change marks the whole window dirty, forcing a full-screen render
+        float h = (float)(height - (i & 1));
+        window->window().dispatch_resize_event(slint::LogicalSize({(float)width, h}));
+
+        int64_t start_us         = esp_timer_get_time();
+        window->needs_redraw     = false;
+        uint32_t frame_render_us = renderRegion();
+        waitFlushIdle();
+
+        // Latency: from the start of rasterization until the last band is on the panel
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - start_us);
+        render_us += frame_render_us;
+        total_us += latency_us;
+        if (frame_render_us > worst_render) {
+            worst_render = frame_render_us;
+        }
+        if (latency_us > worst_latency) {
+            worst_latency = latency_us;
+        }
+    }
+    window->window().dispatch_resize_event(slint::LogicalSize({(float)width, (float)height}));
+    window->needs_redraw = true;
+
+    ESP_LOGI(TAG,
+             "%s mode: frame latency avg %u us max %u us (render avg %u us max %u us, "
+             "flush after render avg %u us)",
+             mode,
+             (unsigned)(total_us / frames),
+             (unsigned)worst_latency,
+             (unsigned)(render_us / frames),
+             (unsigned)worst_render,
+             (unsigned)((total_us - render_us) / frames));
+    ESP_LOGI(TAG,
+             "%s mode: render buffers %u bytes, free internal %u bytes, free PSRAM %u bytes",
+             mode,
+             (unsigned)stats.buffer_bytes,
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+}
+
+uint32_t EspSlintPlatform::benchmarkChanges(int frames, const std::function<void(int)> &change)
+{
+    if (!window || frames <= 0) {
+        return 0;
+    }
+
+    uint64_t total_us = 0;
+    xSemaphoreTake(frame_done, 0);
+    for (int i = 0; i < frames; i++) {
+        // Only what the change dirtied is rendered and flushed
+        change(i);
+        int64_t start_us     = esp_timer_get_time();
+        window->needs_redraw = false;
+        renderRegion();
+        waitFlushIdle();
+        total_us += esp_timer_get_time() - start_us;
+    }
+    window->needs_redraw = true;
+
+    return (uint32_t)(total_us / frames);
+}
+
+void EspSlintPlatform::getStats(slint_render_stats_t *out) const
+{
+    if (out) {
+        *out = stats;
+    }
+}
+
+// -------------------------------------------------------------
+// C INTERFACE
+// -------------------------------------------------------------
+
+extern "C" {
+
+esp_err_t slint_platform_init(int width, int height)
+{
+    ESP_LOGI(TAG, "Installing Slint platform %dx%d", width, height);
+
+    auto platform = std::make_unique<EspSlintPlatform>(width, height);
+    esp_err_t ret = platform->init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    esp_platform = platform.get();
+    slint::platform::set_platform(std::move(platform));
+    return ESP_OK;
+}
+
+void slint_platform_dispatch_touch(bool touched, uint16_t x, uint16_t y)
+{
+    if (esp_platform) {
+        esp_platform->dispatchTouch(touched, x, y);
+    }
+}
+
+void slint_platform_set_render_task(TaskHandle_t task)
+{
+    if (esp_platform) {
+        esp_platform->setRenderTask(task);
+    }
+}
+
+void slint_platform_wake(void)
+{
+    if (esp_platform) {
+        esp_platform->wake();
+    }
+}
+
+void slint_platform_wake_from_isr(void)
+{
+    if (esp_platform) {
+        esp_platform->wakeFromIsr();
+    }
+}
+
+TickType_t slint_platform_idle_timeout(void)
+{
+    return esp_platform ? esp_platform->idleTimeout() : portMAX_DELAY;
+}
+
+bool slint_platform_render(void)
+{
+    return esp_platform ? esp_platform->render() : false;
+}
+
+void slint_platform_benchmark(int frames)
+{
+    if (esp_platform) {
+        esp_platform->benchmark(frames);
+    }
+}
+
+void slint_platform_set_overlay(const uint16_t *pixels, int x, int y, int w, int h)
+{
+    if (esp_platform) {
+        esp_platform->setOverlay(pixels, nullptr, x, y, w, h);
+    }
+}
+
+void slint_platform_set_overlay_index8(const uint8_t *pixels,
+                                       const uint16_t *palette,
+                                       int x,
+                                       int y,
+                                       int w,
+                                       int h)
+{
+    if (esp_platform) {
+        esp_platform->setOverlay(pixels, pixels ? palette : nullptr, x, y, w, h);
+    }
+}
+
+void slint_platform_overlay_changed(void)
+{
+    if (esp_platform) {
+        esp_platform->overlayChanged();
+    }
+}
+
+void slint_platform_get_stats(slint_render_stats_t *out)
+{
+    if (esp_platform) {
+        esp_platform->getStats(out);
+    }
+}
+
+void slint_platform_invalidate_layers(void)
+{
+    layer_generation++;
+    slint_platform_wake();
+}
+
+uint32_t slint_platform_layer_generation(void)
+{
+    return layer_generation;
+}
+
+}  // extern "C"
+
+slint::Image slint_platform_render_offscreen()
+{
+    return esp_platform ? esp_platform->renderOffscreen() : slint::Image();
+}
+
+uint32_t slint_platform_benchmark_changes(int frames, const std::function<void(int)> &change)
+{
+    return esp_platform ? esp_platform->benchmarkChanges(frames, change) : 0;
+}
+
+void slint_platform_set_before_render(std::function<void()> hook)
+{
+    if (esp_platform) {
+        esp_platform->setBeforeRender(std::move(hook));
+    }
+}
@@ -0,0 +1,223 @@
+#include "display/touch_driver.h"
+
+#include <cstring>
+
+#include "display/slint_platform.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "hardware/gpio_claims.h"
+#include "tft_config.h"
+
+static const char *TAG = "touch";
+
+// Global instance
+TouchDriver touch_driver;
+
+// TouchDriver implementation
+TouchDriver::TouchDriver()
+    : port(I2C_NUM_0), irq_pin(-1), task_handle(nullptr), irq_time_us(0), initialized(false)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+esp_err_t TouchDriver::init(i2c_port_t port, int sda_pin, int scl_pin, int irq_pin)
+{
+    ESP_LOGI(TAG,
+             "Initializing touch controller (I2C%d SDA %d SCL %d, IRQ %d)",
+             port,
+             sda_pin,
+             scl_pin,
+             irq_pin);
+
+    const int pins[] = {sda_pin, scl_pin, irq_pin};
+    esp_err_t ret    = gpio_claims.claimAll(pins, sizeof(pins) / sizeof(pins[0]), "touch");
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    this->port    = port;
+    this->irq_pin = irq_pin;
+
+    i2c_config_t i2c_config     = {};
+    i2c_config.mode             = I2C_MODE_MASTER;
+    i2c_config.sda_io_num       = sda_pin;
+    i2c_config.scl_io_num       = scl_pin;
+    i2c_config.sda_pullup_en    = GPIO_PULLUP_ENABLE;
+    i2c_config.scl_pullup_en    = GPIO_PULLUP_ENABLE;
+    i2c_config.master.clk_speed = TOUCH_I2C_FREQUENCY;
+
+    ret = i2c_param_config(port, &i2c_config);
+    if (ret == ESP_OK) {
+        ret = i2c_driver_install(port, I2C_MODE_MASTER, 0, 0, 0);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install I2C driver: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    uint8_t vendor = 0;
+    ret = readRegisters(FT6236_REG_VENDOR_ID, &vendor, 1);
+    if (ret != ESP_OK || vendor != FT6236_VENDOR_ID) {
+        ESP_LOGE(TAG, "No FT6236 at 0x%02x (vendor 0x%02x)", TOUCH_I2C_ADDRESS, vendor);
+        i2c_driver_delete(port);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Hold INT low for as long as the panel is touched, one edge per contact
+    const uint8_t g_mode[] = {FT6236_REG_G_MODE, 0x00};
+    ret = i2c_master_write_to_device(
+        port, TOUCH_I2C_ADDRESS, g_mode, sizeof(g_mode), pdMS_TO_TICKS(TOUCH_I2C_TIMEOUT_MS));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set interrupt mode: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (xTaskCreate(taskEntry,
+                    "touch",
+                    TOUCH_TASK_STACK,
+                    this,
+                    TOUCH_TASK_PRIORITY,
+                    &task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create touch task");
+        return ESP_FAIL;
+    }
+
+    // INT is open drain, active low while the panel is touched
+    gpio_config_t irq_config = {
+        .pin_bit_mask = 1ULL << irq_pin,
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = GPIO_PULLUP_ENABLE,
+        .intr_type    = GPIO_INTR_NEGEDGE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&irq_config));
+
+    // The service may already be installed by the hardware module
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Failed to install GPIO ISR service: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    gpio_isr_handler_add((gpio_num_t)irq_pin, irqHandler, this);
+
+    initialized = true;
+    return ESP_OK;
+}
+
+void IRAM_ATTR TouchDriver::irqHandler(void *arg)
+{
+    TouchDriver *self = static_cast<TouchDriver *>(arg);
+
+    // The task polls until release, so keep the interrupt off until then
+    gpio_intr_disable((gpio_num_t)self->irq_pin);
+    self->irq_time_us = esp_timer_get_time();
+    self->stats.irq_count++;
+
+    BaseType_t higher_prio_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->task_handle, &higher_prio_woken);
+    portYIELD_FROM_ISR(higher_prio_woken);
+}
+
+void TouchDriver::taskEntry(void *arg)
+{
+    TouchDriver *self = static_cast<TouchDriver *>(arg);
+
+    while (1) {
+        // Sleep until a finger lands
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->trackContact();
+        gpio_intr_enable((gpio_num_t)self->irq_pin);
+    }
+}
+
+void TouchDriver::trackContact()
+{
+    TickType_t wake = xTaskGetTickCount();
+
+    tracker.begin(irq_time_us);
+    while (1) {
+        uint16_t x = 0, y = 0;
+        bool contact = sample(&x, &y);
+
+        touch_event_t event;
+        if (tracker.update(contact, x, y, esp_timer_get_time(), &event)) {
+            pushEvent(event);
+        }
+        if (tracker.finished()) {
+            return;
+        }
+
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(TOUCH_SAMPLE_PERIOD_MS));
+    }
+}
+
+esp_err_t TouchDriver::readRegisters(uint8_t reg, uint8_t *data, size_t len)
+{
+    return i2c_master_write_read_device(port,
+                                        TOUCH_I2C_ADDRESS,
+                                        &reg,
+                                        1,
+                                        data,
+                                        len,
+                                        pdMS_TO_TICKS(TOUCH_I2C_TIMEOUT_MS));
+}
+
+bool TouchDriver::sample(uint16_t *x, uint16_t *y)
+{
+    int64_t start_us = esp_timer_get_time();
+
+    uint8_t report[FT6236_REPORT_BYTES];
+    esp_err_t ret = readRegisters(FT6236_REG_TD_STATUS, report, sizeof(report));
+
+    uint32_t read_us = (uint32_t)(esp_timer_get_time() - start_us);
+    stats.samples++;
+    if (read_us > stats.max_read_us) {
+        stats.max_read_us = read_us;
+    }
+    if (ret != ESP_OK) {
+        // A failed read counts as no contact, so a dead bus ends in a release
+        stats.read_errors++;
+        return false;
+    }
+
+    return touch_decode_ft6236(report, x, y);
+}
+
+void TouchDriver::pushEvent(const touch_event_t &event)
+{
+    if (events.push(event)) {
+        stats.events++;
+    }
+    else {
+        stats.dropped++;
+    }
+
+    slint_platform_wake();
+}
+
+bool TouchDriver::popEvent(touch_event_t *out)
+{
+    return out != nullptr && events.pop(*out);
+}
+
+void TouchDriver::getStats(touch_stats_t *out) const
+{
+    if (out) {
+        *out = stats;
+    }
+}
+
+// C compatibility wrappers
+extern "C" {
+
+bool touch_pop_event(touch_event_t *out)
+{
+    return touch_driver.popEvent(out);
+}
+
+void touch_get_stats(touch_stats_t *out)
+{
+    touch_driver.getStats(out);
+}
+
+}  // extern "C"
@@ -0,0 +1,78 @@
+#include "display/touch_tracker.h"
+
+#include <cstdlib>
+
+#include "tft_config.h"
+
+bool touch_decode_ft6236(const uint8_t *report, uint16_t *x, uint16_t *y)
+{
+    // TD_STATUS holds 0x0F or other garbage while the controller settles
+    int touches = report[0] & 0x0F;
+    if (touches == 0 || touches > FT6236_MAX_TOUCHES) {
+        return false;
+    }
+
+    int event = report[1] >> 6;
+    if (event == FT6236_EVENT_UP || event == FT6236_EVENT_NONE) {
+        return false;
+    }
+
+    int raw_x = ((report[1] & 0x0F) << 8) | report[2];
+    int raw_y = ((report[3] & 0x0F) << 8) | report[4];
+    *x        = raw_x < TFT_WIDTH ? raw_x : TFT_WIDTH - 1;
+    *y        = raw_y < TFT_HEIGHT ? raw_y : TFT_HEIGHT - 1;
+    return true;
+}
+
+// TouchTracker implementation
+TouchTracker::TouchTracker()
+    : down(false), valid(0), invalid(0), last_x(0), last_y(0), irq_time_us(0)
+{
+}
+
+void TouchTracker::begin(int64_t irq_time_us)
+{
+    down              = false;
+    valid             = 0;
+    invalid           = 0;
+    this->irq_time_us = irq_time_us;
+}
+
+bool TouchTracker::update(bool contact, uint16_t x, uint16_t y, int64_t now_us, touch_event_t *out)
+{
+    if (!contact) {
+        valid = 0;
+        if (++invalid == TOUCH_RELEASE_SAMPLES && down) {
+            down = false;
+            *out = {TOUCH_EVENT_RELEASE, last_x, last_y, now_us};
+            return true;
+        }
+        return false;
+    }
+
+    invalid = 0;
+    if (!down) {
+        // Report the press with the IRQ time so latency includes debouncing
+        if (++valid < TOUCH_PRESS_SAMPLES) {
+            return false;
+        }
+        down   = true;
+        last_x = x;
+        last_y = y;
+        *out   = {TOUCH_EVENT_PRESS, x, y, irq_time_us};
+        return true;
+    }
+
+    if (abs(x - last_x) < TOUCH_MOVE_THRESHOLD && abs(y - last_y) < TOUCH_MOVE_THRESHOLD) {
+        return false;
+    }
+    last_x = x;
+    last_y = y;
+    *out   = {TOUCH_EVENT_MOVE, x, y, now_us};
+    return true;
+}
+
+bool TouchTracker::finished() const
+{
+    return invalid >= TOUCH_RELEASE_SAMPLES;
+}
@@ -16,6 +16,13 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "common/fixed_format.h"
+#include "display/chart_engine.h"
+#include "display/pixel_kernels.h"
+#include "display/slint_platform.h"
+#include "display/touch_driver.h"
+#include "hardware/gpio_claims.h"
+#include "spi_bus/spi_bus_manager.h"
 
 // -------------------------------------------------------------
 // DISPLAY HARDWARE LAYER
@@ -31,35 +38,32 @@ static const char *TAG = "display";
 
 /* SPI bus configuration */
 #define LCD_HOST SPI2_HOST
-#define TOUCH_HOST SPI3_HOST
+
+/* Lines per panel transfer, the bus max_transfer_sz; the display has the host to itself */
+#define DISPLAY_FLUSH_MAX_LINES 200
+#define SPI_STATS_INTERVAL_MS 10000
 
 /* Display hardware globals */
 static esp_lcd_panel_io_handle_t io_handle = NULL;
 static esp_lcd_panel_handle_t panel_handle = NULL;
 static SemaphoreHandle_t slint_mutex       = NULL;
-
-/* Touch related variables */
-static spi_device_handle_t touch_spi                         = NULL;
-static bool (*touch_event_handler)(uint16_t *x, uint16_t *y) = NULL;
+static SemaphoreHandle_t flush_done_sem    = NULL;
+static void (*frame_start_hook)(void)      = NULL;
+static int lcd_bus_id                      = SPI_BUS_INVALID_DEVICE;
+
+/* Render loop statistics for the current reporting window */
+static uint32_t ui_wakeups          = 0;
+static uint32_t ui_frames           = 0;
+static uint64_t ui_mutex_hold_us    = 0;
+static uint32_t ui_mutex_max_us     = 0;
+static uint32_t ui_touch_events     = 0;
+static uint32_t ui_touch_latency_us = 0;
 
 /* Function prototypes */
-static bool touch_get_xy(uint16_t *x, uint16_t *y);
 static void slint_task(void *pvParameter);
-
-// -------------------------------------------------------------
-// SLINT UI RENDERER LAYER
-// -------------------------------------------------------------
-
-// Define a concrete struct for the renderer to avoid incomplete type errors
-struct slint_renderer_t {
-    void *panel_handle;  // Store the panel for rendering
-    int width;
-    int height;
-    void *framebuffer;  // We would have a framebuffer in a real implementation
-};
-
-// Slint renderer implementation
-static struct slint_renderer_t *slint_renderer = NULL;
+static bool display_color_trans_done(esp_lcd_panel_io_handle_t panel_io,
+                                     esp_lcd_panel_io_event_data_t *edata,
+                                     void *user_ctx);
 
 // Global instance
 DisplayDriver display;
@@ -89,21 +93,36 @@ esp_err_t DisplayDriver::init()
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
         /* For a 5-inch 800x480 display, we need a larger transfer size */
-        .max_transfer_sz =
-            DISPLAY_WIDTH * 200 * sizeof(uint16_t),  // Increased for full-frame rendering
+        .max_transfer_sz = DISPLAY_WIDTH * DISPLAY_FLUSH_MAX_LINES * sizeof(uint16_t),
     };
 
-    ESP_ERROR_CHECK(spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO));
+    // The bus manager owns the host and reports its utilization
+    ESP_ERROR_CHECK(spi_bus_manager.initHost(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO));
+    lcd_bus_id = spi_bus_manager.registerDevice(LCD_HOST, TFT_CS, "lcd");
+    if (lcd_bus_id == SPI_BUS_INVALID_DEVICE) {
+        return ESP_FAIL;
+    }
+
+    flush_done_sem = xSemaphoreCreateBinary();
+    if (!flush_done_sem) {
+        ESP_LOGE(TAG, "Failed to create flush semaphore");
+        return ESP_FAIL;
+    }
+
+    // STEP 2: Initialize LCD panel; the bus manager has claimed the bus pins and TFT_CS
+    const int lcd_pins[] = {TFT_DC, TFT_RST, TFT_BL};
+    ESP_ERROR_CHECK(gpio_claims.claimAll(lcd_pins, sizeof(lcd_pins) / sizeof(lcd_pins[0]), "lcd"));
 
-    // STEP 2: Initialize LCD panel
     esp_lcd_panel_io_spi_config_t io_config = {
-        .dc_gpio_num       = TFT_DC,
-        .cs_gpio_num       = TFT_CS,
-        .pclk_hz           = SPI_FREQUENCY,
-        .lcd_cmd_bits      = 8,
-        .lcd_param_bits    = 8,
-        .spi_mode          = 0,
-        .trans_queue_depth = 20,  // Increased queue depth for larger display
+        .dc_gpio_num         = TFT_DC,
+        .cs_gpio_num         = TFT_CS,
+        .pclk_hz             = SPI_FREQUENCY,
+        .lcd_cmd_bits        = 8,
+        .lcd_param_bits      = 8,
+        .spi_mode            = 0,
+        .trans_queue_depth   = 20,  // Increased queue depth for larger display
+        .on_color_trans_done = display_color_trans_done,
+        .user_ctx            = NULL,
     };
 
     ESP_ERROR_CHECK(
@@ -132,24 +151,13 @@ esp_err_t DisplayDriver::init()
     ESP_ERROR_CHECK(gpio_config(&pwr_gpio_config));
     gpio_set_level(TFT_BL, 1);
 
-    // STEP 5: Initialize touch controller
-    spi_device_interface_config_t devcfg = {
-        .clock_speed_hz = TOUCH_SPI_FREQUENCY,
-        .mode           = 0,
-        .spics_io_num   = TOUCH_CS,
-        .queue_size     = 7,
-    };
-
-    spi_bus_add_device(TOUCH_HOST, &devcfg, &touch_spi);
-
-    uint8_t touch_init_cmd             = 0x38;
-    spi_transaction_t touch_init_trans = {
-        .length    = 8,
-        .tx_buffer = &touch_init_cmd,
-    };
-    spi_device_polling_transmit(touch_spi, &touch_init_trans);
+    // STEP 5: Initialize touch controller; it has its own I2C bus and wakes on its INT line
+    if (touch_driver.init(TOUCH_I2C_PORT, TOUCH_SDA, TOUCH_SCL, TOUCH_IRQ) != ESP_OK) {
+        ESP_LOGW(TAG, "Touch controller unavailable, continuing without touch input");
+    }
 
     // STEP 6: Initialize Slint renderer
+    this->panel_handle = panel_handle;
     slint_init_with_custom_renderer(DISPLAY_WIDTH, DISPLAY_HEIGHT, panel_handle);
 
     // STEP 7: Create mutex for UI access
@@ -160,16 +168,12 @@ esp_err_t DisplayDriver::init()
     }
 
     // STEP 8: Start Slint task
-    xTaskCreate(slint_task, "slint", 8192, NULL, 5, NULL);
+    xTaskCreatePinnedToCore(slint_task, "slint", 8192, NULL, 5, NULL, SLINT_RENDER_TASK_CORE);
 
     this->initialized  = true;
-    this->panel_handle = panel_handle;
     this->width        = DISPLAY_WIDTH;
     this->height       = DISPLAY_HEIGHT;
 
-    // Register touch handler
-    slint_register_touch_event_handler(touch_get_xy);
-
     ESP_LOGI(TAG, "Display initialization complete");
     return ESP_OK;
 }
@@ -193,40 +197,55 @@ void DisplayDriver::tick()
     slint_tick();
 }
 
-// Implementation of touch_get_xy
-static bool touch_get_xy(uint16_t *x, uint16_t *y)
+esp_err_t DisplayDriver::flush(int x, int y, int w, int h, const uint16_t *pixels)
 {
-    if (!touch_spi) {
-        return false;
+    if (!panel_handle || !pixels || w <= 0 || h <= 0) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // Read touch controller registers to determine if screen is touched
-    // This is a simplified example and would need to be adapted for your specific touch controller
-    uint8_t cmd     = 0xD0;  // Example command to read touch status
-    uint8_t data[4] = {0};   // Buffer for touch data
+    // Send the region in row bands that fit one DMA transfer of the bus
+    size_t row_bytes = w * sizeof(uint16_t);
+    int band_lines   = DISPLAY_FLUSH_MAX_LINES * DISPLAY_WIDTH / w;
 
-    spi_transaction_t trans = {
-        .length    = 8,
-        .tx_buffer = &cmd,
-        .rx_buffer = data,
-    };
+    for (int row = 0; row < h; row += band_lines) {
+        int lines = (h - row < band_lines) ? (h - row) : band_lines;
+
+        if (lcd_bus_id != SPI_BUS_INVALID_DEVICE) {
+            spi_bus_manager.acquire(lcd_bus_id, portMAX_DELAY);
+        }
 
-    spi_device_polling_transmit(touch_spi, &trans);
+        esp_err_t ret = esp_lcd_panel_draw_bitmap((esp_lcd_panel_handle_t)panel_handle,
+                                                  x,
+                                                  y + row,
+                                                  x + w,
+                                                  y + row + lines,
+                                                  pixels + row * w);
+        if (ret == ESP_OK) {
+            // Hold the bus until the DMA of this band has finished
+            xSemaphoreTake(flush_done_sem, portMAX_DELAY);
+        }
 
-    // Check if touch is active (implementation depends on touch controller)
-    bool touched = (data[0] & 0x80) != 0;
-    if (touched && x && y) {
-        // Read X/Y coordinates (implementation depends on touch controller)
-        // This is a simplified example
-        *x = ((data[1] << 8) | data[2]) & 0x0FFF;
-        *y = ((data[2] << 8) | data[3]) & 0x0FFF;
+        if (lcd_bus_id != SPI_BUS_INVALID_DEVICE) {
+            spi_bus_manager.release(lcd_bus_id, lines * row_bytes);
+        }
 
-        // Normalize coordinates to display
-        *x = (*x * DISPLAY_WIDTH) / 4096;
-        *y = (*y * DISPLAY_HEIGHT) / 4096;
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Panel draw failed: %s", esp_err_to_name(ret));
+            return ret;
+        }
     }
 
-    return touched;
+    return ESP_OK;
+}
+
+// Color data transfer finished (ISR context)
+static bool display_color_trans_done(esp_lcd_panel_io_handle_t panel_io,
+                                     esp_lcd_panel_io_event_data_t *edata,
+                                     void *user_ctx)
+{
+    BaseType_t high_task_woken = pdFALSE;
+    xSemaphoreGiveFromISR(flush_done_sem, &high_task_woken);
+    return high_task_woken == pdTRUE;
 }
 
 // Implementation of Slint rendering task
@@ -234,18 +253,75 @@ static void slint_task(void *pvParameter)
 {
     ESP_LOGI(TAG, "Slint rendering task started");
 
+    slint_platform_set_render_task(xTaskGetCurrentTaskHandle());
+
+#ifdef DISPLAY_BENCHMARK_FRAMES
+    // Compare render modes: build once per DISPLAY_RENDER_MODE and compare the logs. The
+    // full-frame benchmark needs the main window and is run by UIManager::create().
+    pixel_kernels_benchmark();
+    chart_benchmark();
+    fixed_format_benchmark();
+#endif
+
+    TickType_t last_stats = xTaskGetTickCount();
+
     while (1) {
+        // Sleep until a redraw request, touch event, flush completion or the next
+        // Slint timer deadline. Nothing runs and the mutex stays free while idle.
+        TickType_t timeout = slint_platform_idle_timeout();
+        TickType_t stats_elapsed = xTaskGetTickCount() - last_stats;
+        TickType_t stats_period  = pdMS_TO_TICKS(SPI_STATS_INTERVAL_MS);
+        TickType_t stats_left    = stats_elapsed < stats_period ? stats_period - stats_elapsed : 0;
+        if (timeout > stats_left) {
+            timeout = stats_left;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout);
+        ui_wakeups++;
+
         // Acquire mutex to safely access Slint UI
         xSemaphoreTake(slint_mutex, portMAX_DELAY);
+        int64_t locked_us = esp_timer_get_time();
 
-        // Process a frame in Slint
+        // Process touch, timers and render if something changed
         slint_tick();
 
-        // Release mutex
+        uint32_t hold_us = (uint32_t)(esp_timer_get_time() - locked_us);
         xSemaphoreGive(slint_mutex);
 
-        // Frame rate control - target 60 FPS
-        vTaskDelay(pdMS_TO_TICKS(16));
+        ui_mutex_hold_us += hold_us;
+        if (hold_us > ui_mutex_max_us) {
+            ui_mutex_max_us = hold_us;
+        }
+
+        // Report render loop activity, SPI bus utilization and queue wait times
+        if (xTaskGetTickCount() - last_stats >= pdMS_TO_TICKS(SPI_STATS_INTERVAL_MS)) {
+            touch_stats_t touch_stats;
+            touch_get_stats(&touch_stats);
+
+            ESP_LOGI(TAG,
+                     "UI loop: %u wakeups, %u frames, mutex held %llu us (max %u us)",
+                     (unsigned)ui_wakeups,
+                     (unsigned)ui_frames,
+                     ui_mutex_hold_us,
+                     (unsigned)ui_mutex_max_us);
+            ESP_LOGI(TAG,
+                     "Touch: %u events, max latency %u us, %u dropped, max read %u us, "
+                     "%u read errors",
+                     (unsigned)ui_touch_events,
+                     (unsigned)ui_touch_latency_us,
+                     (unsigned)touch_stats.dropped,
+                     (unsigned)touch_stats.max_read_us,
+                     (unsigned)touch_stats.read_errors);
+            ui_wakeups          = 0;
+            ui_frames           = 0;
+            ui_mutex_hold_us    = 0;
+            ui_mutex_max_us     = 0;
+            ui_touch_events     = 0;
+            ui_touch_latency_us = 0;
+
+            spi_bus_manager.logStats();
+            last_stats = xTaskGetTickCount();
+        }
     }
 }
 
@@ -254,49 +330,36 @@ void slint_init_with_custom_renderer(int width, int height, void *panel)
 {
     ESP_LOGI(TAG, "Initializing Slint renderer with width=%d, height=%d", width, height);
 
-    // Allocate and initialize renderer structure
-    slint_renderer = (struct slint_renderer_t *)malloc(sizeof(struct slint_renderer_t));
-    if (!slint_renderer) {
-        ESP_LOGE(TAG, "Failed to allocate memory for Slint renderer");
-        return;
+    // Install the software renderer platform; frames are flushed through display.flush()
+    if (slint_platform_init(width, height) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize Slint platform");
     }
-
-    // Store parameters
-    slint_renderer->panel_handle = panel;
-    slint_renderer->width        = width;
-    slint_renderer->height       = height;
-    slint_renderer->framebuffer = NULL;  // We would allocate a framebuffer in a real implementation
-}
-
-// Register touch event handler
-void slint_register_touch_event_handler(bool (*handler)(uint16_t *x, uint16_t *y))
-{
-    touch_event_handler = handler;
 }
 
 // Process Slint events and update UI
 void slint_tick(void)
 {
-    // Check for touch events and process them
-    uint16_t x, y;
-    bool touched = touch_get_xy(&x, &y);
-
-    // Process touch events if handler is registered
-    if (touched && touch_event_handler) {
-        touch_event_handler(&x, &y);
+    // Apply state published by other tasks before this frame's events and rendering
+    if (frame_start_hook) {
+        frame_start_hook();
     }
 
-    // Here you would normally call Slint to render a frame
-    // For now, we'll just simulate a rendering operation
-    if (panel_handle) {
-        // In a full implementation, this would render the Slint UI to the display
-        // Currently just a placeholder for the rendering loop
-        static uint32_t frame_counter = 0;
-        frame_counter++;
+    // Forward queued touch events to the Slint window
+    touch_event_t event;
+    while (touch_pop_event(&event)) {
+        slint_platform_dispatch_touch(event.type != TOUCH_EVENT_RELEASE, event.x, event.y);
 
-        if (frame_counter % 100 == 0) {
-            ESP_LOGD(TAG, "Rendered frame %u", frame_counter);
+        // Touch-to-UI latency: touch IRQ (or sample) time to dispatch
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - event.timestamp_us);
+        if (latency_us > ui_touch_latency_us) {
+            ui_touch_latency_us = latency_us;
         }
+        ui_touch_events++;
+    }
+
+    // Run timers and render the dirty region; the flush task sends it to the panel
+    if (panel_handle && slint_platform_render()) {
+        ui_frames++;
     }
 }
 
@@ -318,4 +381,14 @@ void display_slint_release(void)
     display.releaseUIMutex();
 }
 
+esp_err_t display_flush(int x, int y, int w, int h, const uint16_t *pixels)
+{
+    return display.flush(x, y, w, h, pixels);
+}
+
+void display_set_frame_start_hook(void (*hook)(void))
+{
+    frame_start_hook = hook;
+}
+
 }  // extern "C"
\ No newline at end of file
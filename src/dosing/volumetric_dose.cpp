@@ -0,0 +1,205 @@
+#include "dosing/volumetric_dose.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "hardware/hardware_control.h"
+
+static const char *TAG = "DOSE";
+
+// Global instance
+VolumetricDose volumetric_dose;
+
+// VolumetricDose implementation
+VolumetricDose::VolumetricDose()
+    : pulses(0),
+      state(DOSE_STATE_IDLE),
+      cut_pulse(0),
+      start_pulse(0),
+      cut_count(0),
+      cut_us(0),
+      last_pulse_us(0),
+      cut_reported(false),
+      target_ml(0.0f)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats.drip_ml = DOSE_DRIP_INITIAL_ML;
+}
+
+void IRAM_ATTR VolumetricDose::onPulseFromIsr()
+{
+    uint32_t count = pulses.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    int current = state.load(std::memory_order_acquire);
+    if (current == DOSE_STATE_SETTLING) {
+        last_pulse_us = (uint32_t)esp_timer_get_time();
+        return;
+    }
+    if (current != DOSE_STATE_ARMED || (int32_t)(count - cut_pulse) < 0) {
+        return;
+    }
+
+    // Only one of this ISR and cancel() wins the armed dose
+    int expected = DOSE_STATE_ARMED;
+    if (!state.compare_exchange_strong(expected, DOSE_STATE_SETTLING)) {
+        return;
+    }
+    int64_t entry_us = esp_timer_get_time();
+    hw.cutPumpFromIsr(DOSE_CUT_SSR_MASK);
+    cut_count.store(count, std::memory_order_relaxed);
+    last_pulse_us = (uint32_t)entry_us;
+    cut_us        = (uint32_t)(esp_timer_get_time() - entry_us);
+}
+
+bool VolumetricDose::arm(float target_ml)
+{
+    if (state.load() == DOSE_STATE_SETTLING) {
+        finish();
+    }
+
+    float cut_ml = target_ml - stats.drip_ml;
+    if (!(cut_ml > 0.0f)) {
+        ESP_LOGW(TAG,
+                 "Target %.1f mL is within the %.1f mL drip, not armed",
+                 target_ml,
+                 stats.drip_ml);
+        return false;
+    }
+
+    // The ISR reads cut_pulse only after it sees ARMED
+    state.store(DOSE_STATE_IDLE);
+    this->target_ml = target_ml;
+    cut_reported    = false;
+    start_pulse     = pulses.load();
+    cut_pulse       = start_pulse + (uint32_t)lroundf(fmaxf(cut_ml * DOSE_PULSES_PER_ML, 1.0f));
+    state.store(DOSE_STATE_ARMED, std::memory_order_release);
+
+    ESP_LOGI(TAG,
+             "Armed %.1f mL: cut after %u pulses, %.1f mL drip expected",
+             target_ml,
+             (unsigned)(cut_pulse - start_pulse),
+             stats.drip_ml);
+    return true;
+}
+
+void VolumetricDose::cancel()
+{
+    float volume = volumeMl();
+    int expected = DOSE_STATE_ARMED;
+    if (state.compare_exchange_strong(expected, DOSE_STATE_IDLE)) {
+        stats.cancelled++;
+        ESP_LOGI(TAG, "Cancelled after %.1f mL", volume);
+    }
+}
+
+bool VolumetricDose::poll()
+{
+    if (state.load(std::memory_order_acquire) != DOSE_STATE_SETTLING) {
+        return false;
+    }
+
+    bool first   = !cut_reported;
+    cut_reported = true;
+
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    if (now_us - last_pulse_us >= DOSE_SETTLE_MS * 1000u) {
+        finish();
+    }
+    return first;
+}
+
+// The flow has stopped: score the shot, learn the drip and release the outputs
+void VolumetricDose::finish()
+{
+    uint32_t end    = pulses.load();
+    uint32_t cut    = cut_count.load();
+    float volume    = (end - start_pulse) / DOSE_PULSES_PER_ML;
+    float drip      = (end - cut) / DOSE_PULSES_PER_ML;
+    float error     = volume - target_ml;
+    float abs_error = fabsf(error);
+
+    stats.shots++;
+    stats.target_ml = target_ml;
+    stats.volume_ml = volume;
+    stats.error_ml  = error;
+    stats.mean_abs_error_ml += (abs_error - stats.mean_abs_error_ml) / stats.shots;
+    if (abs_error > stats.max_abs_error_ml) {
+        stats.max_abs_error_ml = abs_error;
+    }
+    stats.last_cut_us = cut_us;
+    if (cut_us > stats.max_cut_us) {
+        stats.max_cut_us = cut_us;
+    }
+
+    // Exponential average, so one odd shot (a channeling puck, an empty tank) only
+    // moves the next cutoff a little
+    stats.drip_ml += DOSE_DRIP_GAIN * (drip - stats.drip_ml);
+    stats.drip_ml = fminf(fmaxf(stats.drip_ml, 0.0f), DOSE_DRIP_MAX_ML);
+
+    hw.releasePumpCutoff();
+    state.store(DOSE_STATE_IDLE);
+
+    ESP_LOGI(TAG,
+             "Shot %u: %.1f of %.1f mL (%+.1f mL), drip %.1f mL, cut in %u us; "
+             "mean |error| %.2f mL, next drip %.1f mL",
+             (unsigned)stats.shots,
+             volume,
+             target_ml,
+             error,
+             drip,
+             (unsigned)stats.last_cut_us,
+             stats.mean_abs_error_ml,
+             stats.drip_ml);
+}
+
+float VolumetricDose::volumeMl() const
+{
+    if (state.load() == DOSE_STATE_IDLE) {
+        return stats.volume_ml;
+    }
+    return (pulses.load() - start_pulse) / DOSE_PULSES_PER_ML;
+}
+
+void VolumetricDose::getStats(dose_stats_t *out) const
+{
+    if (out != nullptr) {
+        *out = stats;
+    }
+}
+
+// C compatibility wrappers
+extern "C" {
+
+void IRAM_ATTR dose_on_pulse_from_isr(void)
+{
+    volumetric_dose.onPulseFromIsr();
+}
+
+bool dose_arm(float target_ml)
+{
+    return volumetric_dose.arm(target_ml);
+}
+
+void dose_cancel(void)
+{
+    volumetric_dose.cancel();
+}
+
+bool dose_poll(void)
+{
+    return volumetric_dose.poll();
+}
+
+void dose_get_stats(dose_stats_t *out)
+{
+    volumetric_dose.getStats(out);
+}
+
+uint32_t dose_pulse_count(void)
+{
+    return volumetric_dose.pulseCount();
+}
+
+}  // extern "C"
@@ -0,0 +1,64 @@
+#include "hardware/gpio_claims.h"
+
+#include <cstring>
+
+#include "esp_log.h"
+
+static const char *TAG = "GPIO";
+
+// Global instance
+GpioClaims gpio_claims;
+
+// GpioClaims implementation
+GpioClaims::GpioClaims()
+{
+    memset(users, 0, sizeof(users));
+}
+
+esp_err_t GpioClaims::claim(int pin, const char *user)
+{
+    if (pin < 0) {
+        return ESP_OK;
+    }
+    if (pin >= GPIO_CLAIM_PIN_COUNT) {
+        ESP_LOGE(TAG, "%s: there is no GPIO %d", user, pin);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (users[pin] != nullptr) {
+        ESP_LOGE(TAG, "%s: GPIO %d is already used by %s", user, pin, users[pin]);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    users[pin] = user;
+    return ESP_OK;
+}
+
+esp_err_t GpioClaims::claimAll(const int *pins, size_t count, const char *user)
+{
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t ret = claim(pins[i], user);
+        if (ret != ESP_OK) {
+            // Give back the pins this call took before the failing one
+            for (size_t j = 0; j < i; j++) {
+                release(pins[j]);
+            }
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+void GpioClaims::release(int pin)
+{
+    if (pin >= 0 && pin < GPIO_CLAIM_PIN_COUNT) {
+        users[pin] = nullptr;
+    }
+}
+
+const char *GpioClaims::user(int pin) const
+{
+    if (pin < 0 || pin >= GPIO_CLAIM_PIN_COUNT) {
+        return nullptr;
+    }
+    return users[pin];
+}
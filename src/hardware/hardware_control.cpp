@@ -4,6 +4,10 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "dosing/volumetric_dose.h"
+#include "hardware/gpio_claims.h"
+#include "spi_bus/spi_bus_manager.h"
+
 static const char *TAG = "HW_CONTROL";
 
 // Static member initialization
@@ -15,30 +19,36 @@ uint32_t HardwareControl::flow_meter2_count = 0;
 // Global instance
 HardwareControl hw;
 
-// Flow meter pulse counting (ISR)
+// Flow meter pulse counting (ISR). The counters are read by the sensor task and the
+// shot recorder while the interrupts stay enabled, so they are updated atomically.
 void IRAM_ATTR flow_meter1_isr(void *arg)
 {
-    HardwareControl::flow_meter1_count++;
+    __atomic_fetch_add(&HardwareControl::flow_meter1_count, 1, __ATOMIC_RELAXED);
+
+    // Flow meter 1 measures the shot
+    dose_on_pulse_from_isr();
 }
 
 void IRAM_ATTR flow_meter2_isr(void *arg)
 {
-    HardwareControl::flow_meter2_count++;
+    __atomic_fetch_add(&HardwareControl::flow_meter2_count, 1, __ATOMIC_RELAXED);
 }
 
 // HardwareControl implementation
 HardwareControl::HardwareControl() 
-    : initialized(false), dimmer_level(0), max6675_spi(nullptr)
+    : initialized(false), dimmer_level(0), max6675_spi(nullptr),
+      max6675_bus_id(SPI_BUS_INVALID_DEVICE), ssr_lockout_mask(0), dimmer_lockout(false),
+      lockout_warned(false), cutoff_ssr_mask(0), pump_cutoff(false)
 {
     memset(ssr_states, 0, sizeof(ssr_states));
+    output_lock = portMUX_INITIALIZER_UNLOCKED;
 }
 
 HardwareControl::~HardwareControl()
 {
-    // Properly clean up resources
+    // Properly clean up resources; the SPI host itself stays with the bus manager
     if (max6675_spi != nullptr) {
-        spi_bus_remove_device(max6675_spi);
-        spi_bus_free(SPI2_HOST);
+        spi_bus_manager.removeDevice(max6675_bus_id);
     }
 }
 
@@ -63,6 +73,11 @@ esp_err_t HardwareControl::init()
 void HardwareControl::initPressureSensor()
 {
     ESP_LOGI(TAG, "Initializing pressure sensor ADC");
+
+    gpio_num_t adc_pin;
+    ESP_ERROR_CHECK(adc1_pad_get_io_num(ADC_PRESSURE_CHANNEL, &adc_pin));
+    ESP_ERROR_CHECK(gpio_claims.claim(adc_pin, "pressure sensor"));
+
     adc1_config_width(ADC_WIDTH_BIT_12);
     adc1_config_channel_atten(ADC_PRESSURE_CHANNEL, ADC_ATTEN_DB_11);
 }
@@ -70,6 +85,7 @@ void HardwareControl::initPressureSensor()
 void HardwareControl::initDimmer()
 {
     ESP_LOGI(TAG, "Initializing AC dimmer");
+    ESP_ERROR_CHECK(gpio_claims.claim(DIMMER_PIN, "dimmer"));
 
     ledc_timer_config_t ledc_timer = {
         .duty_resolution = LEDC_TIMER_10_BIT,
@@ -110,13 +126,21 @@ void HardwareControl::initMax6675()
         .queue_size = 1,
     };
 
-    ESP_ERROR_CHECK(spi_bus_initialize(SPI2_HOST, &bus_config, SPI_DMA_CH_AUTO));
-    ESP_ERROR_CHECK(spi_bus_add_device(SPI2_HOST, &dev_config, &max6675_spi));
+    // A host of its own, so thermocouple reads never wait behind a display flush. The bus
+    // manager refuses pins or a chip select already taken by the display.
+    ESP_ERROR_CHECK(spi_bus_manager.initHost(MAX6675_SPI_HOST, &bus_config, SPI_DMA_CH_AUTO));
+    ESP_ERROR_CHECK(spi_bus_manager.addDevice(MAX6675_SPI_HOST,
+                                              &dev_config,
+                                              "max6675",
+                                              &max6675_bus_id,
+                                              &max6675_spi));
 }
 
 void HardwareControl::initFlowMeters()
 {
     ESP_LOGI(TAG, "Initializing flow meters");
+    ESP_ERROR_CHECK(gpio_claims.claim(FLOW_METER1_PIN, "flow meter 1"));
+    ESP_ERROR_CHECK(gpio_claims.claim(FLOW_METER2_PIN, "flow meter 2"));
 
     // Configure GPIO for flow meter pulse counting
     gpio_config_t io_conf = {
@@ -140,6 +164,7 @@ void HardwareControl::initSSR()
     // Initialize SSR pin bit mask
     uint64_t pin_mask = 0;
     for (int i = 0; i < SSR_COUNT; i++) {
+        ESP_ERROR_CHECK(gpio_claims.claim(SSR_PINS[i], SSR_NAMES[i]));
         pin_mask |= (1ULL << SSR_PINS[i]);
     }
 
@@ -161,25 +186,59 @@ void HardwareControl::initSSR()
 
 void HardwareControl::setDimmer(uint32_t level)
 {
-    ESP_LOGI(TAG, "Setting dimmer level to %u", level);
+    bool warn = false;
+
+    // Check the lockouts and write the duty in one critical section, see output_lock
+    portENTER_CRITICAL(&output_lock);
+    if (dimmer_lockout && level > 0) {
+        warn           = !lockout_warned;
+        lockout_warned = true;
+        level          = 0;
+    }
+    if (pump_cutoff) {
+        level = 0;  // Shot volume reached, see cutPumpFromIsr()
+    }
     dimmer_level = level;
     ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, level);
     ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
+    portEXIT_CRITICAL(&output_lock);
+
+    // The control loop asks again every cycle; only the first refusal per trip is logged
+    if (warn) {
+        ESP_LOGW(TAG, "Dimmer locked out by safety interlock");
+    }
+    ESP_LOGD(TAG, "Setting dimmer level to %u", level);
 }
 
 void HardwareControl::setSSRState(int index, bool state)
 {
     if (index >= 0 && index < SSR_COUNT) {
-        ESP_LOGI(TAG, "Setting SSR %s to %s", SSR_NAMES[index], state ? "ON" : "OFF");
-        gpio_set_level(SSR_PINS[index], state ? 1 : 0);
+        bool warn = false;
+
+        portENTER_CRITICAL(&output_lock);
+        if (state && (ssr_lockout_mask & (1u << index))) {
+            warn           = !lockout_warned;
+            lockout_warned = true;
+            state          = false;
+        }
+        if (cutoff_ssr_mask & (1u << index)) {
+            state = false;
+        }
+        gpio_set_level((gpio_num_t)SSR_PINS[index], state ? 1 : 0);
         ssr_states[index] = state;
+        portEXIT_CRITICAL(&output_lock);
+
+        if (warn) {
+            ESP_LOGW(TAG, "SSR %s locked out by safety interlock", SSR_NAMES[index]);
+        }
+        ESP_LOGD(TAG, "Setting SSR %s to %s", SSR_NAMES[index], state ? "ON" : "OFF");
     }
 }
 
 void HardwareControl::setSSRPWM(int index, float pwm)
 {
     if (index >= 0 && index < SSR_COUNT) {
-        ESP_LOGI(TAG, "Setting SSR %s PWM to %.2f", SSR_NAMES[index], pwm);
+        ESP_LOGD(TAG, "Setting SSR %s PWM to %.2f", SSR_NAMES[index], pwm);
         
         // For now, just use simple on/off based on PWM threshold
         // In a real implementation, you would use hardware PWM or software PWM
@@ -195,6 +254,70 @@ void HardwareControl::setAllSSR(bool state)
     }
 }
 
+void HardwareControl::forceSafe(uint32_t ssr_mask, bool dimmer_off)
+{
+    // Latch the lockout and switch off under output_lock, so a setter either completes
+    // before the trip or sees the lockout
+    portENTER_CRITICAL(&output_lock);
+    ssr_lockout_mask |= ssr_mask;
+    if (dimmer_off) {
+        dimmer_lockout = true;
+    }
+
+    for (int i = 0; i < SSR_COUNT; i++) {
+        if (ssr_mask & (1u << i)) {
+            gpio_set_level((gpio_num_t)SSR_PINS[i], 0);
+            ssr_states[i] = false;
+        }
+    }
+
+    if (dimmer_off) {
+        dimmer_level = 0;
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, 0);
+        ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
+    }
+    portEXIT_CRITICAL(&output_lock);
+}
+
+void HardwareControl::clearSafetyLockout()
+{
+    ESP_LOGI(TAG, "Clearing safety lockout");
+    portENTER_CRITICAL(&output_lock);
+    ssr_lockout_mask = 0;
+    dimmer_lockout   = false;
+    lockout_warned   = false;
+    portEXIT_CRITICAL(&output_lock);
+}
+
+void IRAM_ATTR HardwareControl::cutPumpFromIsr(uint32_t ssr_mask)
+{
+    portENTER_CRITICAL_ISR(&output_lock);
+    cutoff_ssr_mask |= ssr_mask;
+    pump_cutoff = true;
+
+    for (int i = 0; i < SSR_COUNT; i++) {
+        if (ssr_mask & (1u << i)) {
+            gpio_set_level((gpio_num_t)SSR_PINS[i], 0);
+            ssr_states[i] = false;
+        }
+    }
+
+    // The GPIO ISR service is installed without ESP_INTR_FLAG_IRAM, so the LEDC driver
+    // may be called here. ledc_stop() idles the output at once; the next duty update
+    // restarts it.
+    dimmer_level = 0;
+    ledc_stop(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, 0);
+    portEXIT_CRITICAL_ISR(&output_lock);
+}
+
+void HardwareControl::releasePumpCutoff()
+{
+    portENTER_CRITICAL(&output_lock);
+    cutoff_ssr_mask = 0;
+    pump_cutoff     = false;
+    portEXIT_CRITICAL(&output_lock);
+}
+
 // C compatibility wrappers
 extern "C" {
 
@@ -251,6 +374,16 @@ void hw_set_all_ssr(bool state)
     hw.setAllSSR(state);
 }
 
+void hw_force_safe(uint32_t ssr_mask, bool dimmer_off)
+{
+    hw.forceSafe(ssr_mask, dimmer_off);
+}
+
+void hw_clear_safety_lockout(void)
+{
+    hw.clearSafetyLockout();
+}
+
 void hardware_control_init(void) 
 {
     hw.init();
@@ -19,15 +19,21 @@
 #endif
 
 #include "display_driver.h"
+#include "dosing/volumetric_dose.h"
 #include "esp_event.h"
 #include "esp_netif.h"
 #include "esp_timer.h"
 #include "nvs_flash.h"
 #include "pid_controller.h"
+#include "profile/profile_engine.h"
 
 // Include our new modules
+#include "control/control_queue.h"
 #include "hardware/hardware_control.h"
+#include "recorder/shot_recorder.h"
+#include "safety/safety_interlock.h"
 #include "sensor_manager/sensor_manager.h"
+#include "telemetry/telemetry_store.h"
 #include "ui_manager/ui_manager.h"
 
 // Tag for logging
@@ -46,6 +52,10 @@ static const char *TAG = "MAIN";
 #define PRESSURE_MAX_OUTPUT 1023.0f      // Maximum output (100% dimmer)
 #define PRESSURE_DEFAULT_SETPOINT 30.0f  // Default pressure setpoint (PSI)
 
+// Extraction profile started by CONTROL_CMD_PROFILE_START with index -1, the one the
+// home screen shows
+#define PROFILE_DEFAULT_NAME "RAO’S BLOOMING ESPRESSO"
+
 // SSR PID control parameters - Only the first SSR (heater) uses PID by default
 #define SSR_PID_ENABLED {true, false, false, false}            // Which SSRs use PID control
 #define SSR_PID_KP {5.0f, 5.0f, 5.0f, 5.0f}                    // Proportional gains
@@ -56,7 +66,6 @@ static const char *TAG = "MAIN";
 
 // Global variables
 static EventGroupHandle_t wifi_event_group;
-static spi_device_handle_t max6675_spi;
 
 // PID controllers
 static PIDController pressure_pid(PRESSURE_KP,
@@ -79,6 +88,13 @@ static bool pid_enabled                = true;
 // Sensor data
 static sensor_data_t sensor_data = {0};
 
+// Flow meter 1 pulse count when the running profile started; its volume exits count
+// from here
+static uint32_t profile_start_pulses = 0;
+
+// Reporting interval of the sensor task's UI publish time
+#define UI_PUBLISH_STATS_INTERVAL_MS 10000
+
 // Event group bits
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT BIT1
@@ -205,52 +221,197 @@ static void init_pid_controllers(void)
         ssr_pid[i].setSetpoint(setpoints[i]);
         ESP_LOGI(TAG, "SSR%d PID initialized, setpoint=%.1f", i + 1, setpoints[i]);
     }
+
+    // Profiles are compiled into the firmware, so starting one loads nothing
+    ESP_LOGI(TAG, "%d extraction profiles", profile_engine_count());
 }
 
-// UI Callback handlers
+// UI callback handlers. They run on the render task with the UI mutex held, so they
+// only queue commands; the sensor task applies them between control cycles.
 static void on_ssr_toggled(int index, bool state)
 {
-    if (!pid_enabled) {
-        hw_set_ssr_state(index, state);
-        sensor_data.ssr_states[index] = state;
-    }
+    control_cmd_t cmd = {};
+    cmd.type          = CONTROL_CMD_SSR_STATE;
+    cmd.index         = index;
+    cmd.state         = state;
+    control_queue_post(&cmd);
 }
 
 static void on_dimmer_changed(uint32_t level)
 {
-    if (!pid_enabled) {
-        hw_set_dimmer(level);
-        sensor_data.dimmer_level = level;
-    }
+    control_cmd_t cmd = {};
+    cmd.type          = CONTROL_CMD_DIMMER;
+    cmd.level         = level;
+    control_queue_post(&cmd);
 }
 
 static void on_pid_setpoint_changed(int index, float setpoint)
 {
-    if (index < 0) {
-        // Special case: pressure setpoint
-        pressure_pid.setSetpoint(setpoint);
-    }
-    else if (index < SSR_COUNT && ssr_pid_enabled[index]) {
-        // SSR setpoint
-        ssr_pid[index].setSetpoint(setpoint);
-    }
+    control_cmd_t cmd = {};
+    cmd.type          = CONTROL_CMD_SETPOINT;
+    cmd.index         = index;
+    cmd.setpoint      = setpoint;
+    control_queue_post(&cmd);
 }
 
 static void on_pid_toggled(bool enabled)
 {
-    pid_enabled = enabled;
-
-    // If PID is disabled, reset controllers to avoid integration windup
-    if (!pid_enabled) {
-        pressure_pid.reset();
-        for (int i = 0; i < SSR_COUNT; i++) {
-            if (ssr_pid_enabled[i]) {
-                ssr_pid[i].reset();
+    control_cmd_t cmd = {};
+    cmd.type          = CONTROL_CMD_PID_ENABLE;
+    cmd.state         = enabled;
+    control_queue_post(&cmd);
+}
+
+static void on_safety_reset(void)
+{
+    control_cmd_t cmd = {};
+    cmd.type          = CONTROL_CMD_SAFETY_RESET;
+    control_queue_post(&cmd);
+}
+
+static void on_shot(bool start)
+{
+    control_cmd_t cmd = {};
+    cmd.type          = start ? CONTROL_CMD_PROFILE_START : CONTROL_CMD_PROFILE_STOP;
+    cmd.index         = -1;  // The profile the home screen shows
+    control_queue_post(&cmd);
+}
+
+// A shot or a manual pump run is in progress. The pressure PID holds its setpoint at
+// idle too, so the dimmer level alone does not tell.
+static bool shot_active(void)
+{
+    return profile_engine_is_running() || volumetric_dose.getState() != DOSE_STATE_IDLE ||
+           (!pid_enabled && sensor_data.dimmer_level > 0);
+}
+
+// Apply one UI command; runs on the sensor task only
+static void apply_control_command(const control_cmd_t &cmd)
+{
+    switch (cmd.type) {
+        case CONTROL_CMD_SSR_STATE:
+            if (!pid_enabled && cmd.index >= 0 && cmd.index < SSR_COUNT) {
+                hw_set_ssr_state(cmd.index, cmd.state);
+                sensor_data.ssr_states[cmd.index] = cmd.state;
+            }
+            break;
+
+        case CONTROL_CMD_DIMMER:
+            if (!pid_enabled) {
+                hw_set_dimmer(cmd.level);
+                sensor_data.dimmer_level = cmd.level;
+            }
+            break;
+
+        case CONTROL_CMD_SETPOINT:
+            if (cmd.index < 0) {
+                // Special case: pressure setpoint, which takes over from a running profile
+                profile_engine_stop();
+                dose_cancel();
+                pressure_pid.setSetpoint(cmd.setpoint);
+            }
+            else if (cmd.index < SSR_COUNT && ssr_pid_enabled[cmd.index]) {
+                // SSR setpoint
+                ssr_pid[cmd.index].setSetpoint(cmd.setpoint);
+            }
+            break;
+
+        case CONTROL_CMD_PID_ENABLE:
+            pid_enabled = cmd.state;
+
+            // If PID is disabled, reset controllers to avoid integration windup. Profiles
+            // drive the pressure PID, so a running one stops too.
+            if (!pid_enabled) {
+                profile_engine_stop();
+                dose_cancel();
+                pressure_pid.reset();
+                for (int i = 0; i < SSR_COUNT; i++) {
+                    if (ssr_pid_enabled[i]) {
+                        ssr_pid[i].reset();
+                    }
+                }
+            }
+            break;
+
+        case CONTROL_CMD_PROFILE_START: {
+            // The profile drives the pressure setpoint from the next control cycle
+            int index = cmd.index < 0 ? profile_engine.find(PROFILE_DEFAULT_NAME) : cmd.index;
+            if (pid_enabled && profile_engine_start(index, esp_timer_get_time() / 1000)) {
+                profile_start_pulses = dose_pulse_count();
+                pressure_pid.reset();
+
+                // A volume exit on the last segment ends the shot; let the flow meter
+                // interrupt cut it instead of waiting for the next control cycle
+                const profile_t *profile      = profile_engine.get(index);
+                const profile_segment_t &last = profile->segments[profile->segment_count - 1];
+                if (last.exits & PROFILE_EXIT_VOLUME) {
+                    dose_arm(last.exit_volume_ml);
+                }
             }
+            break;
         }
+
+        case CONTROL_CMD_PROFILE_STOP:
+            dose_cancel();
+            if (profile_engine_is_running()) {
+                profile_engine_stop();
+                pressure_pid.setSetpoint(0.0f);  // Pump off
+            }
+            break;
+
+        case CONTROL_CMD_DOSE:
+            if (cmd.setpoint > 0.0f) {
+                dose_arm(cmd.setpoint);
+            }
+            else {
+                dose_cancel();
+            }
+            break;
+
+        case CONTROL_CMD_SAFETY_RESET:
+            // Refused, and logged, while a rule is still violated
+            safety_interlock_reset();
+            break;
     }
 }
 
+static_assert(SHOT_CH_SSR4 - SHOT_CH_SSR1 + 1 == SSR_COUNT, "One shot channel per SSR");
+
+// Hand the cycle to the shot recorder, whose 100 Hz frames repeat it until the next
+// cycle, and to the long-term telemetry store
+static void record_cycle(void)
+{
+    shot_sample_t sample = {};
+    sample.extracting    = shot_active();
+
+    float *values                     = sample.values;
+    values[SHOT_CH_TEMPERATURE]       = sensor_data.temperature;
+    values[SHOT_CH_PRESSURE]          = sensor_data.pressure;
+    values[SHOT_CH_FLOW1]             = sensor_data.flow_rate1;
+    values[SHOT_CH_FLOW2]             = sensor_data.flow_rate2;
+    values[SHOT_CH_PRESSURE_SETPOINT] = pressure_pid.getSetpoint();
+    pressure_pid.getTerms(&values[SHOT_CH_PRESSURE_P],
+                          &values[SHOT_CH_PRESSURE_I],
+                          &values[SHOT_CH_PRESSURE_D]);
+    values[SHOT_CH_DIMMER] = (float)sensor_data.dimmer_level;
+    for (int i = 0; i < SSR_COUNT; i++) {
+        values[SHOT_CH_SSR1 + i] = sensor_data.ssr_pwm[i];
+    }
+
+    shot_recorder_capture(&sample);
+
+    // Interlock trips are kept as fault bits, one per rule
+    uint16_t faults = 0;
+    if (safety_interlock_is_tripped()) {
+        safety_stats_t safety;
+        safety_interlock_get_stats(&safety);
+        if (safety.last_trip_rule >= 0 && safety.last_trip_rule < 15) {
+            faults |= (uint16_t)(1u << safety.last_trip_rule);
+        }
+    }
+    telemetry_store_record(&sensor_data, faults);
+}
+
 // Sensor reading task
 static void sensor_task(void *pvParameters)
 {
@@ -259,20 +420,68 @@ static void sensor_task(void *pvParameters)
     // Initialize sensor data structure
     memset(&sensor_data, 0, sizeof(sensor_data_t));
 
+    // Worst time spent handing data to the UI, reported every UI_PUBLISH_STATS_INTERVAL_MS
+    int64_t stats_start_us     = esp_timer_get_time();
+    uint32_t ui_publish_max_us = 0;
+
     // Loop forever reading sensors
     while (1) {
+        // Apply UI commands queued since the last cycle
+        control_cmd_t cmd;
+        while (control_queue_pop(&cmd)) {
+            apply_control_command(cmd);
+            control_queue_complete(&cmd);
+        }
+
         // Read sensors
-        sensor_manager_read_all(&sensor_data);
+        sensor_read_all(&sensor_data);
+
+        // Hand fresh readings to the interlock before anything that can block
+        safety_interlock_publish(&sensor_data, shot_active());
+
+        // Record history, then publish it with the readings. The render task applies
+        // them at its next frame; this task never waits on the UI mutex.
+        sensor_update_history(&sensor_data, esp_timer_get_time() / 1000);
+        profile_status_t profile;
+        profile_engine_get_status(&profile);
+        int64_t publish_start_us = esp_timer_get_time();
+        ui_publish(&sensor_data, &profile, sensor_get_history());
+        uint32_t publish_us = (uint32_t)(esp_timer_get_time() - publish_start_us);
+        if (publish_us > ui_publish_max_us) {
+            ui_publish_max_us = publish_us;
+        }
+        if (publish_start_us - stats_start_us >= UI_PUBLISH_STATS_INTERVAL_MS * 1000LL) {
+            ESP_LOGI(TAG,
+                     "Sensor task blocked on UI publish: max %u us",
+                     (unsigned)ui_publish_max_us);
+            stats_start_us    = publish_start_us;
+            ui_publish_max_us = 0;
+        }
 
-        // Update UI with sensor data
-        display_slint_acquire();
-        ui_manager_update_sensor_data(&sensor_data);
-        display_slint_release();
+        // The flow meter interrupt has cut the pump at the shot volume. Bring the
+        // controller to rest before it can drive the pump again.
+        if (dose_poll()) {
+            profile_engine_stop();
+            pressure_pid.setSetpoint(0.0f);
+            pressure_pid.reset();
+        }
 
         // Run PID controllers if enabled
         if (pid_enabled) {
             uint32_t current_time = esp_timer_get_time() / 1000;  // Convert to ms
 
+            // A running profile sets the pressure setpoint every cycle. Its volume is
+            // counted in flow meter pulses, like the volumetric dose.
+            if (profile_engine_is_running()) {
+                float volume_ml =
+                    (dose_pulse_count() - profile_start_pulses) / DOSE_PULSES_PER_ML;
+                pressure_pid.setSetpoint(
+                    profile_engine_tick(current_time, sensor_data.pressure, volume_ml));
+                if (!profile_engine_is_running()) {
+                    dose_cancel();  // Ended before the dose volume
+                }
+            }
+
             // Update pressure PID
             float pressure_output = pressure_pid.compute(sensor_data.pressure, current_time);
             hw_set_dimmer((uint32_t)pressure_output);
@@ -289,7 +498,7 @@ static void sensor_task(void *pvParameters)
                             input_value = sensor_data.temperature;
                             break;
                         case 1:  // Pump
-                            input_value = sensor_data.flow_rate;
+                            input_value = sensor_data.flow_rate1;
                             break;
                         default:
                             input_value = 0.0f;  // Default
@@ -308,6 +517,9 @@ static void sensor_task(void *pvParameters)
             }
         }
 
+        // Record after the actuators are set, so the recorder sees this cycle's outputs
+        record_cycle();
+
         // Delay for sensor task
         vTaskDelay(pdMS_TO_TICKS(50));  // 20Hz sensor update rate
     }
@@ -326,9 +538,18 @@ extern "C" void app_main(void)
     ESP_ERROR_CHECK(ret);
 
     // Initialize components
-    ESP_ERROR_CHECK(display_init());         // Initialize display and UI
-    ESP_ERROR_CHECK(hw_init());              // Initialize hardware control
-    ESP_ERROR_CHECK(sensor_manager_init());  // Initialize sensor manager
+    ESP_ERROR_CHECK(display_init());           // Initialize display and UI
+    ESP_ERROR_CHECK(hw_init());                // Initialize hardware control
+    ESP_ERROR_CHECK(safety_interlock_init());  // Start the safety interlock
+
+    // Sensors read the thermocouple through the SPI device added by hw_init()
+    ESP_ERROR_CHECK(sensor_manager_init(hw.getMax6675Handle()));
+
+    // Shots are not recorded without the shot partition; the machine still runs
+    shot_recorder_init();
+
+    // Same for telemetry without the telemetry partition
+    telemetry_store_init();
 
     // Initialize communication
     init_wifi();       // Initialize WiFi
@@ -336,15 +557,20 @@ extern "C" void app_main(void)
 
     // Initialize UI manager with callback handlers
     ui_manager_init();
-    ui_manager_register_callbacks(
-        on_ssr_toggled, on_dimmer_changed, on_pid_setpoint_changed, on_pid_toggled);
+    ui_manager_register_callbacks(on_ssr_toggled,
+                                  on_dimmer_changed,
+                                  on_pid_setpoint_changed,
+                                  on_pid_toggled,
+                                  on_safety_reset,
+                                  on_shot);
+    ui_create(SSR_COUNT, HardwareControl::SSR_NAMES, ssr_pid_enabled);
 
     // Initialize PID controllers
     init_pid_controllers();
 
-    // Create sensor reading task (highest priority)
-    xTaskCreate(sensor_task, "sensor", 4096, NULL, configMAX_PRIORITIES - 1, NULL);
+    // Create sensor reading task, just below the safety interlock so the interlock can
+    // always preempt it
+    xTaskCreate(sensor_task, "sensor", 4096, NULL, SAFETY_TASK_PRIORITY - 1, NULL);
 
-    ESP_LOGI(TAG, "Initialization complete");
+    ESP_LOGI(TAG, "Initialization complete in %lld ms", esp_timer_get_time() / 1000);
 }
-}
\ No newline at end of file
@@ -27,6 +27,10 @@ PIDController::PIDController(float kp,
     this->input    = 0.0f;
     this->output   = 0.0f;
 
+    this->p_term = 0.0f;
+    this->i_term = 0.0f;
+    this->d_term = 0.0f;
+
     this->error_sum   = 0.0f;
     this->last_error  = 0.0f;
     this->last_input  = 0.0f;
@@ -104,6 +108,9 @@ void PIDController::reset()
     this->last_input  = 0.0f;
     this->initialized = false;
     this->output      = 0.0f;
+    this->p_term      = 0.0f;
+    this->i_term      = 0.0f;
+    this->d_term      = 0.0f;
 
     ESP_LOGI(TAG, "PID controller reset");
 }
@@ -162,6 +169,9 @@ float PIDController::compute(float input, uint32_t current_time)
     this->last_error  = error;
     this->last_time   = current_time;
     this->output      = output;
+    this->p_term      = p_term;
+    this->i_term      = i_term;
+    this->d_term      = d_term;
     this->initialized = true;
 
     ESP_LOGD(TAG,
@@ -0,0 +1,212 @@
+#include "profile/profile_engine.h"
+
+#include <cstring>
+
+#include "esp_log.h"
+
+// PROFILE_TABLE and PROFILE_COUNT, generated from profiles/*.json by
+// scripts/build_profiles.py
+#include "profiles_generated.h"
+
+static const char *TAG = "PROFILE";
+
+// Global instance
+ProfileEngine profile_engine(PROFILE_TABLE, PROFILE_COUNT);
+
+// ProfileEngine implementation
+ProfileEngine::ProfileEngine(const profile_t *profiles, int profile_count)
+    : profiles(profiles),
+      profile_count(profile_count),
+      state(PROFILE_STATE_IDLE),
+      profile(-1),
+      segment(-1),
+      start_ms(0),
+      segment_start_ms(0),
+      last_tick_ms(0),
+      entry_setpoint(0.0f),
+      slope(0.0f),
+      setpoint(0.0f),
+      volume_ml(0.0f)
+{
+}
+
+const profile_t *ProfileEngine::get(int index) const
+{
+    if (index < 0 || index >= profile_count) {
+        return nullptr;
+    }
+    return &profiles[index];
+}
+
+int ProfileEngine::find(const char *name) const
+{
+    for (int i = 0; i < profile_count; i++) {
+        if (strcmp(profiles[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool ProfileEngine::start(int index, uint32_t now_ms)
+{
+    if (get(index) == nullptr || profiles[index].segment_count == 0) {
+        ESP_LOGW(TAG, "No profile %d", index);
+        return false;
+    }
+
+    profile      = index;
+    state        = PROFILE_STATE_RUNNING;
+    start_ms     = now_ms;
+    last_tick_ms = now_ms;
+    setpoint     = 0.0f;
+    volume_ml    = 0.0f;
+    enterSegment(0, now_ms);
+
+    ESP_LOGI(TAG,
+             "Starting \"%s\", %d segments",
+             profiles[index].name,
+             profiles[index].segment_count);
+    return true;
+}
+
+void ProfileEngine::stop()
+{
+    if (state == PROFILE_STATE_RUNNING) {
+        ESP_LOGI(TAG, "Stopped in segment %d after %.1f mL", segment, volume_ml);
+    }
+    state    = PROFILE_STATE_IDLE;
+    segment  = -1;
+    setpoint = 0.0f;
+}
+
+// Ramps are solved here, once per segment, so tick() only multiplies
+void ProfileEngine::enterSegment(int index, uint32_t now_ms)
+{
+    const profile_segment_t &seg = profiles[profile].segments[index];
+
+    segment          = index;
+    segment_start_ms = now_ms;
+    entry_setpoint   = setpoint;
+    slope            = 0.0f;
+    if (seg.type == PROFILE_SEG_RAMP && seg.ramp_ms > 0) {
+        slope = (seg.target - entry_setpoint) / (float)seg.ramp_ms;
+    }
+}
+
+float ProfileEngine::segmentSetpoint(const profile_segment_t &seg, uint32_t elapsed_ms) const
+{
+    switch (seg.type) {
+        case PROFILE_SEG_STEP:
+            return seg.target;
+
+        case PROFILE_SEG_RAMP:
+            return elapsed_ms >= seg.ramp_ms ? seg.target
+                                             : entry_setpoint + slope * (float)elapsed_ms;
+
+        default:  // PROFILE_SEG_HOLD
+            return entry_setpoint;
+    }
+}
+
+bool ProfileEngine::segmentDone(const profile_segment_t &seg,
+                                uint32_t elapsed_ms,
+                                float pressure) const
+{
+    uint8_t exits = seg.exits;
+    return ((exits & PROFILE_EXIT_TIME) && elapsed_ms >= seg.exit_time_ms) ||
+           ((exits & PROFILE_EXIT_VOLUME) && volume_ml >= seg.exit_volume_ml) ||
+           ((exits & PROFILE_EXIT_PRESSURE_ABOVE) && pressure >= seg.exit_pressure) ||
+           ((exits & PROFILE_EXIT_PRESSURE_BELOW) && pressure <= seg.exit_pressure);
+}
+
+float ProfileEngine::tick(uint32_t now_ms, float pressure, float volume_ml)
+{
+    if (state != PROFILE_STATE_RUNNING) {
+        return 0.0f;
+    }
+
+    this->volume_ml = volume_ml;
+    last_tick_ms    = now_ms;
+
+    const profile_t &prof = profiles[profile];
+    uint32_t elapsed_ms   = now_ms - segment_start_ms;
+    if (segmentDone(prof.segments[segment], elapsed_ms, pressure)) {
+        // The next segment starts from where this one ended, also when no tick fell
+        // inside it or the last one came before a ramp reached its target
+        setpoint = segmentSetpoint(prof.segments[segment], elapsed_ms);
+        if (segment + 1 >= prof.segment_count) {
+            ESP_LOGI(TAG,
+                     "\"%s\" done: %.1f s, %.1f mL",
+                     prof.name,
+                     (now_ms - start_ms) / 1000.0f,
+                     volume_ml);
+            state    = PROFILE_STATE_DONE;
+            setpoint = 0.0f;
+            return setpoint;
+        }
+        enterSegment(segment + 1, now_ms);
+    }
+
+    setpoint = segmentSetpoint(prof.segments[segment], now_ms - segment_start_ms);
+    return setpoint;
+}
+
+void ProfileEngine::getStatus(profile_status_t *out) const
+{
+    if (out == nullptr) {
+        return;
+    }
+    bool running      = state == PROFILE_STATE_RUNNING;
+    out->state        = state;
+    out->profile      = state == PROFILE_STATE_IDLE ? -1 : profile;
+    out->segment      = running ? segment : -1;
+    out->segment_name = running                       ? profiles[profile].segments[segment].name
+                        : state == PROFILE_STATE_DONE ? "DONE"
+                                                      : "IDLE";
+    out->shot_ms      = running ? last_tick_ms - start_ms : 0;
+    out->segment_ms   = running ? last_tick_ms - segment_start_ms : 0;
+    out->volume_ml    = volume_ml;
+    out->setpoint     = setpoint;
+}
+
+// C compatibility wrappers
+extern "C" {
+
+int profile_engine_count(void)
+{
+    return profile_engine.count();
+}
+
+const char *profile_engine_name(int index)
+{
+    const profile_t *profile = profile_engine.get(index);
+    return profile ? profile->name : nullptr;
+}
+
+bool profile_engine_start(int index, uint32_t now_ms)
+{
+    return profile_engine.start(index, now_ms);
+}
+
+void profile_engine_stop(void)
+{
+    profile_engine.stop();
+}
+
+bool profile_engine_is_running(void)
+{
+    return profile_engine.isRunning();
+}
+
+float profile_engine_tick(uint32_t now_ms, float pressure, float volume_ml)
+{
+    return profile_engine.tick(now_ms, pressure, volume_ml);
+}
+
+void profile_engine_get_status(profile_status_t *out)
+{
+    profile_engine.getStatus(out);
+}
+
+}  // extern "C"
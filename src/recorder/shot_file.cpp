@@ -0,0 +1,72 @@
+#include "recorder/shot_file.h"
+
+#include <cstring>
+
+extern "C" {
+
+const shot_channel_info_t SHOT_CHANNELS[SHOT_CHANNEL_COUNT] = {
+    {"temperature", "C", 0.01f},
+    {"pressure", "PSI", 0.01f},
+    {"flow1", "mL/min", 0.1f},
+    {"flow2", "mL/min", 0.1f},
+    {"volume1", "mL", 0.1f},
+    {"volume2", "mL", 0.1f},
+    {"pressure_sp", "PSI", 0.01f},
+    {"pressure_p", "", 0.1f},
+    {"pressure_i", "", 0.1f},
+    {"pressure_d", "", 0.1f},
+    {"dimmer", "", 1.0f},
+    {"ssr1", "", 0.0001f},
+    {"ssr2", "", 0.0001f},
+    {"ssr3", "", 0.0001f},
+    {"ssr4", "", 0.0001f},
+};
+
+int16_t shot_file_to_raw(float value, shot_channel_t channel)
+{
+    float raw = value / SHOT_CHANNELS[channel].scale;
+    raw += raw < 0 ? -0.5f : 0.5f;
+    if (!(raw > -32768.0f)) {
+        return INT16_MIN;
+    }
+    if (raw >= 32767.0f) {
+        return INT16_MAX;
+    }
+    return (int16_t)raw;
+}
+
+void shot_file_header(shot_file_header_t *header,
+                      uint32_t frame_count,
+                      uint32_t shot_index,
+                      uint32_t start_ms)
+{
+    memcpy(header->magic, SHOT_FILE_MAGIC, sizeof(header->magic));
+    header->version       = SHOT_FILE_VERSION;
+    header->channel_count = SHOT_CHANNEL_COUNT;
+    header->frame_count   = frame_count;
+    header->shot_index    = shot_index;
+    header->start_ms      = start_ms;
+}
+
+size_t shot_file_sections(const shot_file_header_t *header,
+                          const uint32_t *times,
+                          int16_t *const *columns,
+                          shot_file_section_t *sections)
+{
+    uint32_t frames = header->frame_count;
+
+    sections[0] = {header, sizeof(*header), false};
+    sections[1] = {SHOT_CHANNELS, sizeof(SHOT_CHANNELS), false};
+    sections[2] = {times, frames * sizeof(uint32_t), true};
+    for (int c = 0; c < SHOT_CHANNEL_COUNT; c++) {
+        sections[3 + c] = {columns[c], frames * sizeof(int16_t), true};
+    }
+
+    size_t total = 0;
+    for (int s = 0; s < SHOT_FILE_SECTIONS; s++) {
+        total += sections[s].size;
+    }
+    return total;
+}
+
+}  // extern "C"
@@ -0,0 +1,434 @@
+#include "recorder/shot_recorder.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_spiffs.h"
+#include "esp_timer.h"
+#include "hardware/hardware_control.h"
+#include "sensor_manager/sensor_manager.h"
+
+static const char *TAG = "RECORDER";
+
+// Global instance
+ShotRecorder shot_recorder;
+
+// ShotRecorder implementation
+ShotRecorder::ShotRecorder()
+    : times(nullptr),
+      columns{},
+      frame_count(0),
+      start_us(0),
+      idle_since_us(0),
+      extracted_ms(0),
+      shot_index(0),
+      skipping(false),
+      start_pulses{},
+      state(IDLE),
+      task_handle(nullptr),
+      sample_timer(nullptr),
+      initialized(false)
+{
+    memset(&stats, 0, sizeof(stats));
+    stats_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+esp_err_t ShotRecorder::init()
+{
+    // Time column, then one column per channel
+    size_t frame_bytes = sizeof(uint32_t) + SHOT_CHANNEL_COUNT * sizeof(int16_t);
+    size_t bytes       = SHOT_RECORDER_MAX_FRAMES * frame_bytes;
+    uint8_t *block     = (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (!block) {
+        ESP_LOGE(TAG, "Failed to allocate %u byte capture buffer", (unsigned)bytes);
+        return ESP_ERR_NO_MEM;
+    }
+    times = (uint32_t *)block;
+    for (int c = 0; c < SHOT_CHANNEL_COUNT; c++) {
+        columns[c] = (int16_t *)(block + SHOT_RECORDER_MAX_FRAMES * sizeof(uint32_t)) +
+                     c * SHOT_RECORDER_MAX_FRAMES;
+    }
+
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path              = SHOT_RECORDER_MOUNT,
+        .partition_label        = SHOT_RECORDER_PARTITION,
+        .max_files              = 2,
+        .format_if_mount_failed = true,
+    };
+    esp_err_t err = esp_vfs_spiffs_register(&conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mount shot partition: %s", esp_err_to_name(err));
+        heap_caps_free(block);
+        times = nullptr;
+        return err;
+    }
+
+    shot_index = scanIndex();
+
+    BaseType_t ret = xTaskCreatePinnedToCore(taskEntry,
+                                             "recorder",
+                                             SHOT_RECORDER_TASK_STACK,
+                                             this,
+                                             SHOT_RECORDER_TASK_PRIORITY,
+                                             &task_handle,
+                                             SHOT_RECORDER_TASK_CORE);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create recorder task");
+        return ESP_FAIL;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = timerCallback,
+        .arg      = this,
+        .name     = "recorder",
+    };
+    err = esp_timer_create(&timer_args, &sample_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_start_periodic(sample_timer, SHOT_RECORDER_SAMPLE_US);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sampling timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    size_t total = 0, used = 0;
+    esp_spiffs_info(SHOT_RECORDER_PARTITION, &total, &used);
+    ESP_LOGI(TAG,
+             "Recorder ready: %u byte capture buffer, %u/%u flash bytes used, next shot %u",
+             (unsigned)bytes,
+             (unsigned)used,
+             (unsigned)total,
+             (unsigned)shot_index);
+
+    initialized = true;
+    return ESP_OK;
+}
+
+void ShotRecorder::capture(const shot_sample_t *sample)
+{
+    if (!initialized || sample == nullptr) {
+        return;
+    }
+
+    int64_t entry_us = esp_timer_get_time();
+    latest.publish(*sample);
+
+    // This cycle's work is done: let the commit task write its next chunk now
+    if (state.load(std::memory_order_acquire) == COMMITTING) {
+        xTaskNotifyGive(task_handle);
+    }
+
+    uint32_t capture_us = (uint32_t)(esp_timer_get_time() - entry_us);
+    portENTER_CRITICAL(&stats_lock);
+    if (capture_us > stats.max_capture_us) {
+        stats.max_capture_us = capture_us;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void ShotRecorder::timerCallback(void *arg)
+{
+    static_cast<ShotRecorder *>(arg)->sample();
+}
+
+// Take one frame (sampling timer only)
+void ShotRecorder::sample()
+{
+    shot_sample_t cycle;
+    if (latest.read(cycle) == 0) {
+        return;  // No control cycle yet
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    int current    = state.load(std::memory_order_acquire);
+
+    if (!cycle.extracting && current != RECORDING) {
+        skipping = false;
+    }
+
+    if (current == COMMITTING) {
+        if (cycle.extracting && !skipping) {
+            skipping = true;
+            portENTER_CRITICAL(&stats_lock);
+            stats.shots_skipped++;
+            portEXIT_CRITICAL(&stats_lock);
+            ESP_LOGW(TAG, "Previous shot still being written, not recording this one");
+        }
+        return;
+    }
+
+    uint32_t pulses1 = __atomic_load_n(&HardwareControl::flow_meter1_count, __ATOMIC_RELAXED);
+    uint32_t pulses2 = __atomic_load_n(&HardwareControl::flow_meter2_count, __ATOMIC_RELAXED);
+
+    if (current == IDLE) {
+        if (!cycle.extracting || skipping) {
+            return;
+        }
+        frame_count     = 0;
+        start_us        = now_us;
+        idle_since_us   = 0;
+        extracted_ms    = 0;
+        start_pulses[0] = pulses1;
+        start_pulses[1] = pulses2;
+        state.store(RECORDING, std::memory_order_relaxed);
+    }
+
+    // Fresh readings of the fast channels; the thermocouple is left to the control loop
+    cycle.values[SHOT_CH_PRESSURE] = sensor_read_pressure();
+    cycle.values[SHOT_CH_VOLUME1]  = (pulses1 - start_pulses[0]) / FLOW_METER_PULSES_PER_ML;
+    cycle.values[SHOT_CH_VOLUME2]  = (pulses2 - start_pulses[1]) / FLOW_METER_PULSES_PER_ML;
+    append(cycle.values, now_us);
+
+    if (cycle.extracting) {
+        idle_since_us = 0;
+        extracted_ms  = times[frame_count - 1];
+    }
+    else if (idle_since_us == 0) {
+        idle_since_us = now_us;
+    }
+
+    bool full    = frame_count >= SHOT_RECORDER_MAX_FRAMES;
+    bool stopped = idle_since_us != 0 &&
+                   now_us - idle_since_us >= SHOT_RECORDER_END_HOLD_MS * 1000LL;
+    if (full || stopped) {
+        // A shot still running when the buffer fills is not restarted mid-way
+        skipping = full && cycle.extracting;
+        finish();
+    }
+
+    uint32_t sample_us = (uint32_t)(esp_timer_get_time() - now_us);
+    portENTER_CRITICAL(&stats_lock);
+    if (sample_us > stats.max_sample_us) {
+        stats.max_sample_us = sample_us;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void ShotRecorder::append(const float *values, int64_t now_us)
+{
+    uint32_t n = frame_count;
+    times[n]   = (uint32_t)((now_us - start_us) / 1000);
+    for (int c = 0; c < SHOT_CHANNEL_COUNT; c++) {
+        columns[c][n] = shot_file_to_raw(values[c], (shot_channel_t)c);
+    }
+    frame_count = n + 1;
+}
+
+void ShotRecorder::finish()
+{
+    if (extracted_ms < SHOT_RECORDER_MIN_MS) {
+        portENTER_CRITICAL(&stats_lock);
+        stats.shots_discarded++;
+        portEXIT_CRITICAL(&stats_lock);
+        state.store(IDLE, std::memory_order_relaxed);
+        return;
+    }
+
+    // Hand the columns over to the commit task
+    state.store(COMMITTING, std::memory_order_release);
+    xTaskNotifyGive(task_handle);
+}
+
+void ShotRecorder::taskEntry(void *arg)
+{
+    ShotRecorder *self = static_cast<ShotRecorder *>(arg);
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (self->state.load(std::memory_order_acquire) == COMMITTING) {
+            self->commit();
+        }
+    }
+}
+
+// Write size bytes, one SHOT_RECORDER_CHUNK_BYTES chunk per control cycle
+bool ShotRecorder::writeChunked(int fd, const void *data, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (size > 0) {
+        size_t n = size < SHOT_RECORDER_CHUNK_BYTES ? size : SHOT_RECORDER_CHUNK_BYTES;
+        if (write(fd, p, n) != (ssize_t)n) {
+            return false;
+        }
+        p += n;
+        size -= n;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SHOT_RECORDER_PACE_MS));
+    }
+    return true;
+}
+
+// Delete the oldest shots until size bytes fit with SHOT_RECORDER_SPARE_BYTES to spare
+bool ShotRecorder::makeRoom(size_t size)
+{
+    while (1) {
+        size_t total = 0, used = 0;
+        if (esp_spiffs_info(SHOT_RECORDER_PARTITION, &total, &used) != ESP_OK) {
+            return false;
+        }
+        if (used + size + SHOT_RECORDER_SPARE_BYTES <= total) {
+            return true;
+        }
+
+        uint32_t oldest;
+        if (!oldestShot(&oldest)) {
+            ESP_LOGE(TAG, "%u byte shot does not fit the shot partition", (unsigned)size);
+            return false;
+        }
+        char path[32];
+        snprintf(path, sizeof(path), SHOT_RECORDER_MOUNT "/shot_%04u.bin", (unsigned)oldest);
+        if (unlink(path) != 0) {
+            return false;
+        }
+        ESP_LOGI(TAG, "Deleted shot %u to make room", (unsigned)oldest);
+    }
+}
+
+void ShotRecorder::commit()
+{
+    int64_t commit_start_us = esp_timer_get_time();
+    uint32_t frames         = frame_count;
+
+    char path[32];
+    snprintf(path, sizeof(path), SHOT_RECORDER_MOUNT "/shot_%04u.bin", (unsigned)shot_index);
+
+    shot_file_header_t header;
+    shot_file_section_t sections[SHOT_FILE_SECTIONS];
+    shot_file_header(&header, frames, shot_index, (uint32_t)(start_us / 1000));
+    size_t bytes = shot_file_sections(&header, times, columns, sections);
+
+    bool ok = false;
+    int fd  = makeRoom(bytes) ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if (fd >= 0) {
+        ok = true;
+        for (int s = 0; ok && s < SHOT_FILE_SECTIONS; s++) {
+            if (sections[s].bulk) {
+                ok = writeChunked(fd, sections[s].data, sections[s].size);
+            }
+            else {
+                ok = write(fd, sections[s].data, sections[s].size) == (ssize_t)sections[s].size;
+            }
+        }
+        ok = close(fd) == 0 && ok;
+    }
+
+    if (ok) {
+        uint32_t commit_ms = (uint32_t)((esp_timer_get_time() - commit_start_us) / 1000);
+        portENTER_CRITICAL(&stats_lock);
+        stats.shots_committed++;
+        stats.last_frames    = frames;
+        stats.last_bytes     = bytes;
+        stats.last_commit_ms = commit_ms;
+
+        uint32_t capture_max = stats.max_capture_us;
+        uint32_t sample_max  = stats.max_sample_us;
+        portEXIT_CRITICAL(&stats_lock);
+        ESP_LOGI(TAG,
+                 "Shot %u: %u frames over %u ms written to %s (%u bytes) in %u ms, "
+                 "capture max %u us, frame max %u us",
+                 (unsigned)shot_index,
+                 (unsigned)frames,
+                 (unsigned)times[frames - 1],
+                 path,
+                 (unsigned)bytes,
+                 (unsigned)commit_ms,
+                 (unsigned)capture_max,
+                 (unsigned)sample_max);
+
+        // Keep the newest SHOT_RECORDER_MAX_FILES shots
+        if (shot_index >= SHOT_RECORDER_MAX_FILES) {
+            snprintf(path,
+                     sizeof(path),
+                     SHOT_RECORDER_MOUNT "/shot_%04u.bin",
+                     (unsigned)(shot_index - SHOT_RECORDER_MAX_FILES));
+            unlink(path);
+        }
+        shot_index++;
+    }
+    else {
+        portENTER_CRITICAL(&stats_lock);
+        stats.commit_errors++;
+        portEXIT_CRITICAL(&stats_lock);
+        ESP_LOGE(TAG, "Failed to write %s", path);
+        if (fd >= 0) {
+            unlink(path);
+        }
+    }
+
+    state.store(IDLE, std::memory_order_release);
+}
+
+// Index after the newest shot on the partition
+uint32_t ShotRecorder::scanIndex()
+{
+    uint32_t next = 0;
+    DIR *dir      = opendir(SHOT_RECORDER_MOUNT);
+    if (!dir) {
+        return 0;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        unsigned index;
+        if (sscanf(entry->d_name, "shot_%u.bin", &index) == 1 && index + 1 > next) {
+            next = index + 1;
+        }
+    }
+    closedir(dir);
+    return next;
+}
+
+// Index of the oldest shot on the partition
+bool ShotRecorder::oldestShot(uint32_t *index)
+{
+    bool found = false;
+    DIR *dir   = opendir(SHOT_RECORDER_MOUNT);
+    if (!dir) {
+        return false;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        unsigned n;
+        if (sscanf(entry->d_name, "shot_%u.bin", &n) == 1 && (!found || n < *index)) {
+            *index = n;
+            found  = true;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+void ShotRecorder::getStats(shot_recorder_stats_t *out) const
+{
+    if (out) {
+        portENTER_CRITICAL(&stats_lock);
+        *out = stats;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+}
+
+// C compatibility wrappers
+extern "C" {
+
+esp_err_t shot_recorder_init(void)
+{
+    return shot_recorder.init();
+}
+
+void shot_recorder_capture(const shot_sample_t *sample)
+{
+    shot_recorder.capture(sample);
+}
+
+void shot_recorder_get_stats(shot_recorder_stats_t *out)
+{
+    shot_recorder.getStats(out);
+}
+
+}  // extern "C"
@@ -0,0 +1,339 @@
+#include "safety/safety_interlock.h"
+
+#include <cstring>
+
+#include "esp_log.h"
+#include "hardware/hardware_control.h"
+
+static const char *TAG = "SAFETY";
+
+static const char *RULE_NAMES[] = {
+    "over-temperature", "sensor fault", "sensor stale", "over-pressure", "dry-run"};
+
+// Default rule table
+static const safety_rule_t DEFAULT_RULES[] = {
+    {SAFETY_RULE_OVER_TEMPERATURE, SAFETY_MAX_TEMPERATURE, 0, SAFETY_ACTION_SSR_OFF},
+    {SAFETY_RULE_SENSOR_FAULT, 0.0f, SAFETY_SENSOR_FAULT_HOLD_MS, SAFETY_ACTION_HEATER_OFF},
+    {SAFETY_RULE_SENSOR_STALE, SAFETY_STALE_TIMEOUT_MS, 0, SAFETY_ACTION_HEATER_OFF},
+    {SAFETY_RULE_OVER_PRESSURE, SAFETY_MAX_PRESSURE, 0, SAFETY_ACTION_ALL_OFF},
+    {SAFETY_RULE_DRY_RUN, SAFETY_DRY_RUN_FLOW, SAFETY_DRY_RUN_HOLD_MS, SAFETY_ACTION_ALL_OFF},
+};
+
+// Global instance
+SafetyInterlock safety_interlock;
+
+// SafetyInterlock implementation
+SafetyInterlock::SafetyInterlock()
+    : rule_count(0),
+      tripped(false),
+      active_actions(0),
+      reset_done(nullptr),
+      reset_blocker(-1),
+      task_handle(nullptr),
+      eval_timer(nullptr),
+      initialized(false)
+{
+    memset(rules, 0, sizeof(rules));
+    memset(violation_since_us, 0, sizeof(violation_since_us));
+    memset(&snapshot, 0, sizeof(snapshot));
+    memset(&stats, 0, sizeof(stats));
+    stats.last_trip_rule = -1;
+    snapshot_lock        = portMUX_INITIALIZER_UNLOCKED;
+    stats_lock           = portMUX_INITIALIZER_UNLOCKED;
+}
+
+esp_err_t SafetyInterlock::init()
+{
+    ESP_LOGI(TAG,
+             "Initializing safety interlock (period %d us, bound %d us)",
+             SAFETY_EVAL_PERIOD_US,
+             SAFETY_REACTION_BOUND_US);
+
+    setRules(DEFAULT_RULES, sizeof(DEFAULT_RULES) / sizeof(DEFAULT_RULES[0]));
+
+    // Treat boot as the last valid reading so the stale rule has a reference point
+    snapshot.last_valid_us = esp_timer_get_time();
+    snapshot.sample_us     = snapshot.last_valid_us;
+
+    reset_done = xSemaphoreCreateBinary();
+    if (!reset_done) {
+        ESP_LOGE(TAG, "Failed to create reset semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t ret = xTaskCreatePinnedToCore(taskEntry,
+                                             "safety",
+                                             SAFETY_TASK_STACK,
+                                             this,
+                                             SAFETY_TASK_PRIORITY,
+                                             &task_handle,
+                                             SAFETY_TASK_CORE);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create safety task");
+        return ESP_FAIL;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = timerCallback,
+        .arg      = this,
+        .name     = "safety",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &eval_timer);
+    if (err == ESP_OK) {
+        err = esp_timer_start_periodic(eval_timer, SAFETY_EVAL_PERIOD_US);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start safety timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t SafetyInterlock::setRules(const safety_rule_t *new_rules, int count)
+{
+    if (new_rules == nullptr || count < 0 || count > SAFETY_MAX_RULES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&snapshot_lock);
+    memcpy(rules, new_rules, count * sizeof(safety_rule_t));
+    memset(violation_since_us, 0, sizeof(violation_since_us));
+    rule_count = count;
+    portEXIT_CRITICAL(&snapshot_lock);
+
+    ESP_LOGI(TAG, "Loaded %d interlock rules", count);
+    return ESP_OK;
+}
+
+void SafetyInterlock::publish(const sensor_data_t *data, bool pump_running)
+{
+    if (data == nullptr) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&snapshot_lock);
+    snapshot.temperature  = data->temperature;
+    snapshot.pressure     = data->pressure;
+    snapshot.flow_rate    = data->flow_rate1;
+    snapshot.dimmer_level = data->dimmer_level;
+    snapshot.pump_running = pump_running;
+    snapshot.sample_us    = now_us;
+    if (data->temperature >= 0.0f) {
+        snapshot.last_valid_us = now_us;
+    }
+    portEXIT_CRITICAL(&snapshot_lock);
+
+    // Evaluate right away instead of waiting for the next timer period
+    if (task_handle) {
+        xTaskNotify(task_handle, SAFETY_NOTIFY_EVALUATE, eSetBits);
+    }
+}
+
+bool SafetyInterlock::reset()
+{
+    if (!initialized) {
+        return false;
+    }
+
+    // Drop the answer to an earlier request that timed out, then ask the interlock task
+    xSemaphoreTake(reset_done, 0);
+    xTaskNotify(task_handle, SAFETY_NOTIFY_RESET, eSetBits);
+    if (xSemaphoreTake(reset_done, pdMS_TO_TICKS(SAFETY_RESET_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Interlock task did not answer the reset request");
+        return false;
+    }
+
+    // Log here rather than on the interlock task, so logging never delays a trip
+    int blocker = reset_blocker;
+    if (blocker >= 0) {
+        ESP_LOGW(TAG, "Cannot reset interlock, %s still active", RULE_NAMES[rules[blocker].type]);
+        return false;
+    }
+    ESP_LOGI(TAG, "Safety interlock reset");
+    return true;
+}
+
+int SafetyInterlock::applyReset()
+{
+    Snapshot snap;
+    portENTER_CRITICAL(&snapshot_lock);
+    snap = snapshot;
+    portEXIT_CRITICAL(&snapshot_lock);
+
+    int64_t now_us = esp_timer_get_time();
+    for (int i = 0; i < rule_count; i++) {
+        if (checkRule(rules[i], snap, now_us) != 0) {
+            return i;
+        }
+    }
+
+    memset(violation_since_us, 0, sizeof(violation_since_us));
+    active_actions = 0;
+    tripped        = false;
+    hw.clearSafetyLockout();
+    return -1;
+}
+
+void SafetyInterlock::getStats(safety_stats_t *out) const
+{
+    if (out) {
+        portENTER_CRITICAL(&stats_lock);
+        *out = stats;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+}
+
+void SafetyInterlock::taskEntry(void *arg)
+{
+    SafetyInterlock *self = static_cast<SafetyInterlock *>(arg);
+
+    while (1) {
+        // Woken by the periodic timer, by publish() or by a reset request
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+
+        // Evaluate first, so a reset never clears a trip this pass would have made
+        self->evaluate();
+        if (bits & SAFETY_NOTIFY_RESET) {
+            self->reset_blocker = self->applyReset();
+            xSemaphoreGive(self->reset_done);
+        }
+    }
+}
+
+void SafetyInterlock::timerCallback(void *arg)
+{
+    SafetyInterlock *self = static_cast<SafetyInterlock *>(arg);
+    xTaskNotify(self->task_handle, SAFETY_NOTIFY_EVALUATE, eSetBits);
+}
+
+int64_t SafetyInterlock::checkRule(const safety_rule_t &rule,
+                                   const Snapshot &snap,
+                                   int64_t now_us) const
+{
+    switch (rule.type) {
+        case SAFETY_RULE_OVER_TEMPERATURE:
+            return snap.temperature > rule.threshold ? snap.sample_us : 0;
+        case SAFETY_RULE_SENSOR_FAULT:
+            return snap.temperature < 0.0f ? snap.sample_us : 0;
+        case SAFETY_RULE_SENSOR_STALE: {
+            // Onset is the moment the last valid reading became too old
+            int64_t deadline_us = snap.last_valid_us + (int64_t)rule.threshold * 1000;
+            return now_us > deadline_us ? deadline_us : 0;
+        }
+        case SAFETY_RULE_OVER_PRESSURE:
+            return snap.pressure > rule.threshold ? snap.sample_us : 0;
+        case SAFETY_RULE_DRY_RUN:
+            return (snap.pump_running && snap.dimmer_level > 0 && snap.flow_rate <= rule.threshold)
+                       ? snap.sample_us
+                       : 0;
+    }
+    return 0;
+}
+
+void SafetyInterlock::evaluate()
+{
+    int64_t start_us = esp_timer_get_time();
+
+    Snapshot snap;
+    portENTER_CRITICAL(&snapshot_lock);
+    snap = snapshot;
+    portEXIT_CRITICAL(&snapshot_lock);
+
+    for (int i = 0; i < rule_count; i++) {
+        int64_t onset_us = checkRule(rules[i], snap, start_us);
+        if (onset_us == 0) {
+            violation_since_us[i] = 0;
+            continue;
+        }
+
+        if (violation_since_us[i] == 0) {
+            violation_since_us[i] = onset_us;
+        }
+
+        // Trip once per action set; the hardware lockout keeps outputs safe afterwards
+        int64_t deadline_us = violation_since_us[i] + (int64_t)rules[i].hold_ms * 1000;
+        if (start_us >= deadline_us && (active_actions & rules[i].actions) != rules[i].actions) {
+            trip(i, deadline_us);
+        }
+    }
+
+    int64_t eval_us = esp_timer_get_time() - start_us;
+    if (eval_us > stats.max_eval_us) {
+        portENTER_CRITICAL(&stats_lock);
+        stats.max_eval_us = eval_us;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+}
+
+void SafetyInterlock::trip(int rule_index, int64_t deadline_us)
+{
+    const safety_rule_t &rule = rules[rule_index];
+
+    uint32_t ssr_mask = 0;
+    if (rule.actions & SAFETY_ACTION_HEATER_OFF) {
+        ssr_mask |= 1u << 0;
+    }
+    if (rule.actions & SAFETY_ACTION_SSR_OFF) {
+        ssr_mask |= (1u << SSR_COUNT) - 1;
+    }
+    hw.forceSafe(ssr_mask, (rule.actions & SAFETY_ACTION_PUMP_OFF) != 0);
+
+    // Reaction time: from the moment the rule demanded a trip to actuators safe
+    int64_t reaction_us = esp_timer_get_time() - deadline_us;
+
+    active_actions |= rule.actions;
+    tripped = true;
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.trip_count++;
+    stats.last_trip_rule   = rule_index;
+    stats.last_reaction_us = reaction_us;
+    if (reaction_us > stats.max_reaction_us) {
+        stats.max_reaction_us = reaction_us;
+    }
+    if (reaction_us > SAFETY_REACTION_BOUND_US) {
+        stats.bound_violations++;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+
+    // Log after the outputs are safe so logging never delays the reaction
+    ESP_LOGE(TAG, "Interlock tripped: %s (reaction %lld us)", RULE_NAMES[rule.type], reaction_us);
+    if (reaction_us > SAFETY_REACTION_BOUND_US) {
+        ESP_LOGW(TAG, "Reaction bound of %d us exceeded", SAFETY_REACTION_BOUND_US);
+    }
+}
+
+// C compatibility wrappers
+extern "C" {
+
+esp_err_t safety_interlock_init(void)
+{
+    return safety_interlock.init();
+}
+
+void safety_interlock_publish(const sensor_data_t *data, bool pump_running)
+{
+    safety_interlock.publish(data, pump_running);
+}
+
+bool safety_interlock_reset(void)
+{
+    return safety_interlock.reset();
+}
+
+bool safety_interlock_is_tripped(void)
+{
+    return safety_interlock.isTripped();
+}
+
+void safety_interlock_get_stats(safety_stats_t *out)
+{
+    safety_interlock.getStats(out);
+}
+
+}  // extern "C"
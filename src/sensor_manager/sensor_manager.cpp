@@ -1,23 +1,27 @@
 #include "sensor_manager/sensor_manager.h"
 
 #include <cstring>
+#include "common/fixed_format.h"
 #include "driver/adc.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "hardware/hardware_control.h"
-
-// Forward declarations of ISR functions defined in hardware_control.cpp
-extern "C" void IRAM_ATTR flow_meter1_isr(void* arg);
-extern "C" void IRAM_ATTR flow_meter2_isr(void* arg);
+#include "spi_bus/spi_bus_manager.h"
 
 static const char* TAG = "SENSOR_MGR";
 
+// Layout of the logged readings
+static const fixed_format_t temperature_format = {2, 0, "°C"};
+static const fixed_format_t pressure_format    = {2, 0, " PSI"};
+static const fixed_format_t flow_format        = {2, 0, " mL/min"};
+
 // Global instance
 SensorManager sensor_manager;
 
 // SensorHistory implementation
 SensorHistory::SensorHistory()
-    : write_index(0), last_update_time(0), update_interval_ms(1000)
+    : write_index(0), sample_count(0), last_update_time(0), update_interval_ms(1000)
 {
     reset();
 }
@@ -31,12 +35,26 @@ void SensorHistory::reset()
         flow_rate2[i] = 0.0f;
     }
     write_index = 0;
+    sample_count = 0;
     last_update_time = 0;
 }
 
+HistoryView SensorHistory::view(const float* channel, uint32_t samples) const
+{
+    // Sample n is stored at n % SENSOR_HISTORY_LENGTH; the slot of sample samples may be
+    // written at any time, so at most SENSOR_HISTORY_LENGTH - 1 samples are visible
+    uint32_t count = samples < SENSOR_HISTORY_LENGTH - 1 ? samples : SENSOR_HISTORY_LENGTH - 1;
+    return HistoryView(channel, (int)((samples - count) % SENSOR_HISTORY_LENGTH), (int)count);
+}
+
 // SensorManager implementation
 SensorManager::SensorManager()
-    : max6675_spi(nullptr), initialized(false)
+    : max6675_spi(nullptr),
+      max6675_bus_id(SPI_BUS_INVALID_DEVICE),
+      initialized(false),
+      last_flow_count{},
+      last_flow_us(0),
+      last_flow_rate{}
 {
 }
 
@@ -44,6 +62,10 @@ esp_err_t SensorManager::init(spi_device_handle_t spi_handle)
 {
     ESP_LOGI(TAG, "Initializing sensor manager");
     max6675_spi = spi_handle;
+    max6675_bus_id = spi_bus_manager.findDevice(spi_handle);
+    if (max6675_bus_id == SPI_BUS_INVALID_DEVICE) {
+        ESP_LOGW(TAG, "MAX6675 not registered with the SPI bus manager");
+    }
     initialized = true;
     return ESP_OK;
 }
@@ -57,7 +79,11 @@ float SensorManager::readTemperature()
         .flags = SPI_TRANS_USE_RXDATA,
     };
 
-    if (spi_device_polling_transmit(max6675_spi, &t) != ESP_OK) {
+    // Through the bus manager, which accounts the read in the SPI utilization log
+    esp_err_t ret = (max6675_bus_id != SPI_BUS_INVALID_DEVICE)
+                        ? spi_bus_manager.transmit(max6675_bus_id, &t)
+                        : spi_device_polling_transmit(max6675_spi, &t);
+    if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Error reading MAX6675");
         return -1.0;
     }
@@ -94,30 +120,28 @@ float SensorManager::readPressure()
 
 void SensorManager::calculateFlowRates(float* flow1, float* flow2)
 {
-    // These conversion factors depend on your specific flow meters
-    // Typically it's pulses per liter, so adjust as needed
-    const float FLOW_FACTOR1 = 5.5;  // Example: 5.5 pulses per mL
-    const float FLOW_FACTOR2 = 5.5;  // Example: 5.5 pulses per mL
-
-    // Disable interrupt temporarily
-    gpio_isr_handler_remove(FLOW_METER1_PIN);
-    gpio_isr_handler_remove(FLOW_METER2_PIN);
-
-    // Read pulse counts
-    uint32_t count1 = HardwareControl::flow_meter1_count;
-    uint32_t count2 = HardwareControl::flow_meter2_count;
-
-    // Reset counters
-    HardwareControl::flow_meter1_count = 0;
-    HardwareControl::flow_meter2_count = 0;
-
-    // Re-enable interrupt
-    gpio_isr_handler_add(FLOW_METER1_PIN, flow_meter1_isr, NULL);
-    gpio_isr_handler_add(FLOW_METER2_PIN, flow_meter2_isr, NULL);
+    int64_t now_us     = esp_timer_get_time();
+    int64_t elapsed_us = now_us - last_flow_us;
+
+    if (elapsed_us >= SENSOR_FLOW_WINDOW_MS * 1000LL) {
+        // Pulses since the previous window. The counters run freely, so the shot recorder
+        // can read them too, and the interrupts stay enabled, so no pulse is lost.
+        uint32_t total1 = __atomic_load_n(&HardwareControl::flow_meter1_count, __ATOMIC_RELAXED);
+        uint32_t total2 = __atomic_load_n(&HardwareControl::flow_meter2_count, __ATOMIC_RELAXED);
+
+        // The first call only starts the window
+        if (last_flow_us != 0) {
+            float ml_min_per_pulse = 60e6f / (FLOW_METER_PULSES_PER_ML * (float)elapsed_us);
+            last_flow_rate[0]      = (total1 - last_flow_count[0]) * ml_min_per_pulse;
+            last_flow_rate[1]      = (total2 - last_flow_count[1]) * ml_min_per_pulse;
+        }
+        last_flow_count[0] = total1;
+        last_flow_count[1] = total2;
+        last_flow_us       = now_us;
+    }
 
-    // Calculate flow rates (mL/min) assuming measurements over 1 second
-    *flow1 = (count1 / FLOW_FACTOR1) * 60.0;
-    *flow2 = (count2 / FLOW_FACTOR2) * 60.0;
+    *flow1 = last_flow_rate[0];
+    *flow2 = last_flow_rate[1];
 }
 
 void SensorManager::readAll(sensor_data_t* data)
@@ -136,11 +160,21 @@ void SensorManager::readAll(sensor_data_t* data)
     // Calculate flow rates
     calculateFlowRates(&data->flow_rate1, &data->flow_rate2);
 
-    // Log sensor readings
-    ESP_LOGI(TAG, "Temperature: %.2f°C", data->temperature);
-    ESP_LOGI(TAG, "Pressure: %.2f PSI", data->pressure);
-    ESP_LOGI(TAG, "Flow rate 1: %.2f mL/min", data->flow_rate1);
-    ESP_LOGI(TAG, "Flow rate 2: %.2f mL/min", data->flow_rate2);
+    // Log sensor readings at debug level only: this runs every control cycle, and a
+    // blocking log write would delay the actuators. Formatted without printf's float
+    // conversion.
+    if (esp_log_level_get(TAG) < ESP_LOG_DEBUG) {
+        return;
+    }
+    char text[FIXED_FORMAT_MAX_CHARS];
+    fixed_format_float(text, sizeof(text), data->temperature, &temperature_format);
+    ESP_LOGD(TAG, "Temperature: %s", text);
+    fixed_format_float(text, sizeof(text), data->pressure, &pressure_format);
+    ESP_LOGD(TAG, "Pressure: %s", text);
+    fixed_format_float(text, sizeof(text), data->flow_rate1, &flow_format);
+    ESP_LOGD(TAG, "Flow rate 1: %s", text);
+    fixed_format_float(text, sizeof(text), data->flow_rate2, &flow_format);
+    ESP_LOGD(TAG, "Flow rate 2: %s", text);
 }
 
 void SensorManager::updateHistory(const sensor_data_t* data, uint32_t current_time)
@@ -159,6 +193,7 @@ void SensorManager::updateHistory(const sensor_data_t* data, uint32_t current_ti
 
         // Move to next index, wrapping around if needed
         sensor_history.write_index = (sensor_history.write_index + 1) % SENSOR_HISTORY_LENGTH;
+        sensor_history.sample_count++;
 
         // Update timestamp
         sensor_history.last_update_time = current_time;
@@ -0,0 +1,336 @@
+#include "spi_bus/spi_bus_manager.h"
+
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "hardware/gpio_claims.h"
+
+static const char *TAG = "SPI_BUS";
+
+static const char *HOST_NAMES[SPI_BUS_HOST_COUNT] = {"SPI1 bus", "SPI2 bus", "SPI3 bus"};
+
+// Global instance
+SpiBusManager spi_bus_manager;
+
+static void release_pins(const int *pins, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        gpio_claims.release(pins[i]);
+    }
+}
+
+// SpiBusManager implementation
+SpiBusManager::SpiBusManager() : window_start_us(0)
+{
+    memset(devices, 0, sizeof(devices));
+    memset(hosts, 0, sizeof(hosts));
+    lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+esp_err_t SpiBusManager::initHost(spi_host_device_t host,
+                                  const spi_bus_config_t *config,
+                                  spi_dma_chan_t dma_chan)
+{
+    if (host >= SPI_BUS_HOST_COUNT || config == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Host &h = hosts[host];
+    if (h.initialized) {
+        // Shared host: a device on other pins would never see its transfers
+        if (h.config.sclk_io_num != config->sclk_io_num ||
+            h.config.mosi_io_num != config->mosi_io_num ||
+            h.config.miso_io_num != config->miso_io_num) {
+            ESP_LOGE(TAG, "SPI host %d already initialized with different pins", host);
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (config->max_transfer_sz > h.config.max_transfer_sz) {
+            ESP_LOGW(TAG,
+                     "SPI host %d max transfer %d < requested %d",
+                     host,
+                     h.config.max_transfer_sz,
+                     config->max_transfer_sz);
+        }
+        return ESP_OK;
+    }
+
+    const int pins[]       = {config->sclk_io_num, config->mosi_io_num, config->miso_io_num};
+    const size_t pin_count = sizeof(pins) / sizeof(pins[0]);
+    esp_err_t ret          = gpio_claims.claimAll(pins, pin_count, HOST_NAMES[host]);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    h.mutex = xSemaphoreCreateMutex();
+    if (h.mutex == nullptr) {
+        release_pins(pins, pin_count);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ret = spi_bus_initialize(host, config, dma_chan);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize SPI host %d: %s", host, esp_err_to_name(ret));
+        vSemaphoreDelete(h.mutex);
+        h.mutex = nullptr;
+        release_pins(pins, pin_count);
+        return ret;
+    }
+
+    h.initialized = true;
+    h.config      = *config;
+    if (window_start_us == 0) {
+        window_start_us = esp_timer_get_time();
+    }
+
+    ESP_LOGI(TAG, "SPI host %d initialized", host);
+    return ESP_OK;
+}
+
+esp_err_t SpiBusManager::allocDevice(spi_host_device_t host,
+                                     int cs_pin,
+                                     const char *name,
+                                     int *device_id)
+{
+    if (host >= SPI_BUS_HOST_COUNT || !hosts[host].initialized) {
+        ESP_LOGE(TAG, "SPI host %d not initialized", host);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (int i = 0; i < SPI_BUS_MAX_DEVICES; i++) {
+        if (devices[i].used) {
+            continue;
+        }
+
+        // Two devices on one chip select would both answer every transfer
+        esp_err_t ret = gpio_claims.claim(cs_pin, name);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+
+        Device &dev = devices[i];
+        memset(&dev, 0, sizeof(dev));
+        dev.used       = true;
+        dev.host       = host;
+        dev.cs_pin     = cs_pin;
+        dev.name       = name;
+        dev.stats.name = name;
+        *device_id     = i;
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "No free device slots for %s", name);
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t SpiBusManager::addDevice(spi_host_device_t host,
+                                   const spi_device_interface_config_t *config,
+                                   const char *name,
+                                   int *device_id,
+                                   spi_device_handle_t *handle)
+{
+    if (config == nullptr || device_id == nullptr || handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int id;
+    esp_err_t ret = allocDevice(host, config->spics_io_num, name, &id);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    ret = spi_bus_add_device(host, config, handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add %s: %s", name, esp_err_to_name(ret));
+        gpio_claims.release(devices[id].cs_pin);
+        devices[id].used = false;
+        return ret;
+    }
+
+    devices[id].handle = *handle;
+    *device_id         = id;
+
+    ESP_LOGI(TAG, "Added %s on host %d", name, host);
+    return ESP_OK;
+}
+
+int SpiBusManager::registerDevice(spi_host_device_t host, int cs_pin, const char *name)
+{
+    int id;
+    if (allocDevice(host, cs_pin, name, &id) != ESP_OK) {
+        return SPI_BUS_INVALID_DEVICE;
+    }
+
+    ESP_LOGI(TAG, "Registered %s on host %d", name, host);
+    return id;
+}
+
+void SpiBusManager::removeDevice(int device_id)
+{
+    if (!validDevice(device_id)) {
+        return;
+    }
+
+    Device &dev = devices[device_id];
+    if (dev.handle) {
+        spi_bus_remove_device(dev.handle);
+    }
+    gpio_claims.release(dev.cs_pin);
+    dev.used = false;
+}
+
+int SpiBusManager::findDevice(spi_device_handle_t handle) const
+{
+    for (int i = 0; i < SPI_BUS_MAX_DEVICES; i++) {
+        if (devices[i].used && devices[i].handle == handle) {
+            return i;
+        }
+    }
+    return SPI_BUS_INVALID_DEVICE;
+}
+
+bool SpiBusManager::validDevice(int device_id) const
+{
+    return device_id >= 0 && device_id < SPI_BUS_MAX_DEVICES && devices[device_id].used;
+}
+
+esp_err_t SpiBusManager::acquire(int device_id, TickType_t timeout)
+{
+    if (!validDevice(device_id)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Device &dev    = devices[device_id];
+    int64_t now_us = esp_timer_get_time();
+
+    if (xSemaphoreTake(hosts[dev.host].mutex, timeout) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    int64_t acquired_us = esp_timer_get_time();
+    uint32_t wait_us    = (uint32_t)(acquired_us - now_us);
+
+    // logStats() reads and resets the statistics from another task
+    portENTER_CRITICAL(&lock);
+    dev.acquired_us = acquired_us;
+    dev.stats.transactions++;
+    dev.stats.wait_us_total += wait_us;
+    if (wait_us > dev.stats.wait_us_max) {
+        dev.stats.wait_us_max = wait_us;
+    }
+    portEXIT_CRITICAL(&lock);
+    return ESP_OK;
+}
+
+void SpiBusManager::release(int device_id, size_t bytes)
+{
+    if (!validDevice(device_id)) {
+        return;
+    }
+
+    Device &dev    = devices[device_id];
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lock);
+    dev.stats.busy_us += now_us - dev.acquired_us;
+    dev.stats.bytes += bytes;
+    portEXIT_CRITICAL(&lock);
+
+    xSemaphoreGive(hosts[dev.host].mutex);
+}
+
+esp_err_t SpiBusManager::transmit(int device_id, spi_transaction_t *trans)
+{
+    if (!validDevice(device_id) || trans == nullptr || devices[device_id].handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = acquire(device_id, portMAX_DELAY);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = spi_device_polling_transmit(devices[device_id].handle, trans);
+    release(device_id, (trans->length + 7) / 8);
+    return ret;
+}
+
+void SpiBusManager::getStats(int device_id, spi_bus_device_stats_t *out)
+{
+    if (!validDevice(device_id) || out == nullptr) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lock);
+    int64_t window_us = now_us - window_start_us;
+    *out              = devices[device_id].stats;
+    portEXIT_CRITICAL(&lock);
+
+    out->utilization = window_us > 0 ? (float)out->busy_us / (float)window_us : 0.0f;
+}
+
+void SpiBusManager::logStats()
+{
+    for (int i = 0; i < SPI_BUS_MAX_DEVICES; i++) {
+        if (!devices[i].used) {
+            continue;
+        }
+
+        spi_bus_device_stats_t s;
+        getStats(i, &s);
+        uint32_t avg_wait_us = s.transactions ? (uint32_t)(s.wait_us_total / s.transactions) : 0;
+        ESP_LOGI(TAG,
+                 "%s: util %.1f%%, %u grants, %llu bytes, wait avg %u us max %u us",
+                 s.name,
+                 s.utilization * 100.0f,
+                 s.transactions,
+                 s.bytes,
+                 avg_wait_us,
+                 s.wait_us_max);
+
+        // Start a new statistics window
+        portENTER_CRITICAL(&lock);
+        const char *name = devices[i].stats.name;
+        memset(&devices[i].stats, 0, sizeof(spi_bus_device_stats_t));
+        devices[i].stats.name = name;
+        portEXIT_CRITICAL(&lock);
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    window_start_us = now_us;
+    portEXIT_CRITICAL(&lock);
+}
+
+// C compatibility wrappers
+extern "C" {
+
+esp_err_t spi_bus_manager_init_host(spi_host_device_t host,
+                                    const spi_bus_config_t *config,
+                                    spi_dma_chan_t dma_chan)
+{
+    return spi_bus_manager.initHost(host, config, dma_chan);
+}
+
+esp_err_t spi_bus_manager_acquire(int device_id, TickType_t timeout)
+{
+    return spi_bus_manager.acquire(device_id, timeout);
+}
+
+void spi_bus_manager_release(int device_id, size_t bytes)
+{
+    spi_bus_manager.release(device_id, bytes);
+}
+
+esp_err_t spi_bus_manager_transmit(int device_id, spi_transaction_t *trans)
+{
+    return spi_bus_manager.transmit(device_id, trans);
+}
+
+void spi_bus_manager_log_stats(void)
+{
+    spi_bus_manager.logStats();
+}
+
+}  // extern "C"
@@ -0,0 +1,558 @@
+#include "telemetry/telemetry_store.h"
+
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+
+static const char *TAG = "TELEMETRY";
+
+// Wall clock times before this are taken as "not set" (2023-11-14)
+#define TELEMETRY_VALID_EPOCH 1700000000u
+
+static_assert(TELEMETRY_PAGE_RECORDS * sizeof(telemetry_record_t) == TELEMETRY_PAGE_SIZE,
+              "Records must tile the flash page");
+static_assert(sizeof(telemetry_sector_header_t) <= TELEMETRY_PAGE_SIZE, "Header exceeds its page");
+static_assert(TELEMETRY_PAGE_RECORDS <= TELEMETRY_SECTOR_RECORDS, "Page larger than a sector");
+static_assert((TELEMETRY_QUEUE_SIZE & (TELEMETRY_QUEUE_SIZE - 1)) == 0,
+              "Queue size must be a power of two");
+
+// Global instance
+TelemetryStore telemetry_store;
+
+static uint16_t record_crc(const telemetry_record_t &rec)
+{
+    return esp_rom_crc16_le(0, (const uint8_t *)&rec, offsetof(telemetry_record_t, crc));
+}
+
+static uint16_t header_crc(const telemetry_sector_header_t &header)
+{
+    return esp_rom_crc16_le(0, (const uint8_t *)&header, offsetof(telemetry_sector_header_t, crc));
+}
+
+// Flash offset of a record slot; slot 0 starts the second page of the sector
+static inline size_t record_offset(int sector, int slot)
+{
+    return sector * TELEMETRY_SECTOR_SIZE + TELEMETRY_PAGE_SIZE + slot * sizeof(telemetry_record_t);
+}
+
+static bool is_erased(const void *data, size_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline uint32_t clamp_raw(float value, float max)
+{
+    if (!(value > 0.0f)) {
+        return 0;
+    }
+    return value >= max ? (uint32_t)max : (uint32_t)(value + 0.5f);
+}
+
+// TelemetryStore implementation
+TelemetryStore::TelemetryStore()
+    : partition(nullptr),
+      sector_count(0),
+      head_sector(-1),
+      head_records(0),
+      next_sequence(1),
+      last_time(0),
+      time_base(0),
+      page_count(0),
+      page_started_us(0),
+      lock(nullptr),
+      task_handle(nullptr),
+      flush_requested(false),
+      initialized(false)
+{
+    memset(index, 0, sizeof(index));
+    memset(page, 0, sizeof(page));
+    memset(&accumulator, 0, sizeof(accumulator));
+    memset(&stats, 0, sizeof(stats));
+}
+
+esp_err_t TelemetryStore::init()
+{
+    if (initialized) {
+        return ESP_OK;
+    }
+
+    partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, TELEMETRY_PARTITION_SUBTYPE, TELEMETRY_PARTITION_LABEL);
+    if (partition == nullptr) {
+        ESP_LOGW(TAG, "No '%s' partition, telemetry is not stored", TELEMETRY_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    sector_count = partition->size / TELEMETRY_SECTOR_SIZE;
+    if (sector_count > TELEMETRY_MAX_SECTORS) {
+        ESP_LOGW(TAG, "Using %d of %d sectors", TELEMETRY_MAX_SECTORS, sector_count);
+        sector_count = TELEMETRY_MAX_SECTORS;
+    }
+    if (sector_count < 2) {
+        ESP_LOGE(TAG, "Partition too small for a sector ring");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    stats.sectors = sector_count;
+
+    lock = xSemaphoreCreateMutex();
+    if (lock == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    recover();
+
+    // Continue the store clock from the newest record
+    time_base = last_time + 1;
+
+    BaseType_t ret = xTaskCreatePinnedToCore(taskEntry,
+                                             "telemetry",
+                                             TELEMETRY_TASK_STACK,
+                                             this,
+                                             TELEMETRY_TASK_PRIORITY,
+                                             &task_handle,
+                                             TELEMETRY_TASK_CORE);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create telemetry task");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG,
+             "Recovered %d sectors in %u ms: head sector %d with %d records, newest time %u, "
+             "%u torn records",
+             sector_count,
+             (unsigned)((esp_timer_get_time() - start_us) / 1000),
+             head_sector,
+             head_records,
+             (unsigned)last_time,
+             (unsigned)stats.torn_records);
+
+    initialized = true;
+    return ESP_OK;
+}
+
+// Rebuild the index from the sector headers and find the end of the newest sector
+void TelemetryStore::recover()
+{
+    uint32_t newest_sequence = 0;
+    for (int s = 0; s < sector_count; s++) {
+        telemetry_sector_header_t header;
+        index[s].sequence   = 0;
+        index[s].first_time = 0;
+        if (esp_partition_read(partition, s * TELEMETRY_SECTOR_SIZE, &header, sizeof(header)) !=
+            ESP_OK) {
+            continue;
+        }
+        if (header.magic != TELEMETRY_MAGIC || header.version != TELEMETRY_VERSION ||
+            header.crc != header_crc(header) || header.sequence == 0) {
+            continue;
+        }
+        index[s].sequence   = header.sequence;
+        index[s].first_time = header.first_time;
+        if (header.sequence > newest_sequence) {
+            newest_sequence = header.sequence;
+            head_sector     = s;
+        }
+    }
+
+    if (head_sector < 0) {
+        ESP_LOGI(TAG, "Empty store");
+        return;
+    }
+
+    next_sequence = newest_sequence + 1;
+    last_time     = index[head_sector].first_time;
+
+    // Records are appended in order, so the first erased slot is the end of the log.
+    // Slots before it that fail their CRC were torn by a power failure; they stay
+    // in place and are skipped by reads.
+    head_records = TELEMETRY_SECTOR_RECORDS;
+    telemetry_record_t buf[TELEMETRY_PAGE_RECORDS];
+    for (int slot = 0; slot < (int)TELEMETRY_SECTOR_RECORDS; slot += TELEMETRY_PAGE_RECORDS) {
+        int n = TELEMETRY_SECTOR_RECORDS - slot;
+        if (n > TELEMETRY_PAGE_RECORDS) {
+            n = TELEMETRY_PAGE_RECORDS;
+        }
+        size_t offset = record_offset(head_sector, slot);
+        if (esp_partition_read(partition, offset, buf, n * sizeof(telemetry_record_t)) != ESP_OK) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            if (is_erased(&buf[i], sizeof(buf[i]))) {
+                head_records = slot + i;
+                return;
+            }
+            if (buf[i].crc == record_crc(buf[i])) {
+                last_time = buf[i].time_s;
+            }
+            else {
+                stats.torn_records++;
+            }
+        }
+    }
+}
+
+uint32_t TelemetryStore::now() const
+{
+    uint32_t store_time = time_base + (uint32_t)(esp_timer_get_time() / 1000000);
+    time_t wall         = time(nullptr);
+    if (wall >= (time_t)TELEMETRY_VALID_EPOCH && (uint32_t)wall > store_time) {
+        return (uint32_t)wall;
+    }
+    return store_time;
+}
+
+void TelemetryStore::record(const sensor_data_t *data, uint16_t faults)
+{
+    if (!initialized || data == nullptr) {
+        return;
+    }
+
+    int64_t now_us   = esp_timer_get_time();
+    Accumulator &acc = accumulator;
+    if (acc.start_us == 0) {
+        acc.start_us = now_us;
+    }
+
+    if (data->temperature >= 0.0f) {
+        acc.temperature += data->temperature;
+        acc.temperature_count++;
+    }
+    else {
+        faults |= TELEMETRY_FAULT_SENSOR;
+    }
+    acc.pressure += data->pressure;
+    acc.heater += data->ssr_pwm[0];
+    acc.pump += data->dimmer_level / 1023.0f;
+    acc.flow += data->flow_rate1;
+    acc.faults |= faults;
+    acc.count++;
+
+    if (now_us - acc.start_us < TELEMETRY_SAMPLE_INTERVAL_MS * 1000LL) {
+        return;
+    }
+
+    // INT16_MIN marks an interval without a valid temperature
+    float n                = (float)acc.count;
+    telemetry_record_t rec = {};
+    rec.time_s             = now();
+    rec.temperature =
+        acc.temperature_count
+            ? (int16_t)clamp_raw(acc.temperature / acc.temperature_count * 10.0f, INT16_MAX)
+            : INT16_MIN;
+    rec.pressure    = (uint16_t)clamp_raw(acc.pressure / n * 100.0f, UINT16_MAX);
+    rec.heater_duty = (uint8_t)clamp_raw(acc.heater / n * 255.0f, UINT8_MAX);
+    rec.pump_duty   = (uint8_t)clamp_raw(acc.pump / n * 255.0f, UINT8_MAX);
+    rec.flow        = (uint16_t)clamp_raw(acc.flow / n * 10.0f, UINT16_MAX);
+    rec.faults      = acc.faults;
+    memset(&acc, 0, sizeof(acc));
+    acc.start_us = now_us;
+
+    if (!queue.push(rec)) {
+        stats.records_dropped++;
+        return;
+    }
+    xTaskNotifyGive(task_handle);
+}
+
+void TelemetryStore::taskEntry(void *arg)
+{
+    TelemetryStore *self = static_cast<TelemetryStore *>(arg);
+
+    while (1) {
+        // Woken by new records, by flush() or to write a stale partial page
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TELEMETRY_FLUSH_INTERVAL_MS));
+
+        xSemaphoreTake(self->lock, portMAX_DELAY);
+        telemetry_record_t rec;
+        while (self->queue.pop(rec)) {
+            self->append(rec);
+        }
+        bool stale = self->page_count > 0 && esp_timer_get_time() - self->page_started_us >=
+                                                 TELEMETRY_FLUSH_INTERVAL_MS * 1000LL;
+        if (stale || self->flush_requested.exchange(false)) {
+            self->flushPage();
+        }
+        xSemaphoreGive(self->lock);
+    }
+}
+
+// Lock held
+void TelemetryStore::append(const telemetry_record_t &rec)
+{
+    telemetry_record_t &slot = page[page_count];
+    slot                     = rec;
+
+    // Keep times non-decreasing, also when the wall clock is set backwards
+    uint32_t newest = page_count > 0 ? page[page_count - 1].time_s : last_time;
+    if (slot.time_s < newest) {
+        slot.time_s = newest;
+    }
+    slot.crc = record_crc(slot);
+
+    if (page_count++ == 0) {
+        page_started_us = esp_timer_get_time();
+    }
+    if (page_count == TELEMETRY_PAGE_RECORDS) {
+        flushPage();
+    }
+}
+
+// Program the pending page, opening new sectors as needed; lock held
+esp_err_t TelemetryStore::flushPage()
+{
+    esp_err_t err = ESP_OK;
+    int written   = 0;
+    while (written < page_count) {
+        if (head_sector < 0 || head_records == (int)TELEMETRY_SECTOR_RECORDS) {
+            err = openSector(page[written].time_s);
+            if (err != ESP_OK) {
+                break;
+            }
+        }
+
+        // Up to the end of the flash page; after a partial flush that is before the end of
+        // the pending records
+        int n    = page_count - written;
+        int room = TELEMETRY_PAGE_RECORDS - head_records % TELEMETRY_PAGE_RECORDS;
+        if (n > room) {
+            n = room;
+        }
+        err = esp_partition_write(partition,
+                                  record_offset(head_sector, head_records),
+                                  &page[written],
+                                  n * sizeof(telemetry_record_t));
+        if (err != ESP_OK) {
+            break;
+        }
+        head_records += n;
+        written += n;
+        stats.records_written += n;
+        stats.pages_written++;
+        last_time = page[written - 1].time_s;
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write %d records: %s", page_count - written, esp_err_to_name(err));
+    }
+    page_count = 0;
+    return err;
+}
+
+// Erase the sector after the head and start it with a header; lock held
+esp_err_t TelemetryStore::openSector(uint32_t first_time)
+{
+    int next = head_sector < 0 ? 0 : (head_sector + 1) % sector_count;
+
+    // The oldest sector leaves the index before its data is erased
+    index[next].sequence   = 0;
+    index[next].first_time = 0;
+
+    esp_err_t err =
+        esp_partition_erase_range(partition, next * TELEMETRY_SECTOR_SIZE, TELEMETRY_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    stats.sectors_erased++;
+
+    telemetry_sector_header_t header = {};
+    header.magic                     = TELEMETRY_MAGIC;
+    header.sequence                  = next_sequence;
+    header.first_time                = first_time;
+    header.version                   = TELEMETRY_VERSION;
+    header.crc                       = header_crc(header);
+    err = esp_partition_write(partition, next * TELEMETRY_SECTOR_SIZE, &header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    index[next].sequence   = next_sequence++;
+    index[next].first_time = first_time;
+    head_sector            = next;
+    head_records           = 0;
+    return ESP_OK;
+}
+
+int TelemetryStore::oldestSector() const
+{
+    int oldest = -1;
+    for (int s = 0; s < sector_count; s++) {
+        if (index[s].sequence != 0 &&
+            (oldest < 0 || index[s].sequence < index[oldest].sequence)) {
+            oldest = s;
+        }
+    }
+    return oldest;
+}
+
+bool TelemetryStore::readRecord(int sector, int slot, telemetry_record_t *out) const
+{
+    size_t offset = record_offset(sector, slot);
+    return esp_partition_read(partition, offset, out, sizeof(*out)) == ESP_OK &&
+           out->crc == record_crc(*out);
+}
+
+// First slot of a sector with a record at or after time_s; lock held
+int TelemetryStore::findSlot(int sector, uint32_t time_s) const
+{
+    int lo = 0;
+    int hi = sector == head_sector ? head_records : (int)TELEMETRY_SECTOR_RECORDS;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+
+        // Step over torn records to the next readable one
+        telemetry_record_t rec;
+        int probe = mid;
+        while (probe < hi && !readRecord(sector, probe, &rec)) {
+            probe++;
+        }
+        if (probe == hi || rec.time_s >= time_s) {
+            hi = mid;
+        }
+        else {
+            lo = probe + 1;
+        }
+    }
+    return lo;
+}
+
+size_t TelemetryStore::query(uint32_t from_s, uint32_t to_s, telemetry_record_t *out, size_t max)
+{
+    if (!initialized || out == nullptr || max == 0 || from_s > to_s) {
+        return 0;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    size_t count = 0;
+
+    // The index gives the newest sector starting at or before from_s; earlier
+    // sectors hold only older records
+    int sector = -1;
+    for (int s = 0; s < sector_count; s++) {
+        if (index[s].sequence != 0 && index[s].first_time <= from_s &&
+            (sector < 0 || index[s].sequence > index[sector].sequence)) {
+            sector = s;
+        }
+    }
+    if (sector < 0) {
+        sector = oldestSector();
+    }
+
+    int slot = sector >= 0 ? findSlot(sector, from_s) : 0;
+    bool done = false;
+    while (sector >= 0 && !done) {
+        int end = sector == head_sector ? head_records : (int)TELEMETRY_SECTOR_RECORDS;
+
+        telemetry_record_t buf[TELEMETRY_PAGE_RECORDS];
+        while (slot < end && !done) {
+            int n = end - slot;
+            if (n > TELEMETRY_PAGE_RECORDS) {
+                n = TELEMETRY_PAGE_RECORDS;
+            }
+            if (esp_partition_read(
+                    partition, record_offset(sector, slot), buf, n * sizeof(telemetry_record_t)) !=
+                ESP_OK) {
+                done = true;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                if (buf[i].crc != record_crc(buf[i]) || buf[i].time_s < from_s) {
+                    continue;
+                }
+                if (buf[i].time_s > to_s || count == max) {
+                    done = true;
+                    break;
+                }
+                out[count++] = buf[i];
+            }
+            slot += n;
+        }
+
+        // Follow the ring while the sequence continues
+        if (sector == head_sector) {
+            break;
+        }
+        int next = (sector + 1) % sector_count;
+        if (index[next].sequence != index[sector].sequence + 1) {
+            break;
+        }
+        sector = next;
+        slot   = 0;
+    }
+
+    // Records not programmed yet
+    for (int i = 0; i < page_count && !done && count < max; i++) {
+        if (page[i].time_s >= from_s && page[i].time_s <= to_s) {
+            out[count++] = page[i];
+        }
+    }
+
+    xSemaphoreGive(lock);
+    return count;
+}
+
+void TelemetryStore::flush()
+{
+    if (!initialized) {
+        return;
+    }
+    flush_requested.store(true);
+    xTaskNotifyGive(task_handle);
+}
+
+void TelemetryStore::getStats(telemetry_stats_t *out)
+{
+    if (out == nullptr) {
+        return;
+    }
+    if (lock) {
+        xSemaphoreTake(lock, portMAX_DELAY);
+    }
+    int oldest        = oldestSector();
+    stats.oldest_time = oldest >= 0 ? index[oldest].first_time : 0;
+    stats.newest_time = page_count > 0 ? page[page_count - 1].time_s : last_time;
+    *out              = stats;
+    if (lock) {
+        xSemaphoreGive(lock);
+    }
+}
+
+// C compatibility wrappers
+extern "C" {
+
+esp_err_t telemetry_store_init(void)
+{
+    return telemetry_store.init();
+}
+
+void telemetry_store_record(const sensor_data_t *data, uint16_t faults)
+{
+    telemetry_store.record(data, faults);
+}
+
+size_t telemetry_store_query(uint32_t from_s, uint32_t to_s, telemetry_record_t *out, size_t max)
+{
+    return telemetry_store.query(from_s, to_s, out, max);
+}
+
+void telemetry_store_flush(void)
+{
+    telemetry_store.flush();
+}
+
+void telemetry_store_get_stats(telemetry_stats_t *out)
+{
+    telemetry_store.getStats(out);
+}
+
+}  // extern "C"
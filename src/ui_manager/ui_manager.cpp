@@ -1,25 +1,83 @@
 #include "ui_manager/ui_manager.h"
 
+#include <slint.h>
+
 #include <cstring>
+#include <optional>
 
+#include "display/layer_cache.h"
+#include "display/slint_platform.h"
 #include "display_driver.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "tft_config.h"
 
-// Include Slint generated C bindings
-#include "generated/main_ui.h"
+// Generated from main_ui.slint by scripts/slint_codegen.py
+#include "main_ui_slint.h"
 
 static const char *TAG = "UI_MANAGER";
 
+// Plot area of the extraction chart on screen (chart grid of ExtractionProfile)
+#define PLOT_X 131
+#define PLOT_Y 200
+#define PLOT_HEIGHT 200
+#define PLOT_COLUMN_STEP 3               // Pixels per history sample
+#define PLOT_BACKGROUND 0x18C3           // #181818, the panel over the window background
+#define PLOT_GRID_COLOR 0x2945           // White at 8% over the background
+#define PLOT_FORMAT CHART_FORMAT_INDEX8  // Half the memory of RGB565; see chart_benchmark()
+
+// Trace colors (RGB565, legend colors of main_ui.slint) and value ranges
+#define PLOT_TEMPERATURE_COLOR 0xFAC0  // #ff5b00
+#define PLOT_PRESSURE_COLOR 0xF945     // #ff2a2a
+#define PLOT_FLOW1_COLOR 0x045B        // #078ada
+#define PLOT_FLOW2_COLOR 0x5DDD        // #5fb8ef
+#define PLOT_TEMPERATURE_MAX 150.0f    // °C
+#define PLOT_PRESSURE_MAX 150.0f       // PSI
+#define PLOT_FLOW_MAX 1000.0f          // mL/min
+
+// Default setpoints shown until the user changes them, as set up by main.cpp
+#define UI_DEFAULT_TEMP_SETPOINT 85.0f      // °C
+#define UI_DEFAULT_PRESSURE_SETPOINT 30.0f  // PSI
+
+// Property set statistics reporting interval
+#define UI_STATS_INTERVAL_MS 10000
+
 // Global instance
 UIManager ui_manager;
 
+// Slint objects, kept out of ui_manager.h so its users do not depend on the generated UI
+static std::optional<slint::ComponentHandle<MainWindow>> main_window;
+static std::shared_ptr<slint::VectorModel<SSRData>> ssr_model;
+static std::optional<LayerCache<MainWindow, StaticLayer>> layer_cache;
+
+// The main window; only valid once init() has created it
+static const MainWindow &window()
+{
+    return **main_window;
+}
+
+// Forward a staged binding to its window property
+template <typename T, typename Setter>
+static uint32_t forward(Binding<T> &binding, Setter set)
+{
+    if (!binding.pending()) {
+        return 0;
+    }
+    set(binding.take());
+    return 1;
+}
+
 // UIManager implementation
 UIManager::UIManager() 
-    : main_window(nullptr), initialized(false), ssr_count(0), 
+    : initialized(false), ssr_count(0), 
       ssr_names(nullptr), ssr_pid_enabled(nullptr),
       current_view(ViewType::CONTROL),
+      applied_version(0), readout_due_us(0), chart_due_us(0), charted_samples(0),
+      backoff_shift(0),
+      binding_stats(), stats_start_us(0), stats_start(), stats_start_pixels(0),
       ssr_callback(nullptr), dimmer_callback(nullptr),
-      setpoint_callback(nullptr), pid_toggle_callback(nullptr)
+      setpoint_callback(nullptr), pid_toggle_callback(nullptr), safety_reset_callback(nullptr),
+      shot_callback(nullptr)
 {
 }
 
@@ -27,344 +85,471 @@ void UIManager::init()
 {
     ESP_LOGI(TAG, "Initializing UI manager with Slint");
 
-    // Initialize Slint UI (frontend)
-    main_window = main_window_new();
-    if (main_window == nullptr) {
-        ESP_LOGE(TAG, "Failed to create Slint main window");
-        return;
-    }
+    // The platform gives the first window created the panel, so the main window is
+    // created before anything else
+    display_slint_acquire();
+    main_window.emplace(MainWindow::create());
+    ssr_model = std::make_shared<slint::VectorModel<SSRData>>();
+    window().set_ssr_data(ssr_model);
+    bindCallbacks();
+    display_slint_release();
 
-    // Register UI callbacks to connect frontend events to backend
-    main_window_on_ssr_toggled(main_window, slintSSRToggled, this);
-    main_window_on_dimmer_changed(main_window, slintDimmerChanged, this);
-    main_window_on_temp_setpoint_changed(main_window, slintTempSetpointChanged, this);
-    main_window_on_pressure_setpoint_changed(main_window, slintPressureSetpointChanged, this);
-    main_window_on_ssr_setpoint_changed(main_window, slintSSRSetpointChanged, this);
-    main_window_on_pid_toggled(main_window, slintPIDToggled, this);
-    main_window_on_toggle_view(main_window, slintToggleView, this);
-    
     initialized = true;
 }
 
 void UIManager::registerCallbacks(SSRCallback ssr_cb, 
                                DimmerCallback dimmer_cb,
                                PIDSetpointCallback setpoint_cb,
-                               PIDToggleCallback pid_toggle_cb)
+                               PIDToggleCallback pid_toggle_cb,
+                               SafetyResetCallback safety_reset_cb,
+                               ShotCallback shot_cb)
 {
     ssr_callback = ssr_cb;
     dimmer_callback = dimmer_cb;
     setpoint_callback = setpoint_cb;
     pid_toggle_callback = pid_toggle_cb;
+    safety_reset_callback = safety_reset_cb;
+    shot_callback = shot_cb;
 }
 
 void UIManager::create(int ssr_count, const char **ssr_names, const bool *ssr_pid_enabled)
 {
     ESP_LOGI(TAG, "Creating UI elements with Slint");
 
+    if (!initialized) {
+        ESP_LOGE(TAG, "UI manager not initialized");
+        return;
+    }
+
     // Store configuration data
+    if (ssr_count > UI_BINDING_MAX_SSRS) {
+        ESP_LOGW(TAG, "Only the first %d SSRs are shown", UI_BINDING_MAX_SSRS);
+        ssr_count = UI_BINDING_MAX_SSRS;
+    }
     this->ssr_count = ssr_count;
     this->ssr_names = ssr_names;
     this->ssr_pid_enabled = ssr_pid_enabled;
 
-    // Default setpoints from application
-    float default_temp_setpoint = 85.0f;
-    float default_pressure_setpoint = 30.0f;
-    float default_ssr_setpoints[16];
-    for (int i = 0; i < 16; i++) {
-        default_ssr_setpoints[i] = 85.0f;
+    // Initialize the UI frontend with default values
+    display_slint_acquire();
+
+    const MainWindow &ui = window();
+    ui.set_pid_enabled(true);
+    ui.set_temp_setpoint(UI_DEFAULT_TEMP_SETPOINT);
+    ui.set_pressure_setpoint(UI_DEFAULT_PRESSURE_SETPOINT);
+    ui.set_dimmer_level(0.0f);
+    ui.set_show_control_view(true);
+
+    // One model row per SSR; later updates rewrite rows in place
+    for (int i = 0; i < ssr_count; i++) {
+        SSRData row;
+        row.name     = ssr_names[i];
+        row.state    = false;
+        row.has_pid  = ssr_pid_enabled[i];
+        row.setpoint = UI_DEFAULT_TEMP_SETPOINT;
+        ssr_model->push_back(row);
     }
 
-    // Create data structures for the UI
-    SSRData ssr_data[ssr_count];
+    // The bindings start from what the window now shows
+    bindings.temperature.sync(0.0f);
+    bindings.pressure.sync(0.0f);
+    bindings.flow_rate1.sync(0.0f);
+    bindings.flow_rate2.sync(0.0f);
+    bindings.dimmer_level.sync(0.0f);
+    bindings.temp_setpoint.sync(UI_DEFAULT_TEMP_SETPOINT);
+    bindings.pressure_setpoint.sync(UI_DEFAULT_PRESSURE_SETPOINT);
     for (int i = 0; i < ssr_count; i++) {
-        ssr_data[i].name = ssr_names[i];
-        ssr_data[i].state = false;
-        ssr_data[i].has_pid = ssr_pid_enabled[i];
-        ssr_data[i].setpoint = default_ssr_setpoints[i];
+        bindings.ssr_state[i].sync(false);
+        bindings.ssr_setpoint[i].sync(UI_DEFAULT_TEMP_SETPOINT);
     }
+    bindings.shot_running.sync(false);
+    bindings.shot_volume.sync(0.0f);
+    bindings.shot_time.sync(0.0f);
 
-    // Initialize the UI frontend with default values
-    display_slint_acquire();
+    // Show UI
+    ui.show();
 
-    main_window_set_title(main_window, "ESP32-S3 Control Panel");
-    main_window_set_pid_enabled(main_window, true);
-    main_window_set_temp_setpoint(main_window, default_temp_setpoint);
-    main_window_set_pressure_setpoint(main_window, default_pressure_setpoint);
-    main_window_set_ssr_data(main_window, ssr_data, ssr_count);
-    main_window_set_dimmer_level(main_window, 0.0f);
-    main_window_set_show_control_view(main_window, true);
-
-    // Initialize sensor data to zero
-    SensorData sensor_data = {
-        .temperature = 0.0f, 
-        .pressure = 0.0f, 
-        .flow_rate1 = 0.0f, 
-        .flow_rate2 = 0.0f
-    };
-    main_window_set_sensor_data(main_window, &sensor_data);
-
-    // Initialize chart data to empty arrays
-    ChartData chart_data = {
-        .temperature_data = nullptr,
-        .pressure_data = nullptr,
-        .flow_rate1_data = nullptr,
-        .flow_rate2_data = nullptr
-    };
-    main_window_set_chart_data(main_window, &chart_data);
+    // Panel chrome, shadows and grids can be drawn from an image rendered once per view
+    layer_cache.emplace(*main_window, [](const slint::ComponentHandle<StaticLayer> &layer) {
+        layer->set_show_control_view(window().get_show_control_view());
+    });
+    layer_cache->setEnabled(DISPLAY_LAYER_CACHE);
+    layer_cache->attach();
+
+#ifdef DISPLAY_BENCHMARK_FRAMES
+    // Full-frame render times without and with the layer cache, on the render task
+    slint::invoke_from_event_loop([] { layer_cache->benchmark(DISPLAY_BENCHMARK_FRAMES); });
+#endif
 
     display_slint_release();
 
-    // Show UI
-    main_window_show(main_window);
+    // From now on published sensor data is applied by the render task
+    display_set_frame_start_hook(frameStart);
 }
 
 void UIManager::showControlView()
 {
-    ESP_LOGI(TAG, "Switching to control view");
-    
     display_slint_acquire();
-    main_window_set_show_control_view(main_window, true);
+    setView(ViewType::CONTROL);
     display_slint_release();
-    
-    current_view = ViewType::CONTROL;
 }
 
 void UIManager::showPlotsView()
 {
-    ESP_LOGI(TAG, "Switching to plots view");
-    
     display_slint_acquire();
-    main_window_set_show_control_view(main_window, false);
+    setView(ViewType::PLOTS);
     display_slint_release();
-    
-    current_view = ViewType::PLOTS;
 }
 
-void UIManager::toggleView()
+void UIManager::setView(ViewType view)
 {
-    if (current_view == ViewType::CONTROL) {
-        showPlotsView();
-    } else {
-        showControlView();
+    if (!initialized || view == current_view) {
+        return;
     }
+
+    if (view == ViewType::PLOTS) {
+        ESP_LOGI(TAG, "Switching to plots view");
+        window().set_show_control_view(false);
+        if (createPlotsView()) {
+            // Catch up on the samples recorded while hidden in a single update
+            ui_snapshot_t snapshot;
+            if (mailbox.read(snapshot) > 0 && snapshot.history) {
+                updateCharts(snapshot.history, snapshot.history_samples);
+            }
+        }
+    }
+    else {
+        ESP_LOGI(TAG, "Switching to control view");
+        window().set_show_control_view(true);
+        releasePlotsView();
+    }
+    current_view = view;
+
+    // The cached static layer belongs to the previous view
+    slint_platform_invalidate_layers();
 }
 
-void UIManager::updateSensorData(const sensor_data_t *data)
+bool UIManager::createPlotsView()
 {
-    if (!initialized || !data) {
-        return;
+    if (current_view == ViewType::PLOTS) {
+        return true;
     }
 
-    display_slint_acquire();
-    
-    // Update sensor data in the UI
-    SensorData ui_sensor_data = {
-        .temperature = data->temperature,
-        .pressure = data->pressure,
-        .flow_rate1 = data->flow_rate1,
-        .flow_rate2 = data->flow_rate2
-    };
-    main_window_set_sensor_data(main_window, &ui_sensor_data);
-    
-    // Update SSR states
-    SSRData *ssr_data = main_window_get_ssr_data(main_window);
-    if (ssr_data != nullptr && ssr_count > 0) {
-        for (int i = 0; i < ssr_count; i++) {
-            ssr_data[i].state = data->ssr_states[i];
-        }
-        main_window_set_ssr_data(main_window, ssr_data, ssr_count);
+    // Traces in ChartType order, matching the views built in updateCharts()
+    if (plot_chart.init(PLOT_X,
+                        PLOT_Y,
+                        SENSOR_HISTORY_LENGTH,
+                        PLOT_COLUMN_STEP,
+                        PLOT_HEIGHT,
+                        PLOT_BACKGROUND,
+                        PLOT_GRID_COLOR,
+                        PLOT_FORMAT) != ESP_OK) {
+        return false;
     }
-    
-    // Update dimmer level
-    float dimmer_percentage = (float)data->dimmer_level / 1023.0f;
-    main_window_set_dimmer_level(main_window, dimmer_percentage);
-    
-    display_slint_release();
+    plot_chart.addTrace(PLOT_TEMPERATURE_COLOR, 0.0f, PLOT_TEMPERATURE_MAX);
+    plot_chart.addTrace(PLOT_PRESSURE_COLOR, 0.0f, PLOT_PRESSURE_MAX);
+    plot_chart.addTrace(PLOT_FLOW1_COLOR, 0.0f, PLOT_FLOW_MAX);
+    plot_chart.addTrace(PLOT_FLOW2_COLOR, 0.0f, PLOT_FLOW_MAX);
+    return true;
 }
 
-void UIManager::updateCharts(const SensorHistory *history)
+void UIManager::releasePlotsView()
 {
-    if (!initialized || !history) {
+    if (current_view != ViewType::PLOTS) {
         return;
     }
 
+    ESP_LOGI(TAG, "Releasing %u byte chart surface", (unsigned)plot_chart.getStats().surface_bytes);
+    plot_chart.setVisible(false);
+    plot_chart.deinit();
+}
+
+void UIManager::toggleView()
+{
     display_slint_acquire();
-    
-    // Convert circular buffer to linear array for charts
-    // This depends on how your charting library works
-    // Here's a simplified example:
-    float temp_data[SENSOR_HISTORY_LENGTH];
-    float press_data[SENSOR_HISTORY_LENGTH];
-    float flow1_data[SENSOR_HISTORY_LENGTH];
-    float flow2_data[SENSOR_HISTORY_LENGTH];
-    
-    for (int i = 0; i < SENSOR_HISTORY_LENGTH; i++) {
-        int idx = (history->write_index + i) % SENSOR_HISTORY_LENGTH;
-        temp_data[i] = history->temperature[idx];
-        press_data[i] = history->pressure[idx];
-        flow1_data[i] = history->flow_rate1[idx];
-        flow2_data[i] = history->flow_rate2[idx];
-    }
-    
-    // Update chart data
-    ChartData chart_data = {
-        .temperature_data = temp_data,
-        .pressure_data = press_data,
-        .flow_rate1_data = flow1_data,
-        .flow_rate2_data = flow2_data
-    };
-    main_window_set_chart_data(main_window, &chart_data);
-    
+    setView(current_view == ViewType::CONTROL ? ViewType::PLOTS : ViewType::CONTROL);
     display_slint_release();
 }
 
-void UIManager::updatePIDOutputs(float pressure_output, const bool *ssr_states)
+void UIManager::publish(const sensor_data_t *data,
+                        const profile_status_t *profile,
+                        const SensorHistory *history)
 {
-    if (!initialized) {
+    if (!data) {
         return;
     }
 
-    display_slint_acquire();
-    
-    // Update dimmer level (for pressure PID)
-    float dimmer_percentage = pressure_output / 1023.0f;
-    main_window_set_dimmer_level(main_window, dimmer_percentage);
-    
-    // Update SSR states
-    SSRData *ssr_data = main_window_get_ssr_data(main_window);
-    if (ssr_data != nullptr && ssr_count > 0) {
-        for (int i = 0; i < ssr_count; i++) {
-            ssr_data[i].state = ssr_states[i];
-        }
-        main_window_set_ssr_data(main_window, ssr_data, ssr_count);
+    ui_snapshot_t snapshot   = {};
+    snapshot.sensor          = *data;
+    snapshot.history         = history;
+    snapshot.history_samples = history ? history->sample_count : 0;
+    if (profile) {
+        snapshot.profile = *profile;
     }
-    
-    display_slint_release();
+    else {
+        snapshot.profile.segment_name = "IDLE";
+    }
+    mailbox.publish(snapshot);
+    slint_platform_wake();
 }
 
-void UIManager::updatePIDSetpoints(float pressure_setpoint, const float *ssr_setpoints)
+// Frame start hook of the render task
+void UIManager::frameStart()
 {
-    if (!initialized) {
+    ui_manager.applyPublished();
+}
+
+void UIManager::applyPublished()
+{
+    uint32_t version = mailbox.version();
+    if (!initialized || version == applied_version) {
         return;
     }
 
-    display_slint_acquire();
-    
-    // Update pressure setpoint
-    main_window_set_pressure_setpoint(main_window, pressure_setpoint);
-    
-    // Update SSR setpoints
-    SSRData *ssr_data = main_window_get_ssr_data(main_window);
-    if (ssr_data != nullptr && ssr_count > 0) {
-        for (int i = 0; i < ssr_count; i++) {
-            if (ssr_pid_enabled[i]) {
-                ssr_data[i].setpoint = ssr_setpoints[i];
-            }
-        }
-        main_window_set_ssr_data(main_window, ssr_data, ssr_count);
+    ui_snapshot_t snapshot;
+    version = mailbox.read(snapshot);
+
+    // Publishes superseded before this frame cost nothing; count what they would have set
+    binding_stats.requested += 3 * (version - applied_version);
+    applied_version = version;
+
+    int64_t now_us = esp_timer_get_time();
+    updateBackoff();
+
+    // SSR indicators and the start/stop button follow every change
+    for (int i = 0; i < ssr_count; i++) {
+        bindings.ssr_state[i].set(snapshot.sensor.ssr_states[i]);
     }
-    
-    display_slint_release();
+    bindings.shot_running.set(snapshot.profile.state == PROFILE_STATE_RUNNING);
+
+    // Readouts faster than a few Hz cannot be read, they only cost redraws
+    if (now_us >= readout_due_us) {
+        stageReadouts(&snapshot.sensor);
+        stageShot(&snapshot.profile);
+        readout_due_us = now_us + ((UI_READOUT_INTERVAL_MS * 1000LL) << backoff_shift);
+    }
+    applyBindings();
+
+    // The chart only changes when the history gains a sample, at most once per history
+    // interval; a hidden chart is not drawn at all and catches up when the plots view
+    // is shown
+    if (current_view == ViewType::PLOTS && snapshot.history &&
+        snapshot.history_samples != charted_samples && now_us >= chart_due_us) {
+        updateCharts(snapshot.history, snapshot.history_samples);
+    }
+    logBindingStats();
 }
 
-// Static event handlers
-void UIManager::slintSSRToggled(void *context, int index, bool state)
+void UIManager::stageReadouts(const sensor_data_t *data)
 {
-    UIManager *ui = static_cast<UIManager*>(context);
-    if (ui && ui->ssr_callback) {
-        ui->ssr_callback(index, state);
-    }
+    // Unchanged values are dropped by the bindings
+    bindings.temperature.set(data->temperature);
+    bindings.pressure.set(data->pressure);
+    bindings.flow_rate1.set(data->flow_rate1);
+    bindings.flow_rate2.set(data->flow_rate2);
+    bindings.dimmer_level.set((float)data->dimmer_level / 1023.0f);
 }
 
-void UIManager::slintDimmerChanged(void *context, float level)
+void UIManager::stageShot(const profile_status_t *profile)
 {
-    UIManager *ui = static_cast<UIManager*>(context);
-    if (ui && ui->dimmer_callback) {
-        ui->dimmer_callback((uint32_t)(level * 1023.0f));
-    }
+    bindings.shot_step.set(profile->segment_name);
+    bindings.shot_volume.set(profile->volume_ml);
+    bindings.shot_time.set(profile->shot_ms / 1000.0f);
 }
 
-void UIManager::slintTempSetpointChanged(void *context, float setpoint)
+// Stretch the refresh budgets while frames take longer than UI_RENDER_BUDGET_US, and
+// relax them again once frames are well within it
+void UIManager::updateBackoff()
 {
-    UIManager *ui = static_cast<UIManager*>(context);
-    
-    // Update UI state
-    display_slint_acquire();
-    main_window_set_temp_setpoint(ui->main_window, setpoint);
-    display_slint_release();
+    slint_render_stats_t render_stats;
+    slint_platform_get_stats(&render_stats);
 
-    // Forward to application logic (backend)
-    if (ui && ui->setpoint_callback) {
-        ui->setpoint_callback(0, setpoint);
+    if (render_stats.last_frame_us > UI_RENDER_BUDGET_US && backoff_shift < UI_MAX_BACKOFF_SHIFT) {
+        backoff_shift++;
+        ESP_LOGI(TAG, "Frame took %u us, UI refresh budgets x%d",
+                 (unsigned)render_stats.last_frame_us, 1 << backoff_shift);
+    }
+    else if (render_stats.last_frame_us < UI_RENDER_BUDGET_US / 2 && backoff_shift > 0) {
+        backoff_shift--;
     }
-
-    ESP_LOGI(TAG, "Temperature setpoint changed to %.1f °C", setpoint);
 }
 
-void UIManager::slintPressureSetpointChanged(void *context, float setpoint)
+// Scroll the chart up to sample_count; samples up to it were complete when published
+void UIManager::updateCharts(const SensorHistory *history, uint32_t sample_count)
 {
-    UIManager *ui = static_cast<UIManager*>(context);
-    
-    // Update UI state
-    display_slint_acquire();
-    main_window_set_pressure_setpoint(ui->main_window, setpoint);
-    display_slint_release();
+    // Views index the history ring in place, nothing is copied
+    const HistoryView views[(int)ChartType::COUNT] = {
+        history->view(history->temperature, sample_count),
+        history->view(history->pressure, sample_count),
+        history->view(history->flow_rate1, sample_count),
+        history->view(history->flow_rate2, sample_count)
+    };
 
-    // Forward to application logic (backend)
-    if (ui && ui->setpoint_callback) {
-        ui->setpoint_callback(-1, setpoint);
-    }
+    plot_chart.update(views, sample_count);
+
+    // Shown once it has been drawn, so the overlay never exposes an empty surface
+    plot_chart.setVisible(true);
 
-    ESP_LOGI(TAG, "Pressure setpoint changed to %.1f PSI", setpoint);
+    // Half an interval keeps an early sample from waiting a whole one
+    int64_t interval_us = history->update_interval_ms * 1000LL / 2;
+    charted_samples     = sample_count;
+    chart_due_us        = esp_timer_get_time() + (interval_us << backoff_shift);
 }
 
-void UIManager::slintSSRSetpointChanged(void *context, int index, float setpoint)
+void UIManager::applyBindings()
 {
-    UIManager *ui = static_cast<UIManager*>(context);
-    
-    // Update the UI state
-    if (ui && index >= 0 && index < ui->ssr_count && ui->ssr_pid_enabled[index]) {
-        display_slint_acquire();
-        SSRData *ssr_data = main_window_get_ssr_data(ui->main_window);
-        if (ssr_data != nullptr && index < main_window_get_ssr_data_size(ui->main_window)) {
-            ssr_data[index].setpoint = setpoint;
-            main_window_set_ssr_data(
-                ui->main_window, ssr_data, main_window_get_ssr_data_size(ui->main_window));
-        }
-        display_slint_release();
+    bool sensor   = bindings.sensorPending();
+    bool dimmer   = bindings.dimmer_level.pending();
+    bool setpoint = bindings.pressure_setpoint.pending() || bindings.temp_setpoint.pending();
+    bool ssr      = bindings.ssrPending(ssr_count);
+    bool shot     = bindings.shotPending();
+    if (!sensor && !dimmer && !setpoint && !ssr && !shot) {
+        return;
+    }
 
-        // Forward to application logic (backend)
-        if (ui->setpoint_callback) {
-            ui->setpoint_callback(index, setpoint);
-        }
+    const MainWindow &ui = window();
+    if (sensor) {
+        binding_stats.forwarded +=
+            forward(bindings.temperature, [&](float v) { ui.set_temperature(v); }) +
+            forward(bindings.pressure, [&](float v) { ui.set_pressure(v); }) +
+            forward(bindings.flow_rate1, [&](float v) { ui.set_flow_rate1(v); }) +
+            forward(bindings.flow_rate2, [&](float v) { ui.set_flow_rate2(v); });
+    }
 
-        ESP_LOGI(TAG, "SSR%d setpoint changed to %.1f °C", index + 1, setpoint);
+    if (dimmer) {
+        ui.set_dimmer_level(bindings.dimmer_level.take());
+        binding_stats.forwarded++;
     }
-}
 
-void UIManager::slintPIDToggled(void *context, bool enabled)
-{
-    UIManager *ui = static_cast<UIManager*>(context);
-    
-    // Update UI state
-    display_slint_acquire();
-    main_window_set_pid_enabled(ui->main_window, enabled);
-    display_slint_release();
+    if (setpoint) {
+        binding_stats.forwarded +=
+            forward(bindings.pressure_setpoint, [&](float v) { ui.set_pressure_setpoint(v); }) +
+            forward(bindings.temp_setpoint, [&](float v) { ui.set_temp_setpoint(v); });
+    }
+
+    if (ssr) {
+        binding_stats.forwarded += bindings.applySsrRows(*ssr_model, ssr_count);
+    }
 
-    // Forward to application logic (backend)
-    if (ui && ui->pid_toggle_callback) {
-        ui->pid_toggle_callback(enabled);
+    // The segment name is only converted to a Slint string when the segment changes
+    if (shot) {
+        binding_stats.forwarded +=
+            forward(bindings.shot_running, [&](bool v) { ui.set_shot_running(v); }) +
+            forward(bindings.shot_step,
+                    [&](const char *v) { ui.set_shot_step(slint::SharedString(v)); }) +
+            forward(bindings.shot_volume, [&](float v) { ui.set_shot_volume(v); }) +
+            forward(bindings.shot_time, [&](float v) { ui.set_shot_time(v); });
     }
 
-    ESP_LOGI(TAG, "PID controllers %s", enabled ? "enabled" : "disabled and reset");
+    binding_stats.batches++;
 }
 
-void UIManager::slintToggleView(void *context)
+void UIManager::logBindingStats()
 {
-    UIManager *ui = static_cast<UIManager*>(context);
-    if (ui) {
-        ui->toggleView();
+    int64_t now_us = esp_timer_get_time();
+    if (stats_start_us == 0) {
+        stats_start_us = now_us;
+        return;
     }
+    if (now_us - stats_start_us < UI_STATS_INTERVAL_MS * 1000LL) {
+        return;
+    }
+
+    slint_render_stats_t render_stats;
+    slint_platform_get_stats(&render_stats);
+
+    float seconds = (now_us - stats_start_us) / 1e6f;
+    ESP_LOGI(TAG,
+             "Property sets: %.1f/s requested, %.1f/s forwarded in %.1f batches/s, "
+             "%.0f dirty px/s",
+             (binding_stats.requested - stats_start.requested) / seconds,
+             (binding_stats.forwarded - stats_start.forwarded) / seconds,
+             (binding_stats.batches - stats_start.batches) / seconds,
+             (render_stats.pixels_flushed - stats_start_pixels) / seconds);
+
+    stats_start_us = now_us;
+    stats_start = binding_stats;
+    stats_start_pixels = render_stats.pixels_flushed;
+}
+
+void UIManager::bindCallbacks()
+{
+    const MainWindow &ui = window();
+
+    // Slint runs these on the render task with the UI mutex held: they may update the
+    // window directly, but must not take the mutex again. The application callbacks only
+    // queue commands for the control task.
+    ui.on_ssr_toggled([this](int index, bool state) {
+        if (ssr_callback) {
+            ssr_callback(index, state);
+        }
+    });
+
+    ui.on_dimmer_changed([this](float level) {
+        if (dimmer_callback) {
+            dimmer_callback((uint32_t)(level * 1023.0f));
+        }
+    });
+
+    ui.on_pressure_setpoint_changed([this](float setpoint) {
+        window().set_pressure_setpoint(setpoint);
+        bindings.pressure_setpoint.sync(setpoint);
+        if (setpoint_callback) {
+            setpoint_callback(-1, setpoint);
+        }
+        ESP_LOGI(TAG, "Pressure setpoint changed to %.1f PSI", setpoint);
+    });
+
+    ui.on_ssr_setpoint_changed([this](int index, float setpoint) {
+        if (index < 0 || index >= ssr_count || !ssr_pid_enabled[index]) {
+            return;
+        }
+
+        auto row = ssr_model->row_data(index);
+        if (row) {
+            row->setpoint = setpoint;
+            ssr_model->set_row_data(index, *row);
+        }
+        bindings.ssr_setpoint[index].sync(setpoint);
+
+        // The heater setpoint is also the temperature target of the status bar
+        if (index == 0) {
+            window().set_temp_setpoint(setpoint);
+            bindings.temp_setpoint.sync(setpoint);
+        }
+
+        if (setpoint_callback) {
+            setpoint_callback(index, setpoint);
+        }
+        ESP_LOGI(TAG, "SSR%d setpoint changed to %.1f °C", index + 1, setpoint);
+    });
+
+    ui.on_pid_toggled([this](bool enabled) {
+        window().set_pid_enabled(enabled);
+        if (pid_toggle_callback) {
+            pid_toggle_callback(enabled);
+        }
+        ESP_LOGI(TAG, "PID controllers %s", enabled ? "enabled" : "disabled and reset");
+    });
+
+    ui.on_safety_reset([this] {
+        if (safety_reset_callback) {
+            safety_reset_callback();
+        }
+        ESP_LOGI(TAG, "Safety interlock reset requested");
+    });
+
+    ui.on_shot_clicked([this] {
+        bool start = !bindings.shot_running.get();
+        if (shot_callback) {
+            shot_callback(start);
+        }
+        ESP_LOGI(TAG, "Shot %s requested", start ? "start" : "stop");
+    });
+
+    ui.on_toggle_view([this] {
+        setView(current_view == ViewType::CONTROL ? ViewType::PLOTS : ViewType::CONTROL);
+    });
 }
 
 // C compatibility wrappers
@@ -378,9 +563,12 @@ void ui_manager_init(void)
 void ui_manager_register_callbacks(SSRCallback ssr_cb,
                                 DimmerCallback dimmer_cb,
                                 PIDSetpointCallback setpoint_cb,
-                                PIDToggleCallback pid_toggle_cb)
+                                PIDToggleCallback pid_toggle_cb,
+                                SafetyResetCallback safety_reset_cb,
+                                ShotCallback shot_cb)
 {
-    ui_manager.registerCallbacks(ssr_cb, dimmer_cb, setpoint_cb, pid_toggle_cb);
+    ui_manager.registerCallbacks(
+        ssr_cb, dimmer_cb, setpoint_cb, pid_toggle_cb, safety_reset_cb, shot_cb);
 }
 
 void ui_create(int ssr_count, const char **ssr_names, const bool *ssr_pid_enabled)
@@ -403,24 +591,11 @@ void ui_toggle_view(void)
     ui_manager.toggleView();
 }
 
-void ui_update_sensor_data(const sensor_data_t *data)
-{
-    ui_manager.updateSensorData(data);
-}
-
-void ui_update_charts(const SensorHistory *history)
-{
-    ui_manager.updateCharts(history);
-}
-
-void ui_update_pid_outputs(float pressure_output, const bool *ssr_states)
-{
-    ui_manager.updatePIDOutputs(pressure_output, ssr_states);
-}
-
-void ui_update_pid_setpoints(float pressure_setpoint, const float *ssr_setpoints)
+void ui_publish(const sensor_data_t *data,
+                const profile_status_t *profile,
+                const SensorHistory *history)
 {
-    ui_manager.updatePIDSetpoints(pressure_setpoint, ssr_setpoints);
+    ui_manager.publish(data, profile, history);
 }
 
 } // extern "C" 
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Host benchmarks run as ordinary tests. They print their numbers and record them as
+// test properties (--gtest_output=xml) but never assert on them: wall-clock results
+// depend on the machine. esp_timer_get_time() is simulated on the host, so they use
+// the steady clock instead.
+
+// Minimum wall time a measurement runs for, repeating the body as needed
+#define HOST_BENCH_MIN_US 20000
+
+/**
+ * @brief Time fn, repeated until HOST_BENCH_MIN_US have passed
+ *
+ * @return Mean wall time of one call in microseconds
+ */
+template <typename Fn>
+double host_bench_us(Fn&& fn)
+{
+    using clock = std::chrono::steady_clock;
+
+    fn();  // Warm the caches
+    long calls  = 0;
+    auto start  = clock::now();
+    double took = 0.0;
+    do {
+        fn();
+        calls++;
+        took = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    } while (took < HOST_BENCH_MIN_US);
+    return took / calls;
+}
+
+/**
+ * @brief Print one benchmark result and attach it to the running test
+ */
+inline void host_bench_report(const char* name, double value, const char* unit)
+{
+    printf("[  BENCH   ] %-28s %10.2f %s\n", name, value, unit);
+    std::string key = name;
+    for (char& c : key) {
+        if (c == ' ') {
+            c = '_';
+        }
+    }
+    ::testing::Test::RecordProperty(key, std::to_string(value) + " " + unit);
+}
+
+#endif /* HOST_BENCH_H */
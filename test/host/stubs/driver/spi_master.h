@@ -0,0 +1,9 @@
+#ifndef SPI_MASTER_H
+#define SPI_MASTER_H
+
+#include "esp_err.h"
+
+// Host build: only the handle type, for headers that pass one around
+typedef struct spi_device_t* spi_device_handle_t;
+
+#endif /* SPI_MASTER_H */
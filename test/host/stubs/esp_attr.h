@@ -0,0 +1,7 @@
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// Host build: no IRAM
+#define IRAM_ATTR
+
+#endif /* ESP_ATTR_H */
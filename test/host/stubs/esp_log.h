@@ -0,0 +1,13 @@
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <cstdio>
+
+// Host build: errors and warnings go to stderr, the rest is dropped
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ((void)(tag))
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
+
+#endif /* ESP_LOG_H */
@@ -0,0 +1,70 @@
+#ifndef ESP_PARTITION_H
+#define ESP_PARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+
+// Host build: one partition in RAM with NOR flash semantics. Erases set whole
+// sectors to 0xFF and writes can only clear bits.
+typedef enum {
+    ESP_PARTITION_TYPE_APP  = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef int esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    uint32_t erase_size;
+    char label[17];
+} esp_partition_t;
+
+#define HOST_FLASH_SECTOR_SIZE 4096
+#define HOST_FLASH_PAGE_SIZE 256
+
+// Flash operations since host_partition_create()
+typedef struct {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t erases;
+    uint32_t straddling_writes;  // Writes that crossed a page boundary
+} host_flash_stats_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* partition,
+                             size_t offset,
+                             void* dst,
+                             size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition,
+                              size_t offset,
+                              const void* src,
+                              size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+
+/**
+ * @brief Replace the partition with an erased one
+ *
+ * @param label Label esp_partition_find_first() matches
+ * @param subtype Data subtype esp_partition_find_first() matches
+ * @param size Size in bytes, a multiple of HOST_FLASH_SECTOR_SIZE
+ */
+void host_partition_create(const char* label, esp_partition_subtype_t subtype, size_t size);
+
+/**
+ * @brief Raw partition contents, e.g. to tear a write
+ */
+uint8_t* host_partition_data(void);
+
+/**
+ * @brief Flash operations since the partition was created
+ */
+host_flash_stats_t host_flash_stats(void);
+
+#endif /* ESP_PARTITION_H */
@@ -0,0 +1,9 @@
+#ifndef ESP_ROM_CRC_H
+#define ESP_ROM_CRC_H
+
+#include <cstdint>
+
+// Host build: same CRC16 as the ROM (CCITT, reflected, inverted in and out)
+uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t* buf, uint32_t len);
+
+#endif /* ESP_ROM_CRC_H */
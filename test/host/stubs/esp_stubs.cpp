@@ -0,0 +1,248 @@
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "hardware/hardware_control.h"
+
+static int64_t host_time_us = 0;
+
+HardwareControl hw;
+
+int64_t esp_timer_get_time(void)
+{
+    return host_time_us;
+}
+
+void host_set_time_us(int64_t now_us)
+{
+    host_time_us = now_us;
+}
+
+void host_advance_time_us(int64_t delta_us)
+{
+    host_time_us += delta_us;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    return code == ESP_OK ? "ESP_OK" : "ESP_ERR";
+}
+
+uint16_t esp_rom_crc16_le(uint16_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+// Heap
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    return calloc(n, size);
+}
+
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    // aligned_alloc() wants the size to be a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+// Tasks
+struct host_task {
+    TaskFunction_t fn;
+    void *arg;
+    uint32_t notifications;
+};
+
+// Thrown by ulTaskNotifyTake() to return from host_run_task()
+struct HostTaskBlocked {};
+
+static std::vector<host_task *> host_tasks;
+static host_task *running_task = nullptr;
+static bool running_woken      = false;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char *name,
+                                   uint32_t stack,
+                                   void *arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t *handle,
+                                   BaseType_t core)
+{
+    host_task *task = new host_task{fn, arg, 0};
+    host_tasks.push_back(task);
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    if (task) {
+        task->notifications++;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout)
+{
+    if (running_task == nullptr) {
+        return 0;
+    }
+    if (running_woken) {
+        throw HostTaskBlocked();
+    }
+    running_woken  = true;
+    uint32_t taken = running_task->notifications;
+    running_task->notifications = clear ? 0 : (taken ? taken - 1 : 0);
+    return taken;
+}
+
+uint32_t host_run_task(TaskHandle_t task)
+{
+    uint32_t pending = task->notifications;
+    running_task     = task;
+    running_woken    = false;
+    try {
+        task->fn(task->arg);
+    }
+    catch (const HostTaskBlocked &) {
+    }
+    running_task = nullptr;
+    return pending;
+}
+
+TaskHandle_t host_last_task(void)
+{
+    return host_tasks.empty() ? nullptr : host_tasks.back();
+}
+
+// Mutexes
+struct host_semaphore {
+    int taken;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return new host_semaphore{0};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout)
+{
+    sem->taken++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    sem->taken--;
+    return pdTRUE;
+}
+
+// Flash
+static esp_partition_t host_partition;
+static std::vector<uint8_t> host_flash;
+static host_flash_stats_t flash_stats;
+
+void host_partition_create(const char *label, esp_partition_subtype_t subtype, size_t size)
+{
+    memset(&host_partition, 0, sizeof(host_partition));
+    host_partition.type       = ESP_PARTITION_TYPE_DATA;
+    host_partition.subtype    = subtype;
+    host_partition.size       = size;
+    host_partition.erase_size = HOST_FLASH_SECTOR_SIZE;
+    strncpy(host_partition.label, label, sizeof(host_partition.label) - 1);
+    host_flash.assign(size, 0xFF);
+    memset(&flash_stats, 0, sizeof(flash_stats));
+}
+
+uint8_t *host_partition_data(void)
+{
+    return host_flash.data();
+}
+
+host_flash_stats_t host_flash_stats(void)
+{
+    return flash_stats;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    if (host_flash.empty() || type != host_partition.type || subtype != host_partition.subtype ||
+        (label && strcmp(label, host_partition.label) != 0)) {
+        return nullptr;
+    }
+    return &host_partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition,
+                             size_t offset,
+                             void *dst,
+                             size_t size)
+{
+    if (partition != &host_partition || offset + size > host_flash.size()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(dst, &host_flash[offset], size);
+    flash_stats.reads++;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition,
+                              size_t offset,
+                              const void *src,
+                              size_t size)
+{
+    if (partition != &host_partition || offset + size > host_flash.size()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint8_t *p = (const uint8_t *)src;
+    for (size_t i = 0; i < size; i++) {
+        host_flash[offset + i] &= p[i];
+    }
+    flash_stats.writes++;
+    if (size > 0 && offset / HOST_FLASH_PAGE_SIZE != (offset + size - 1) / HOST_FLASH_PAGE_SIZE) {
+        flash_stats.straddling_writes++;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (partition != &host_partition || offset % HOST_FLASH_SECTOR_SIZE != 0 ||
+        size % HOST_FLASH_SECTOR_SIZE != 0 || offset + size > host_flash.size()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&host_flash[offset], 0xFF, size);
+    flash_stats.erases++;
+    return ESP_OK;
+}
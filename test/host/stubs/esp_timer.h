@@ -0,0 +1,11 @@
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <cstdint>
+
+// Host build: time only moves when a test sets it
+int64_t esp_timer_get_time(void);
+void host_set_time_us(int64_t now_us);
+void host_advance_time_us(int64_t delta_us);
+
+#endif /* ESP_TIMER_H */
@@ -0,0 +1,17 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <cstdint>
+
+// Host build: one tick per millisecond
+typedef int BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffu)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif /* FREERTOS_H */
@@ -0,0 +1,34 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+// Host build: tasks are created but only run inside host_run_task(), which returns
+// when the task waits for its next notification
+typedef void (*TaskFunction_t)(void*);
+typedef struct host_task* TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char* name,
+                                   uint32_t stack,
+                                   void* arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* handle,
+                                   BaseType_t core);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout);
+
+/**
+ * @brief Run a task created with xTaskCreatePinnedToCore() for one wakeup
+ *
+ * @param task Task to run
+ * @return Notifications the task had pending when it was woken
+ */
+uint32_t host_run_task(TaskHandle_t task);
+
+/**
+ * @brief The task created last, for modules that keep their handle private
+ */
+TaskHandle_t host_last_task(void);
+
+#endif /* TASK_H */
@@ -0,0 +1,35 @@
+#ifndef HARDWARE_CONTROL_H
+#define HARDWARE_CONTROL_H
+
+#include <cstdint>
+
+#include "esp_attr.h"
+
+#define SSR_COUNT 4
+
+// Host build: records the cutoff calls the dosing code makes
+class HardwareControl {
+public:
+    uint32_t cut_calls     = 0;
+    uint32_t release_calls = 0;
+    uint32_t cutoff_mask   = 0;
+    bool pump_cutoff       = false;
+
+    void IRAM_ATTR cutPumpFromIsr(uint32_t ssr_mask)
+    {
+        cut_calls++;
+        cutoff_mask |= ssr_mask;
+        pump_cutoff = true;
+    }
+
+    void releasePumpCutoff()
+    {
+        release_calls++;
+        cutoff_mask = 0;
+        pump_cutoff = false;
+    }
+};
+
+extern HardwareControl hw;
+
+#endif /* HARDWARE_CONTROL_H */
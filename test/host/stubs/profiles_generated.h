@@ -0,0 +1,10 @@
+// Host build: tests run the profile engine over their own segment tables
+#pragma once
+
+#include "profile/profile_engine.h"
+
+static const profile_t PROFILE_TABLE[] = {
+    {"HOST", nullptr, 0},
+};
+
+#define PROFILE_COUNT 0
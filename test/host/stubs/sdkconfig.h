@@ -0,0 +1,6 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// Host build: no CONFIG_IDF_TARGET_*, so target-specific code paths are compiled out
+
+#endif /* SDKCONFIG_H */
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "common/fixed_format.h"
+#include "host_bench.h"
+
+static std::string format_int(int32_t value, uint8_t decimals, uint8_t width, const char* suffix)
+{
+    const fixed_format_t format = {decimals, width, suffix};
+    char buf[FIXED_FORMAT_MAX_CHARS];
+    size_t n = fixed_format_int(buf, sizeof(buf), value, &format);
+    EXPECT_EQ(n, strlen(buf));
+    return buf;
+}
+
+static std::string format_float(float value, uint8_t decimals, uint8_t width, const char* suffix)
+{
+    const fixed_format_t format = {decimals, width, suffix};
+    char buf[FIXED_FORMAT_MAX_CHARS];
+    size_t n = fixed_format_float(buf, sizeof(buf), value, &format);
+    EXPECT_EQ(n, strlen(buf));
+    return buf;
+}
+
+TEST(FixedFormatTest, FormatsFixedPoint)
+{
+    EXPECT_EQ(format_int(901, 1, 0, nullptr), "90.1");
+    EXPECT_EQ(format_int(5, 2, 0, nullptr), "0.05");
+    EXPECT_EQ(format_int(42, 0, 0, nullptr), "42");
+    EXPECT_EQ(format_int(0, 0, 0, nullptr), "0");
+    EXPECT_EQ(format_int(-1234, 3, 0, nullptr), "-1.234");
+    EXPECT_EQ(format_int(INT32_MIN, 0, 0, nullptr), "-2147483648");
+}
+
+TEST(FixedFormatTest, PadsAndAppendsTheSuffix)
+{
+    EXPECT_EQ(format_int(901, 1, 6, " °C"), "  90.1 °C");
+    EXPECT_EQ(format_int(-5, 1, 6, nullptr), "  -0.5");
+    EXPECT_EQ(format_int(123456, 1, 4, nullptr), "12345.6");
+}
+
+TEST(FixedFormatTest, ShowsNoNegativeZero)
+{
+    EXPECT_EQ(format_int(0, 1, 0, nullptr), "0.0");
+    EXPECT_EQ(format_float(-0.04f, 1, 0, nullptr), "0.0");
+}
+
+TEST(FixedFormatTest, RejectsSmallBuffers)
+{
+    const fixed_format_t format = {1, 6, " PSI"};
+    char buf[10];
+    EXPECT_EQ(fixed_format_int(buf, sizeof(buf), 901, &format), 0u);
+    EXPECT_STREQ(buf, "");
+    EXPECT_EQ(fixed_format_int(buf, sizeof(buf) + 1, 901, &format), 10u);
+
+    const fixed_format_t too_precise = {FIXED_FORMAT_MAX_DECIMALS + 1, 0, nullptr};
+    EXPECT_EQ(fixed_format_int(buf, sizeof(buf), 1, &too_precise), 0u);
+}
+
+TEST(FixedFormatTest, RoundsHalvesAwayFromZero)
+{
+    EXPECT_EQ(format_float(0.25f, 1, 0, nullptr), "0.3");
+    EXPECT_EQ(format_float(-0.25f, 1, 0, nullptr), "-0.3");
+    EXPECT_EQ(format_float(2.5f, 0, 0, nullptr), "3");
+    EXPECT_EQ(format_float(99.96f, 1, 0, nullptr), "100.0");
+}
+
+TEST(FixedFormatTest, ShowsDashesForUnrepresentableValues)
+{
+    EXPECT_EQ(format_float(NAN, 1, 5, " mL"), "   -- mL");
+    EXPECT_EQ(format_float(1e10f, 1, 0, nullptr), "--");
+    EXPECT_EQ(format_float(-1e10f, 0, 0, nullptr), "--");
+}
+
+// Readouts must look exactly as they did with snprintf, apart from exact halves and
+// negative zero where the formatter deliberately differs
+TEST(FixedFormatTest, MatchesSnprintf)
+{
+    const char* suffix = " mL/min";
+    int compared       = 0;
+    for (uint8_t decimals = 0; decimals <= 3; decimals++) {
+        for (int i = 0; i < 20000; i++) {
+            float value  = -50.0f + i * 0.0525f;
+            double exact = fabs((double)value) * pow(10.0, decimals);
+            if (exact - floor(exact) == 0.5 || exact < 0.5) {
+                continue;
+            }
+
+            char expected[FIXED_FORMAT_MAX_CHARS];
+            snprintf(expected, sizeof(expected), "%*.*f%s", 8, decimals, value, suffix);
+            ASSERT_EQ(format_float(value, decimals, 8, suffix), expected) << value;
+            compared++;
+        }
+    }
+    EXPECT_GT(compared, 70000);
+}
+
+// Same readouts as fixed_format_benchmark() on the target: flow from -50 to 1000 mL/min
+TEST(FixedFormatBenchmark, AgainstSnprintf)
+{
+    const fixed_format_t format = {1, 6, " mL/min"};
+    const int values            = 1000;
+    const float step            = 1050.0f / values;
+    char buf[FIXED_FORMAT_MAX_CHARS];
+
+    // The checksum keeps the calls from being optimized out
+    volatile uint32_t checksum = 0;
+
+    double fixed_float_us = host_bench_us([&] {
+        for (int i = 0; i < values; i++) {
+            checksum = checksum + fixed_format_float(buf, sizeof(buf), -50.0f + i * step, &format);
+        }
+    });
+    double fixed_int_us = host_bench_us([&] {
+        for (int i = 0; i < values; i++) {
+            checksum = checksum + fixed_format_int(buf, sizeof(buf), i * 21 - 500, &format);
+        }
+    });
+    double printf_us = host_bench_us([&] {
+        for (int i = 0; i < values; i++) {
+            checksum = checksum + snprintf(buf,
+                                           sizeof(buf),
+                                           "%*.*f%s",
+                                           format.width,
+                                           format.decimals,
+                                           -50.0f + i * step,
+                                           format.suffix);
+        }
+    });
+
+    host_bench_report("fixed_format_float", fixed_float_us * 1000.0 / values, "ns/call");
+    host_bench_report("fixed_format_int", fixed_int_us * 1000.0 / values, "ns/call");
+    host_bench_report("snprintf %*.*f%s", printf_us * 1000.0 / values, "ns/call");
+    host_bench_report("speedup float over snprintf", printf_us / fixed_float_us, "x");
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "hardware/gpio_claims.h"
+
+TEST(GpioClaimsTest, SecondClaimOfAPinIsRefused)
+{
+    GpioClaims claims;
+    EXPECT_EQ(claims.claim(12, "lcd"), ESP_OK);
+    EXPECT_EQ(claims.claim(12, "dimmer"), ESP_ERR_INVALID_STATE);
+    EXPECT_STREQ(claims.user(12), "lcd");
+    EXPECT_EQ(claims.user(13), nullptr);
+}
+
+TEST(GpioClaimsTest, UnconnectedPinsAreAcceptedAndInvalidOnesRefused)
+{
+    GpioClaims claims;
+    EXPECT_EQ(claims.claim(-1, "max6675"), ESP_OK);
+    EXPECT_EQ(claims.claim(-1, "lcd"), ESP_OK);
+    EXPECT_EQ(claims.claim(GPIO_CLAIM_PIN_COUNT, "lcd"), ESP_ERR_INVALID_ARG);
+    EXPECT_EQ(claims.user(-1), nullptr);
+}
+
+TEST(GpioClaimsTest, ClaimAllTakesNothingOnAConflict)
+{
+    GpioClaims claims;
+    ASSERT_EQ(claims.claim(14, "flow meter 1"), ESP_OK);
+
+    const int pins[] = {11, 12, -1, 14, 15};
+    EXPECT_EQ(claims.claimAll(pins, 5, "lcd"), ESP_ERR_INVALID_STATE);
+    EXPECT_EQ(claims.user(11), nullptr);
+    EXPECT_EQ(claims.user(12), nullptr);
+    EXPECT_STREQ(claims.user(14), "flow meter 1");
+    EXPECT_EQ(claims.user(15), nullptr);
+
+    claims.release(14);
+    EXPECT_EQ(claims.claimAll(pins, 5, "lcd"), ESP_OK);
+    for (int pin : {11, 12, 14, 15}) {
+        EXPECT_STREQ(claims.user(pin), "lcd") << "GPIO " << pin;
+    }
+}
+
+TEST(GpioClaimsTest, ClaimAllRefusesAPinListedTwice)
+{
+    GpioClaims claims;
+    const int pins[] = {2, 5, 2};
+    EXPECT_EQ(claims.claimAll(pins, 3, "touch"), ESP_ERR_INVALID_STATE);
+    EXPECT_EQ(claims.user(2), nullptr);
+    EXPECT_EQ(claims.user(5), nullptr);
+}
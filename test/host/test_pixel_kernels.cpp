@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "display/pixel_kernels.h"
+#include "host_bench.h"
+#include "tft_config.h"
+
+// The host has no CONFIG_IDF_TARGET_ESP32S3, so these cover the portable kernels that
+// also handle the unaligned heads and tails of the PIE paths on the target.
+
+// Offsets into a 16-byte aligned buffer and lengths around the PIE block size
+static const int OFFSETS[] = {0, 1, 2, 3, 7, 8};
+static const size_t COUNTS[] = {0, 1, 2, 3, 15, 16, 17, 31, 33, 64, 101};
+
+// Room for the largest offset and count, plus guard pixels on either side
+#define TEST_BUFFER_PIXELS 160
+#define GUARD 0xDEAD
+
+static uint16_t ref_swap(uint16_t px)
+{
+    return (uint16_t)((px << 8) | (px >> 8));
+}
+
+class PixelKernelsTest : public ::testing::Test {
+protected:
+    alignas(16) uint16_t dst[TEST_BUFFER_PIXELS];
+    alignas(16) uint16_t src[TEST_BUFFER_PIXELS];
+    alignas(16) uint8_t indices[TEST_BUFFER_PIXELS];
+    uint16_t palette[256];
+
+    void SetUp() override
+    {
+        for (int i = 0; i < TEST_BUFFER_PIXELS; i++) {
+            src[i]     = (uint16_t)(i * 0x0123 + 0x4567);
+            indices[i] = (uint8_t)(i * 37 + 11);
+        }
+        for (int i = 0; i < 256; i++) {
+            palette[i] = (uint16_t)(i * 0x0101 ^ 0x5A5A);
+        }
+    }
+
+    void guard() { std::fill(dst, dst + TEST_BUFFER_PIXELS, (uint16_t)GUARD); }
+
+    // Pixels outside [offset, offset + count) must be untouched
+    void expectGuards(int offset, size_t count)
+    {
+        for (int i = 0; i < TEST_BUFFER_PIXELS; i++) {
+            if (i < offset || i >= offset + (int)count) {
+                ASSERT_EQ(dst[i], GUARD) << "Pixel " << i << " written outside the span";
+            }
+        }
+    }
+};
+
+TEST_F(PixelKernelsTest, FillWritesExactlyTheSpan)
+{
+    for (int offset : OFFSETS) {
+        for (size_t count : COUNTS) {
+            guard();
+            pixel_fill_rgb565(dst + offset, 0x1234, count);
+            for (size_t i = 0; i < count; i++) {
+                ASSERT_EQ(dst[offset + i], 0x1234) << "offset " << offset << " count " << count;
+            }
+            expectGuards(offset, count);
+        }
+    }
+}
+
+TEST_F(PixelKernelsTest, CopySwapMatchesReference)
+{
+    for (int dst_offset : OFFSETS) {
+        for (int src_offset : OFFSETS) {
+            for (size_t count : COUNTS) {
+                guard();
+                pixel_copy_swap_rgb565(dst + dst_offset, src + src_offset, count);
+                for (size_t i = 0; i < count; i++) {
+                    ASSERT_EQ(dst[dst_offset + i], ref_swap(src[src_offset + i]))
+                        << "dst offset " << dst_offset << " src offset " << src_offset
+                        << " count " << count << " pixel " << i;
+                }
+                expectGuards(dst_offset, count);
+            }
+        }
+    }
+}
+
+TEST_F(PixelKernelsTest, CopySwapInPlaceRoundTrips)
+{
+    for (int offset : OFFSETS) {
+        std::memcpy(dst, src, sizeof(dst));
+        pixel_copy_swap_rgb565(dst + offset, dst + offset, 101);
+        for (int i = 0; i < 101; i++) {
+            ASSERT_EQ(dst[offset + i], ref_swap(src[offset + i]));
+        }
+        pixel_copy_swap_rgb565(dst + offset, dst + offset, 101);
+        EXPECT_EQ(std::memcmp(dst, src, sizeof(dst)), 0);
+    }
+}
+
+TEST_F(PixelKernelsTest, Index8ExpandsThroughThePalette)
+{
+    for (int dst_offset : OFFSETS) {
+        for (int src_offset : OFFSETS) {
+            for (size_t count : COUNTS) {
+                guard();
+                pixel_index8_to_rgb565(dst + dst_offset, indices + src_offset, palette, count);
+                for (size_t i = 0; i < count; i++) {
+                    ASSERT_EQ(dst[dst_offset + i], palette[indices[src_offset + i]])
+                        << "dst offset " << dst_offset << " src offset " << src_offset
+                        << " count " << count << " pixel " << i;
+                }
+                expectGuards(dst_offset, count);
+            }
+        }
+    }
+}
+
+TEST(PixelMixTest, EndpointsAreExact)
+{
+    EXPECT_EQ(pixel_mix_rgb565(0x1234, 0xFEDC, 0), 0x1234);
+    EXPECT_EQ(pixel_mix_rgb565(0x1234, 0xFEDC, 255), 0xFEDC);
+    EXPECT_EQ(pixel_mix_rgb565(0xFFFF, 0x0000, 255), 0x0000);
+}
+
+TEST(PixelMixTest, MatchesFloatBlendPerChannel)
+{
+    // 5-bit alpha and truncation: each channel may be off by up to 2 of its own LSBs
+    const uint16_t colors[] = {0x0000, 0xFFFF, 0xF800, 0x07E0, 0x001F, 0x1E1E, 0x8410, 0x39E7};
+    for (uint16_t bg : colors) {
+        for (uint16_t fg : colors) {
+            for (int alpha = 0; alpha <= 255; alpha += 17) {
+                uint16_t px = pixel_mix_rgb565(bg, fg, (uint8_t)alpha);
+                const int shifts[] = {11, 5, 0};
+                const int masks[]  = {0x1F, 0x3F, 0x1F};
+                for (int c = 0; c < 3; c++) {
+                    float b   = (bg >> shifts[c]) & masks[c];
+                    float f   = (fg >> shifts[c]) & masks[c];
+                    float ref = b + (f - b) * alpha / 255.0f;
+                    int got   = (px >> shifts[c]) & masks[c];
+                    ASSERT_NEAR(got, ref, 2.0f) << "bg " << bg << " fg " << fg << " alpha "
+                                                << alpha << " channel " << c;
+                }
+            }
+        }
+    }
+}
+
+// Same working set as pixel_kernels_benchmark() on the target: 16 full-width lines
+TEST(PixelKernelsBenchmark, MegapixelsPerSecond)
+{
+    const size_t pixels = TFT_WIDTH * 16;
+    std::vector<uint16_t> a(pixels + 8), b(pixels + 8), palette(256);
+    std::vector<uint8_t> idx(pixels);
+    for (size_t i = 0; i < pixels; i++) {
+        a[i]   = (uint16_t)rand();
+        idx[i] = (uint8_t)rand();
+    }
+
+    auto mps = [&](double us) { return pixels / us; };
+
+    host_bench_report("fill",
+                      mps(host_bench_us([&] { pixel_fill_rgb565(b.data(), 0x1234, pixels); })),
+                      "MP/s");
+    host_bench_report(
+        "copy swap",
+        mps(host_bench_us([&] { pixel_copy_swap_rgb565(b.data(), a.data(), pixels); })),
+        "MP/s");
+    host_bench_report(
+        "copy swap unaligned",
+        mps(host_bench_us([&] { pixel_copy_swap_rgb565(b.data() + 1, a.data(), pixels); })),
+        "MP/s");
+    host_bench_report("index8 to rgb565",
+                      mps(host_bench_us([&] {
+                          pixel_index8_to_rgb565(b.data(), idx.data(), palette.data(), pixels);
+                      })),
+                      "MP/s");
+    host_bench_report("mix 50%",
+                      mps(host_bench_us([&] {
+                          for (size_t i = 0; i < pixels; i++) {
+                              b[i] = pixel_mix_rgb565(b[i], 0x1E1E, 128);
+                          }
+                      })),
+                      "MP/s");
+    host_bench_report(
+        "memcpy reference",
+        mps(host_bench_us([&] { memcpy(b.data(), a.data(), pixels * sizeof(uint16_t)); })),
+        "MP/s");
+}
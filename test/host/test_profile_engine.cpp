@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include "profile/profile_engine.h"
+
+// Preinfuse at 30 PSI for 5 s, ramp to 130 PSI over 4 s, hold until 36 mL or 30 s
+static const profile_segment_t CLASSIC_SEGMENTS[] = {
+    {PROFILE_SEG_STEP, PROFILE_EXIT_TIME, 30.0f, 0, 5000, 0.0f, 0.0f, "PREINFUSE"},
+    {PROFILE_SEG_RAMP, PROFILE_EXIT_TIME, 130.0f, 4000, 4000, 0.0f, 0.0f, "RAMP"},
+    {PROFILE_SEG_HOLD,
+     PROFILE_EXIT_TIME | PROFILE_EXIT_VOLUME,
+     0.0f,
+     0,
+     30000,
+     36.0f,
+     0.0f,
+     "EXTRACT"},
+};
+
+// Fill until the puck is pressurized, then bloom until pressure has decayed
+static const profile_segment_t BLOOM_SEGMENTS[] = {
+    {PROFILE_SEG_STEP,
+     PROFILE_EXIT_TIME | PROFILE_EXIT_PRESSURE_ABOVE,
+     45.0f,
+     0,
+     12000,
+     0.0f,
+     35.0f,
+     "FILL"},
+    {PROFILE_SEG_STEP,
+     PROFILE_EXIT_TIME | PROFILE_EXIT_PRESSURE_BELOW,
+     0.0f,
+     0,
+     30000,
+     0.0f,
+     10.0f,
+     "BLOOM"},
+    {PROFILE_SEG_RAMP, PROFILE_EXIT_TIME, 120.0f, 2000, 6000, 0.0f, 0.0f, "RAMP"},
+};
+
+static const profile_t PROFILES[] = {
+    {"CLASSIC", CLASSIC_SEGMENTS, 3},
+    {"BLOOM", BLOOM_SEGMENTS, 3},
+    {"EMPTY", nullptr, 0},
+};
+
+class ProfileEngineTest : public ::testing::Test {
+protected:
+    ProfileEngine engine{PROFILES, 3};
+
+    profile_status_t status() const
+    {
+        profile_status_t s;
+        engine.getStatus(&s);
+        return s;
+    }
+};
+
+TEST_F(ProfileEngineTest, FindsProfilesByName)
+{
+    EXPECT_EQ(engine.count(), 3);
+    EXPECT_EQ(engine.find("BLOOM"), 1);
+    EXPECT_EQ(engine.find("TURBO"), -1);
+    EXPECT_EQ(engine.get(3), nullptr);
+    EXPECT_EQ(engine.get(-1), nullptr);
+}
+
+TEST_F(ProfileEngineTest, RefusesMissingOrEmptyProfiles)
+{
+    EXPECT_FALSE(engine.start(3, 0));
+    EXPECT_FALSE(engine.start(2, 0));
+    EXPECT_FALSE(engine.isRunning());
+    EXPECT_FLOAT_EQ(engine.tick(100, 0.0f, 0.0f), 0.0f);
+    EXPECT_STREQ(status().segment_name, "IDLE");
+}
+
+TEST_F(ProfileEngineTest, RunsSegmentsInOrder)
+{
+    ASSERT_TRUE(engine.start(0, 1000));
+    EXPECT_FLOAT_EQ(engine.tick(1000, 0.0f, 0.0f), 30.0f);
+    EXPECT_FLOAT_EQ(engine.tick(5999, 25.0f, 1.0f), 30.0f);
+    EXPECT_STREQ(status().segment_name, "PREINFUSE");
+
+    // The ramp starts from where preinfusion ended
+    EXPECT_FLOAT_EQ(engine.tick(6000, 30.0f, 2.0f), 30.0f);
+    EXPECT_STREQ(status().segment_name, "RAMP");
+    EXPECT_FLOAT_EQ(engine.tick(8000, 80.0f, 5.0f), 80.0f);
+    EXPECT_FLOAT_EQ(engine.tick(9999, 120.0f, 8.0f), 129.975f);
+
+    // Hold keeps the setpoint the ramp ended at
+    engine.tick(10000, 130.0f, 9.0f);
+    EXPECT_STREQ(status().segment_name, "EXTRACT");
+    EXPECT_FLOAT_EQ(engine.tick(20000, 130.0f, 20.0f), 130.0f);
+
+    profile_status_t s = status();
+    EXPECT_EQ(s.segment, 2);
+    EXPECT_EQ(s.shot_ms, 19000u);
+    EXPECT_EQ(s.segment_ms, 10000u);
+    EXPECT_FLOAT_EQ(s.volume_ml, 20.0f);
+}
+
+TEST_F(ProfileEngineTest, EndsOnTheVolume)
+{
+    ASSERT_TRUE(engine.start(0, 0));
+    engine.tick(5000, 30.0f, 2.0f);
+    engine.tick(9000, 130.0f, 8.0f);
+    EXPECT_FLOAT_EQ(engine.tick(15000, 130.0f, 35.9f), 130.0f);
+    EXPECT_TRUE(engine.isRunning());
+
+    EXPECT_FLOAT_EQ(engine.tick(15050, 130.0f, 36.0f), 0.0f);
+    EXPECT_FALSE(engine.isRunning());
+    EXPECT_EQ(status().state, PROFILE_STATE_DONE);
+    EXPECT_STREQ(status().segment_name, "DONE");
+}
+
+TEST_F(ProfileEngineTest, ExitsOnPressure)
+{
+    ASSERT_TRUE(engine.start(1, 0));
+    EXPECT_FLOAT_EQ(engine.tick(1000, 20.0f, 0.0f), 45.0f);
+    EXPECT_FLOAT_EQ(engine.tick(2000, 35.0f, 0.0f), 0.0f);
+    EXPECT_STREQ(status().segment_name, "BLOOM");
+
+    EXPECT_FLOAT_EQ(engine.tick(3000, 20.0f, 0.0f), 0.0f);
+    EXPECT_STREQ(status().segment_name, "BLOOM");
+    engine.tick(4000, 10.0f, 0.0f);
+    EXPECT_STREQ(status().segment_name, "RAMP");
+}
+
+TEST_F(ProfileEngineTest, MovesOnAtMostOneSegmentPerTick)
+{
+    // A late tick is past both the preinfusion and the ramp
+    ASSERT_TRUE(engine.start(0, 0));
+    engine.tick(0, 0.0f, 0.0f);
+    EXPECT_FLOAT_EQ(engine.tick(60000, 0.0f, 0.0f), 30.0f);
+    EXPECT_STREQ(status().segment_name, "RAMP");
+    engine.tick(60001, 0.0f, 0.0f);
+    EXPECT_STREQ(status().segment_name, "RAMP");
+}
+
+TEST_F(ProfileEngineTest, StopDropsTheSetpoint)
+{
+    ASSERT_TRUE(engine.start(0, 0));
+    engine.tick(1000, 30.0f, 1.0f);
+    engine.stop();
+
+    EXPECT_FALSE(engine.isRunning());
+    EXPECT_FLOAT_EQ(engine.tick(2000, 30.0f, 1.0f), 0.0f);
+    profile_status_t s = status();
+    EXPECT_EQ(s.state, PROFILE_STATE_IDLE);
+    EXPECT_EQ(s.profile, -1);
+    EXPECT_EQ(s.segment, -1);
+}
+
+TEST_F(ProfileEngineTest, RestartsFromTheFirstSegment)
+{
+    ASSERT_TRUE(engine.start(0, 0));
+    engine.tick(5000, 30.0f, 3.0f);
+    ASSERT_TRUE(engine.start(0, 10000));
+    EXPECT_FLOAT_EQ(engine.tick(10000, 0.0f, 0.0f), 30.0f);
+    profile_status_t s = status();
+    EXPECT_STREQ(s.segment_name, "PREINFUSE");
+    EXPECT_FLOAT_EQ(s.volume_ml, 0.0f);
+}
@@ -0,0 +1,416 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "display/raster.h"
+#include "host_bench.h"
+
+// Drawing white on black makes the green channel of each pixel its coverage. The
+// rasterizer works at 8-bit coverage and pixel_mix_rgb565 blends at 5-bit alpha, so a
+// pixel may differ from the float reference by a few of the 63 green steps.
+#define COVERAGE_TOLERANCE 0.1
+#define WHITE 0xFFFF
+#define GUARD 0xDEAD
+
+// Backing store around the surface under test, so writes outside it can be detected
+#define MARGIN 8
+
+static double fx_to_px(int32_t v)
+{
+    return v / (double)RASTER_FX_ONE;
+}
+
+static double clamp01(double v)
+{
+    return v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+}
+
+static double coverage_of(uint16_t px)
+{
+    return ((px >> 5) & 0x3F) / 63.0;
+}
+
+// Coverage the rasterizer aims for: one pixel of ramp across the edge of a capsule
+static double ref_line_coverage(double px, double py, double x0, double y0, double x1, double y1,
+                                double width)
+{
+    double dx = x1 - x0, dy = y1 - y0;
+    double len2 = dx * dx + dy * dy;
+    double t    = len2 > 0.0 ? ((px - x0) * dx + (py - y0) * dy) / len2 : 0.0;
+    t           = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    double dist = std::hypot(px - (x0 + t * dx), py - (y0 + t * dy));
+    return clamp01(width / 2 + 0.5 - dist);
+}
+
+static double ref_ring_coverage(double px, double py, double radius, double inner_radius)
+{
+    double dist    = std::hypot(px, py);
+    double c_outer = clamp01(radius + 0.5 - dist);
+    double c_inner = inner_radius > 0 ? clamp01(dist - inner_radius + 0.5) : 1.0;
+    return c_outer < c_inner ? c_outer : c_inner;
+}
+
+// A surface of the given size inside a larger buffer filled with GUARD
+class RasterTest : public ::testing::Test {
+protected:
+    std::vector<uint16_t> store;
+    raster_surface_t surface;
+    int store_width;
+
+    void makeSurface(int width, int height)
+    {
+        store_width = width + 2 * MARGIN;
+        store.assign((size_t)store_width * (height + 2 * MARGIN), GUARD);
+        surface = {&store[(size_t)MARGIN * store_width + MARGIN], width, height, store_width};
+        for (int y = 0; y < height; y++) {
+            std::fill_n(surface.pixels + (size_t)y * surface.stride, width, 0);
+        }
+    }
+
+    uint16_t at(int x, int y) const { return surface.pixels[(size_t)y * surface.stride + x]; }
+
+    void expectGuardsIntact()
+    {
+        for (int y = -MARGIN; y < surface.height + MARGIN; y++) {
+            for (int x = -MARGIN; x < surface.width + MARGIN; x++) {
+                if (x >= 0 && x < surface.width && y >= 0 && y < surface.height) {
+                    continue;
+                }
+                ASSERT_EQ(surface.pixels[(ptrdiff_t)y * surface.stride + x], GUARD)
+                    << "Pixel (" << x << ", " << y << ") written outside the surface";
+            }
+        }
+    }
+
+    // Compare every pixel against a reference coverage function of the pixel center
+    template <typename Ref>
+    void expectCoverage(Ref ref, uint32_t written)
+    {
+        uint32_t changed = 0;
+        for (int y = 0; y < surface.height; y++) {
+            for (int x = 0; x < surface.width; x++) {
+                double expected = ref(x + 0.5, y + 0.5);
+                ASSERT_NEAR(coverage_of(at(x, y)), expected, COVERAGE_TOLERANCE)
+                    << "Pixel (" << x << ", " << y << ")";
+                if (expected >= 1.0) {
+                    ASSERT_EQ(at(x, y), WHITE) << "Pixel (" << x << ", " << y << ")";
+                }
+                changed += at(x, y) != 0;
+            }
+        }
+        // Faint edge pixels may round to no visible change but still count as written
+        EXPECT_GE(written, changed);
+        expectGuardsIntact();
+    }
+
+    void expectLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t width)
+    {
+        uint32_t written = raster_line_aa(&surface, x0, y0, x1, y1, width, WHITE);
+        SCOPED_TRACE(testing::Message() << "line (" << fx_to_px(x0) << ", " << fx_to_px(y0)
+                                        << ") to (" << fx_to_px(x1) << ", " << fx_to_px(y1)
+                                        << ") width " << fx_to_px(width));
+        expectCoverage(
+            [&](double px, double py) {
+                return ref_line_coverage(px,
+                                         py,
+                                         fx_to_px(x0),
+                                         fx_to_px(y0),
+                                         fx_to_px(x1),
+                                         fx_to_px(y1),
+                                         fx_to_px(width));
+            },
+            written);
+    }
+};
+
+TEST_F(RasterTest, LinesMatchTheReferenceCoverage)
+{
+    // Horizontal, vertical, shallow, steep, diagonal and reversed, at fractional positions
+    const int32_t lines[][4] = {
+        {RASTER_FX(4.5), RASTER_FX(10.5), RASTER_FX(40.5), RASTER_FX(10.5)},
+        {RASTER_FX(20.5), RASTER_FX(3), RASTER_FX(20.5), RASTER_FX(28)},
+        {RASTER_FX(3.25), RASTER_FX(8.75), RASTER_FX(44.5), RASTER_FX(17.25)},
+        {RASTER_FX(12.3), RASTER_FX(2.1), RASTER_FX(19.7), RASTER_FX(29.4)},
+        {RASTER_FX(5), RASTER_FX(5), RASTER_FX(26), RASTER_FX(26)},
+        {RASTER_FX(40.5), RASTER_FX(25.5), RASTER_FX(6.5), RASTER_FX(4.25)},
+    };
+    const int32_t widths[] = {RASTER_FX(1), RASTER_FX(1.5), RASTER_FX(4), RASTER_FX(7.25)};
+
+    for (const auto &line : lines) {
+        for (int32_t width : widths) {
+            makeSurface(48, 32);
+            expectLine(line[0], line[1], line[2], line[3], width);
+        }
+    }
+}
+
+TEST_F(RasterTest, ZeroLengthLineIsARoundDot)
+{
+    makeSurface(16, 16);
+    expectLine(RASTER_FX(8), RASTER_FX(8), RASTER_FX(8), RASTER_FX(8), RASTER_FX(6));
+}
+
+TEST_F(RasterTest, LinesAreClippedToTheSurface)
+{
+    // Crossing every edge, starting and ending off the surface
+    const int32_t lines[][4] = {
+        {RASTER_FX(-20), RASTER_FX(5.5), RASTER_FX(50), RASTER_FX(12.5)},
+        {RASTER_FX(7.5), RASTER_FX(-15), RASTER_FX(12.5), RASTER_FX(40)},
+        {RASTER_FX(-10), RASTER_FX(-10), RASTER_FX(40), RASTER_FX(30)},
+        {RASTER_FX(31), RASTER_FX(2), RASTER_FX(33), RASTER_FX(18)},
+    };
+
+    for (const auto &line : lines) {
+        makeSurface(32, 20);
+        expectLine(line[0], line[1], line[2], line[3], RASTER_FX(5));
+    }
+}
+
+TEST_F(RasterTest, LinesOffTheSurfaceWriteNothing)
+{
+    makeSurface(32, 20);
+    EXPECT_EQ(raster_line_aa(
+                  &surface, RASTER_FX(-30), RASTER_FX(5), RASTER_FX(-6), RASTER_FX(15), RASTER_FX(4),
+                  WHITE),
+              0u);
+    EXPECT_EQ(raster_line_aa(
+                  &surface, RASTER_FX(5), RASTER_FX(26), RASTER_FX(25), RASTER_FX(40), RASTER_FX(4),
+                  WHITE),
+              0u);
+    EXPECT_EQ(raster_line_aa(
+                  &surface, RASTER_FX(5), RASTER_FX(5), RASTER_FX(25), RASTER_FX(15), 0, WHITE),
+              0u);
+    expectCoverage([](double, double) { return 0.0; }, 0);
+}
+
+TEST_F(RasterTest, PolylineCoversEverySegment)
+{
+    const raster_point_t points[] = {
+        {RASTER_FX(4.5), RASTER_FX(20.5)},
+        {RASTER_FX(16.5), RASTER_FX(6.5)},
+        {RASTER_FX(30.5), RASTER_FX(22.5)},
+        {RASTER_FX(44.5), RASTER_FX(10.5)},
+    };
+    const double width = 2.0;
+
+    makeSurface(48, 28);
+    uint32_t written = raster_polyline_aa(&surface, points, 4, RASTER_FX(width), WHITE);
+
+    // Joints are blended twice, so only away from them is the coverage a single segment's
+    auto ref = [&](double px, double py) {
+        double c = 0.0;
+        for (int i = 1; i < 4; i++) {
+            double s = ref_line_coverage(px,
+                                         py,
+                                         fx_to_px(points[i - 1].x),
+                                         fx_to_px(points[i - 1].y),
+                                         fx_to_px(points[i].x),
+                                         fx_to_px(points[i].y),
+                                         width);
+            c        = s > c ? s : c;
+        }
+        return c;
+    };
+    for (int y = 0; y < surface.height; y++) {
+        for (int x = 0; x < surface.width; x++) {
+            bool near_joint = false;
+            for (int i = 1; i < 3; i++) {
+                near_joint |= std::hypot(x + 0.5 - fx_to_px(points[i].x),
+                                         y + 0.5 - fx_to_px(points[i].y)) < width + 1.5;
+            }
+            double got = coverage_of(at(x, y));
+            if (near_joint) {
+                ASSERT_GE(got, ref(x + 0.5, y + 0.5) - COVERAGE_TOLERANCE);
+            }
+            else {
+                ASSERT_NEAR(got, ref(x + 0.5, y + 0.5), COVERAGE_TOLERANCE)
+                    << "Pixel (" << x << ", " << y << ")";
+            }
+        }
+    }
+    EXPECT_GT(written, 0u);
+    expectGuardsIntact();
+}
+
+TEST_F(RasterTest, IndexedLineSelectsRampSteps)
+{
+    const raster_ramp_t ramp = {16, 8, 0};
+    std::vector<uint8_t> pixels(48 * 32, 0);
+    raster_index8_surface_t indexed = {pixels.data(), 48, 32, 48};
+
+    const double x0 = 3.25, y0 = 8.75, x1 = 44.5, y1 = 17.25, width = 4.0;
+    uint32_t written = raster_line_aa_index8(
+        &indexed, RASTER_FX(x0), RASTER_FX(y0), RASTER_FX(x1), RASTER_FX(y1), RASTER_FX(width),
+        &ramp);
+
+    uint32_t changed = 0;
+    for (int y = 0; y < indexed.height; y++) {
+        for (int x = 0; x < indexed.width; x++) {
+            double c   = ref_line_coverage(x + 0.5, y + 0.5, x0, y0, x1, y1, width);
+            uint8_t px = pixels[(size_t)y * indexed.stride + x];
+            // Step k holds (k + 1) / steps coverage; allow one step of rounding
+            double got = px == ramp.background ? 0.0 : (px - ramp.base + 1) / (double)ramp.steps;
+            ASSERT_TRUE(px == ramp.background || (px >= ramp.base && px < ramp.base + ramp.steps));
+            ASSERT_NEAR(got, c, 1.0 / ramp.steps + COVERAGE_TOLERANCE)
+                << "Pixel (" << x << ", " << y << ")";
+            changed += px != ramp.background;
+        }
+    }
+    EXPECT_EQ(written, changed);
+}
+
+TEST(RasterArcTableTest, RejectsRadiiOutOfRange)
+{
+    raster_arc_table_t table;
+    EXPECT_FALSE(raster_arc_table_init(&table, 0, 0));
+    EXPECT_FALSE(raster_arc_table_init(&table, RASTER_ARC_MAX_RADIUS + 1, 0));
+    EXPECT_FALSE(raster_arc_table_init(&table, 20, 20));
+    EXPECT_FALSE(raster_arc_table_init(&table, 20, -1));
+    EXPECT_TRUE(raster_arc_table_init(&table, RASTER_ARC_MAX_RADIUS, 0));
+}
+
+TEST_F(RasterTest, RingsAndDiscsMatchTheReferenceCoverage)
+{
+    const int radii[][2] = {{1, 0}, {6, 0}, {20, 0}, {20, 14}, {30, 27}, {30, 1}};
+    raster_arc_table_t table;
+
+    for (const auto &r : radii) {
+        SCOPED_TRACE(testing::Message() << "radius " << r[0] << " inner " << r[1]);
+        ASSERT_TRUE(raster_arc_table_init(&table, r[0], r[1]));
+        makeSurface(2 * r[0] + 6, 2 * r[0] + 6);
+        int c            = r[0] + 3;
+        uint32_t written = raster_arc_aa(&surface, &table, c, c, 0, 360, WHITE);
+        expectCoverage(
+            [&](double px, double py) { return ref_ring_coverage(px - c, py - c, r[0], r[1]); },
+            written);
+    }
+}
+
+TEST_F(RasterTest, ArcsFollowTheirAngles)
+{
+    // Gauge sweep, a narrow arc, one across 12 o'clock and one wider than a half turn
+    const int arcs[][2] = {{-135, 135}, {30, 60}, {-20, 20}, {90, 300}, {200, 250}};
+    const int radius = 30, inner_radius = 22, c = 34;
+    raster_arc_table_t table;
+    ASSERT_TRUE(raster_arc_table_init(&table, radius, inner_radius));
+
+    for (const auto &arc : arcs) {
+        SCOPED_TRACE(testing::Message() << "arc " << arc[0] << " to " << arc[1]);
+        makeSurface(2 * c, 2 * c);
+        raster_arc_aa(&surface, &table, c, c, arc[0], arc[1], WHITE);
+
+        for (int y = 0; y < surface.height; y++) {
+            for (int x = 0; x < surface.width; x++) {
+                double px = x + 0.5 - c, py = y + 0.5 - c;
+                double ring = ref_ring_coverage(px, py, radius, inner_radius);
+                double got  = coverage_of(at(x, y));
+
+                // Clockwise from 12 o'clock, relative to the start of the arc
+                double angle = std::atan2(px, -py) * 180.0 / M_PI - arc[0];
+                angle        = std::fmod(std::fmod(angle, 360.0) + 360.0, 360.0);
+                double sweep = arc[1] - arc[0];
+
+                // The ends are antialiased half-planes through the center, so only pixels
+                // clear of both boundary lines have a known coverage
+                double dist       = std::hypot(px, py);
+                double from_start = dist * std::fabs(std::sin(angle * M_PI / 180.0));
+                double from_end   = dist * std::fabs(std::sin((angle - sweep) * M_PI / 180.0));
+                if (from_start < 1.5 || from_end < 1.5) {
+                    continue;
+                }
+                double expected = angle < sweep ? ring : 0.0;
+                ASSERT_NEAR(got, expected, COVERAGE_TOLERANCE)
+                    << "Pixel (" << x << ", " << y << ")";
+            }
+        }
+        expectGuardsIntact();
+    }
+}
+
+TEST_F(RasterTest, EmptySweepDrawsNothing)
+{
+    raster_arc_table_t table;
+    ASSERT_TRUE(raster_arc_table_init(&table, 10, 5));
+    makeSurface(24, 24);
+    EXPECT_EQ(raster_arc_aa(&surface, &table, 12, 12, 90, 90, WHITE), 0u);
+    EXPECT_EQ(raster_arc_aa(&surface, &table, 12, 12, 90, 45, WHITE), 0u);
+    expectCoverage([](double, double) { return 0.0; }, 0);
+}
+
+TEST_F(RasterTest, ArcsAreClippedToTheSurface)
+{
+    raster_arc_table_t table;
+    ASSERT_TRUE(raster_arc_table_init(&table, 20, 12));
+
+    // Centers on each corner, on an edge and off the surface entirely
+    const int centers[][2] = {{0, 0}, {30, 0}, {0, 24}, {30, 24}, {15, -8}, {-21, 12}, {60, 60}};
+    for (const auto &center : centers) {
+        SCOPED_TRACE(testing::Message() << "center (" << center[0] << ", " << center[1] << ")");
+        makeSurface(30, 24);
+        uint32_t written = raster_arc_aa(&surface, &table, center[0], center[1], 0, 360, WHITE);
+        expectCoverage(
+            [&](double px, double py) {
+                return ref_ring_coverage(px - center[0], py - center[1], 20, 12);
+            },
+            written);
+    }
+}
+
+// Same workload as raster_benchmark() on the target: cost of one primitive and
+// throughput in pixels written per second
+TEST(RasterBenchmark, PrimitiveCostAndThroughput)
+{
+    std::vector<uint16_t> pixels(240 * 200, 0);
+    raster_surface_t surface = {pixels.data(), 240, 200, 240};
+
+    raster_point_t points[120];
+    for (int i = 0; i < 120; i++) {
+        points[i].x = RASTER_FX(i * 2) + RASTER_FX_ONE / 2;
+        points[i].y = RASTER_FX(180 - i) + ((i & 1) ? RASTER_FX(6) : 0);
+    }
+    raster_arc_table_t table;
+    raster_arc_table_init(&table, 90, 78);
+
+    // Batches of n primitives, so the per-call variation matches the target benchmark
+    auto bench = [](const char *name, int n, auto draw) {
+        uint32_t batch_pixels = 0;
+        double us             = host_bench_us([&] {
+            batch_pixels = 0;
+            for (int iter = 0; iter < n; iter++) {
+                batch_pixels += draw(iter);
+            }
+        });
+        host_bench_report((std::string(name) + " cost").c_str(), us / n, "us");
+        host_bench_report(name, batch_pixels / us, "MP/s");
+    };
+
+    bench("line 100px w1.5", 500, [&](int iter) {
+        return raster_line_aa(&surface,
+                              RASTER_FX(10 + (iter % 40)),
+                              RASTER_FX(20),
+                              RASTER_FX(100 + (iter % 40)),
+                              RASTER_FX(60),
+                              RASTER_FX(1.5),
+                              0xFAC0);
+    });
+    bench("line 100px w4", 500, [&](int iter) {
+        return raster_line_aa(&surface,
+                              RASTER_FX(10),
+                              RASTER_FX(20 + (iter % 40)),
+                              RASTER_FX(110),
+                              RASTER_FX(40 + (iter % 40)),
+                              RASTER_FX(4),
+                              0xF945);
+    });
+    bench("polyline 120 points", 50, [&](int) {
+        return raster_polyline_aa(&surface, points, 120, RASTER_FX(1.5), 0x045B);
+    });
+    bench("arc r90 w12 270deg", 50, [&](int) {
+        return raster_arc_aa(&surface, &table, 120, 100, -135, 135, 0x045B);
+    });
+    bench("ring r90 w12", 50, [&](int) {
+        return raster_arc_aa(&surface, &table, 120, 100, 0, 360, 0x2945);
+    });
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "common/seqlock.h"
+
+// Every field holds the same value, so a torn read shows as a mismatch
+struct Snapshot {
+    uint32_t fields[32];
+};
+
+static Snapshot make(uint32_t value)
+{
+    Snapshot s;
+    for (auto& f : s.fields) {
+        f = value;
+    }
+    return s;
+}
+
+TEST(SeqlockMailboxTest, ReadsZeroBeforeThePublish)
+{
+    SeqlockMailbox<Snapshot> mailbox;
+    Snapshot out = make(7);
+    EXPECT_EQ(mailbox.version(), 0u);
+    EXPECT_EQ(mailbox.read(out), 0u);
+    EXPECT_EQ(out.fields[0], 0u);
+}
+
+TEST(SeqlockMailboxTest, ReadsTheLatestValue)
+{
+    SeqlockMailbox<Snapshot> mailbox;
+    mailbox.publish(make(1));
+    mailbox.publish(make(2));
+    mailbox.publish(make(3));
+
+    Snapshot out;
+    EXPECT_EQ(mailbox.read(out), 3u);
+    EXPECT_EQ(out.fields[0], 3u);
+    EXPECT_EQ(out.fields[31], 3u);
+    EXPECT_EQ(mailbox.version(), 3u);
+
+    // Reading does not consume the value
+    EXPECT_EQ(mailbox.read(out), 3u);
+    EXPECT_EQ(out.fields[0], 3u);
+}
+
+TEST(SeqlockMailboxTest, NeverReadsATornValue)
+{
+    SeqlockMailbox<Snapshot> mailbox;
+    std::atomic<bool> done(false);
+
+    std::thread writer([&] {
+        for (uint32_t i = 1; i <= 200000; i++) {
+            mailbox.publish(make(i));
+        }
+        done = true;
+    });
+
+    uint32_t last = 0;
+    while (!done) {
+        Snapshot out;
+        uint32_t version = mailbox.read(out);
+        for (auto f : out.fields) {
+            ASSERT_EQ(f, out.fields[0]);
+        }
+        // The value belongs to the version, and versions never go back
+        ASSERT_EQ(out.fields[0], version);
+        ASSERT_GE(version, last);
+        last = version;
+    }
+    writer.join();
+}
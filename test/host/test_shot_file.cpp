@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "recorder/shot_file.h"
+
+// 2.5 s at the recorder's 100 Hz
+#define TEST_FRAMES 250
+#define TEST_INDEX 7
+#define TEST_START_MS 123456
+
+// Value of a channel at a frame, covering negative values and both ends of the range
+static float test_value(int channel, int frame)
+{
+    switch (channel) {
+        case SHOT_CH_TEMPERATURE:
+            return 90.0f + frame * 0.0125f;
+        case SHOT_CH_PRESSURE_D:
+            return -20.0f + frame * 0.2f;
+        case SHOT_CH_DIMMER:
+            return frame < 10 ? 1e6f : (float)(frame * 4);
+        default:
+            return std::sin(frame * 0.05f + channel) * 100.0f * SHOT_CHANNELS[channel].scale;
+    }
+}
+
+// A shot as the recorder keeps it: a time column and one column per channel
+class ShotFileTest : public ::testing::Test {
+protected:
+    std::vector<uint32_t> times;
+    std::vector<int16_t> column_data[SHOT_CHANNEL_COUNT];
+    int16_t *columns[SHOT_CHANNEL_COUNT];
+    std::vector<uint8_t> file;
+
+    void SetUp() override
+    {
+        for (int f = 0; f < TEST_FRAMES; f++) {
+            times.push_back(f * 10);
+        }
+        for (int c = 0; c < SHOT_CHANNEL_COUNT; c++) {
+            for (int f = 0; f < TEST_FRAMES; f++) {
+                column_data[c].push_back(shot_file_to_raw(test_value(c, f), (shot_channel_t)c));
+            }
+            columns[c] = column_data[c].data();
+        }
+
+        // Write the sections back to back, as the commit task does
+        shot_file_header_t header;
+        shot_file_section_t sections[SHOT_FILE_SECTIONS];
+        shot_file_header(&header, TEST_FRAMES, TEST_INDEX, TEST_START_MS);
+        size_t size = shot_file_sections(&header, times.data(), columns, sections);
+        for (const shot_file_section_t &section : sections) {
+            const uint8_t *p = (const uint8_t *)section.data;
+            file.insert(file.end(), p, p + section.size);
+        }
+        ASSERT_EQ(file.size(), size);
+    }
+
+    template <typename T>
+    T read(size_t offset) const
+    {
+        T value;
+        memcpy(&value, &file[offset], sizeof(T));
+        return value;
+    }
+};
+
+TEST(ShotFileRawTest, RoundsToTheChannelStep)
+{
+    EXPECT_EQ(shot_file_to_raw(93.456f, SHOT_CH_TEMPERATURE), 9346);
+    EXPECT_EQ(shot_file_to_raw(-1.25f, SHOT_CH_PRESSURE_P), -13);
+    EXPECT_EQ(shot_file_to_raw(0.5f, SHOT_CH_SSR1), 5000);
+    EXPECT_EQ(shot_file_to_raw(0.0f, SHOT_CH_FLOW1), 0);
+}
+
+TEST(ShotFileRawTest, SaturatesAndMapsNanToTheMinimum)
+{
+    EXPECT_EQ(shot_file_to_raw(1e6f, SHOT_CH_DIMMER), INT16_MAX);
+    EXPECT_EQ(shot_file_to_raw(-1e6f, SHOT_CH_DIMMER), INT16_MIN);
+    EXPECT_EQ(shot_file_to_raw(NAN, SHOT_CH_PRESSURE), INT16_MIN);
+}
+
+TEST_F(ShotFileTest, HeaderAndChannelTableMatchTheLayout)
+{
+    // Field offsets as unpacked by decode_shot.py: "<4sHHIII", then "<12s8sf" per channel
+    EXPECT_EQ(memcmp(&file[0], "SHOT", 4), 0);
+    EXPECT_EQ(read<uint16_t>(4), SHOT_FILE_VERSION);
+    EXPECT_EQ(read<uint16_t>(6), SHOT_CHANNEL_COUNT);
+    EXPECT_EQ(read<uint32_t>(8), (uint32_t)TEST_FRAMES);
+    EXPECT_EQ(read<uint32_t>(12), (uint32_t)TEST_INDEX);
+    EXPECT_EQ(read<uint32_t>(16), (uint32_t)TEST_START_MS);
+
+    for (int c = 0; c < SHOT_CHANNEL_COUNT; c++) {
+        size_t entry = 20 + c * 24;
+        EXPECT_STREQ((const char *)&file[entry], SHOT_CHANNELS[c].name);
+        EXPECT_STREQ((const char *)&file[entry + 12], SHOT_CHANNELS[c].unit);
+        EXPECT_EQ(read<float>(entry + 20), SHOT_CHANNELS[c].scale);
+    }
+}
+
+TEST_F(ShotFileTest, DataIsOneColumnPerChannelAfterTheTimes)
+{
+    size_t data = 20 + SHOT_CHANNEL_COUNT * 24;
+    EXPECT_EQ(file.size(), data + TEST_FRAMES * (4 + 2 * SHOT_CHANNEL_COUNT));
+
+    for (int f = 0; f < TEST_FRAMES; f++) {
+        ASSERT_EQ(read<uint32_t>(data + f * 4), times[f]);
+    }
+    size_t column = data + TEST_FRAMES * 4;
+    for (int c = 0; c < SHOT_CHANNEL_COUNT; c++, column += TEST_FRAMES * 2) {
+        for (int f = 0; f < TEST_FRAMES; f++) {
+            ASSERT_EQ(read<int16_t>(column + f * 2), columns[c][f])
+                << SHOT_CHANNELS[c].name << " frame " << f;
+        }
+    }
+}
+
+// Run scripts/decode_shot.py on the file and return its output
+static std::string run_decoder(const std::string &path, const char *options)
+{
+    std::string cmd =
+        std::string("python3 " REPO_DIR "/scripts/decode_shot.py ") + options + " " + path;
+    FILE *pipe = popen(cmd.c_str(), "r");
+    if (!pipe) {
+        return "";
+    }
+    std::string out;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), pipe)) > 0) {
+        out.append(buf, n);
+    }
+    EXPECT_EQ(pclose(pipe), 0) << cmd;
+    return out;
+}
+
+TEST_F(ShotFileTest, DecodeScriptReadsTheFile)
+{
+    if (system("python3 --version > /dev/null 2>&1") != 0) {
+        GTEST_SKIP() << "python3 not available";
+    }
+
+    std::string path = ::testing::TempDir() + "shot_file_test.bin";
+    FILE *f          = fopen(path.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    ASSERT_EQ(fwrite(file.data(), 1, file.size(), f), file.size());
+    fclose(f);
+
+    // The csv module ends rows with CRLF
+    std::string out = run_decoder(path, "");
+    out.erase(std::remove(out.begin(), out.end(), '\r'), out.end());
+    std::istringstream csv(out);
+    std::string line;
+
+    // Header row: time, then name_unit or name per channel
+    ASSERT_TRUE(std::getline(csv, line));
+    std::string expected = "time_s";
+    for (int c = 0; c < SHOT_CHANNEL_COUNT; c++) {
+        expected += std::string(",") + SHOT_CHANNELS[c].name;
+        if (SHOT_CHANNELS[c].unit[0]) {
+            expected += std::string("_") + SHOT_CHANNELS[c].unit;
+        }
+    }
+    EXPECT_EQ(line, expected);
+
+    int frame = 0;
+    for (; std::getline(csv, line); frame++) {
+        ASSERT_LT(frame, TEST_FRAMES);
+        std::istringstream row(line);
+        std::string cell;
+        ASSERT_TRUE(std::getline(row, cell, ','));
+        EXPECT_NEAR(std::stod(cell), times[frame] / 1000.0, 1e-9);
+        for (int c = 0; c < SHOT_CHANNEL_COUNT; c++) {
+            ASSERT_TRUE(std::getline(row, cell, ',')) << "frame " << frame;
+            double value = columns[c][frame] * (double)SHOT_CHANNELS[c].scale;
+            EXPECT_NEAR(std::stod(cell), value, 1e-4 + std::fabs(value) * 1e-5)
+                << SHOT_CHANNELS[c].name << " frame " << frame;
+        }
+    }
+    EXPECT_EQ(frame, TEST_FRAMES);
+
+    std::string summary = run_decoder(path, "--summary");
+    EXPECT_NE(summary.find("shot 7, 250 frames over 2.5 s (100.0 Hz)"), std::string::npos)
+        << summary;
+
+    remove(path.c_str());
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "common/spsc_queue.h"
+
+TEST(SpscQueueTest, PopsInPushOrder)
+{
+    SpscQueue<int, 4> queue;
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 1; i <= 3; i++) {
+        ASSERT_TRUE(queue.push(i));
+    }
+    EXPECT_EQ(queue.size(), 3u);
+
+    int out;
+    for (int i = 1; i <= 3; i++) {
+        ASSERT_TRUE(queue.pop(out));
+        EXPECT_EQ(out, i);
+    }
+    EXPECT_FALSE(queue.pop(out));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, DropsWhenFull)
+{
+    SpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.push(i));
+    }
+    EXPECT_FALSE(queue.push(99));
+    EXPECT_EQ(queue.size(), 4u);
+
+    // The dropped element never shows up
+    int out;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.pop(out));
+        EXPECT_EQ(out, i);
+    }
+    EXPECT_TRUE(queue.push(5));
+}
+
+TEST(SpscQueueTest, WrapsAroundTheRing)
+{
+    SpscQueue<uint32_t, 8> queue;
+    uint32_t next_in = 0, next_out = 0;
+
+    // Uneven batches move head and tail around the ring many times
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < round % 7 + 1; i++) {
+            ASSERT_TRUE(queue.push(next_in++));
+        }
+        uint32_t out;
+        while (queue.pop(out)) {
+            ASSERT_EQ(out, next_out++);
+        }
+    }
+    EXPECT_EQ(next_in, next_out);
+}
+
+// One producer and one consumer thread, as with the ISR or control task and a writer
+TEST(SpscQueueTest, KeepsOrderAcrossThreads)
+{
+    const uint32_t count = 200000;
+    SpscQueue<uint32_t, 64> queue;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < count;) {
+            if (queue.push(i)) {
+                i++;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    while (expected < count) {
+        uint32_t out;
+        if (queue.pop(out)) {
+            ASSERT_EQ(out, expected);
+            expected++;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "telemetry/telemetry_store.h"
+
+// Store time runs ahead of the host's wall clock, so record times follow the host timer
+#define TEST_BOOT_TIME_US (3000000000LL * 1000000LL)
+
+class TelemetryStoreTest : public ::testing::Test {
+protected:
+    std::unique_ptr<TelemetryStore> store;
+    TaskHandle_t writer = nullptr;
+    sensor_data_t data  = {};
+
+    void SetUp() override
+    {
+        host_partition_create(TELEMETRY_PARTITION_LABEL,
+                              TELEMETRY_PARTITION_SUBTYPE,
+                              16 * TELEMETRY_SECTOR_SIZE);
+        host_set_time_us(TEST_BOOT_TIME_US);
+        boot();
+        data.temperature = 93.0f;
+        data.pressure    = 130.0f;
+    }
+
+    // Power cycle: the timer restarts and a fresh store recovers from the flash alone
+    void reboot()
+    {
+        host_set_time_us(1000000);
+        boot();
+    }
+
+    void boot()
+    {
+        store = std::make_unique<TelemetryStore>();
+        ASSERT_EQ(store->init(), ESP_OK);
+        writer = host_last_task();
+    }
+
+    // One record per sample interval, handed to the writer as it arrives
+    void addRecords(int count)
+    {
+        for (int i = 0; i < count; i++) {
+            store->record(&data, 0);
+            host_advance_time_us(TELEMETRY_SAMPLE_INTERVAL_MS * 1000LL);
+            store->record(&data, 0);
+            host_run_task(writer);
+        }
+    }
+
+    void flush()
+    {
+        store->flush();
+        host_run_task(writer);
+    }
+
+    std::vector<telemetry_record_t> queryAll()
+    {
+        std::vector<telemetry_record_t> out(16 * TELEMETRY_SECTOR_RECORDS);
+        out.resize(store->query(0, UINT32_MAX, out.data(), out.size()));
+        return out;
+    }
+
+    telemetry_stats_t stats()
+    {
+        telemetry_stats_t s;
+        store->getStats(&s);
+        return s;
+    }
+};
+
+TEST_F(TelemetryStoreTest, NeverProgramsAcrossAFlashPage)
+{
+    // Stale pages are written every TELEMETRY_FLUSH_INTERVAL_MS, mid-page
+    addRecords(3 * TELEMETRY_PAGE_RECORDS);
+    flush();
+
+    host_flash_stats_t flash = host_flash_stats();
+    EXPECT_EQ(flash.straddling_writes, 0u);
+    EXPECT_EQ(flash.erases, 1u);
+    EXPECT_GE(stats().pages_written, 3u);
+    EXPECT_EQ(stats().records_written, 3u * TELEMETRY_PAGE_RECORDS);
+}
+
+TEST_F(TelemetryStoreTest, PartialPagesStayOnThePageGrid)
+{
+    addRecords(5);
+    flush();
+    addRecords(TELEMETRY_PAGE_RECORDS);
+    flush();
+    addRecords(TELEMETRY_SECTOR_RECORDS);
+    flush();
+
+    EXPECT_EQ(host_flash_stats().straddling_writes, 0u);
+    EXPECT_EQ(queryAll().size(), 5 + TELEMETRY_PAGE_RECORDS + TELEMETRY_SECTOR_RECORDS);
+}
+
+TEST_F(TelemetryStoreTest, QueriesIncludeRecordsNotWrittenYet)
+{
+    addRecords(3);
+    EXPECT_EQ(stats().records_written, 0u);
+    EXPECT_EQ(queryAll().size(), 3u);
+}
+
+TEST_F(TelemetryStoreTest, RecoversAfterAPowerCycle)
+{
+    addRecords(2 * TELEMETRY_SECTOR_RECORDS + 7);
+    flush();
+    std::vector<telemetry_record_t> before = queryAll();
+    ASSERT_EQ(before.size(), 2 * TELEMETRY_SECTOR_RECORDS + 7);
+
+    reboot();
+    std::vector<telemetry_record_t> after = queryAll();
+    ASSERT_EQ(after.size(), before.size());
+    for (size_t i = 0; i < after.size(); i++) {
+        ASSERT_EQ(after[i].time_s, before[i].time_s);
+    }
+    EXPECT_EQ(stats().newest_time, before.back().time_s);
+    EXPECT_EQ(stats().torn_records, 0u);
+
+    // Appending continues after the last record, with later times
+    addRecords(10);
+    flush();
+    after = queryAll();
+    ASSERT_EQ(after.size(), before.size() + 10);
+    for (size_t i = 1; i < after.size(); i++) {
+        ASSERT_GE(after[i].time_s, after[i - 1].time_s);
+    }
+    EXPECT_GT(after.back().time_s, before.back().time_s);
+}
+
+TEST_F(TelemetryStoreTest, SkipsTornRecords)
+{
+    addRecords(20);
+    flush();
+
+    // Power failed while record 12 was programmed: some of its bits never cleared
+    size_t offset = TELEMETRY_PAGE_SIZE + 12 * sizeof(telemetry_record_t);
+    host_partition_data()[offset + 1] = 0xFF;
+    host_partition_data()[offset + 6] = 0xFF;
+
+    reboot();
+    EXPECT_EQ(stats().torn_records, 1u);
+    EXPECT_EQ(queryAll().size(), 19u);
+
+    // The torn slot is not reused
+    addRecords(4);
+    flush();
+    EXPECT_EQ(queryAll().size(), 23u);
+    EXPECT_EQ(host_flash_stats().straddling_writes, 0u);
+}
+
+TEST_F(TelemetryStoreTest, LosesAtMostTheFlushIntervalOnPowerFailure)
+{
+    const uint32_t count = TELEMETRY_PAGE_RECORDS + 3;
+    addRecords(count);
+    uint32_t written = stats().records_written;
+    EXPECT_LE(count - written, TELEMETRY_FLUSH_INTERVAL_MS / TELEMETRY_SAMPLE_INTERVAL_MS);
+
+    reboot();
+    EXPECT_EQ(queryAll().size(), written);
+}
+
+TEST_F(TelemetryStoreTest, ReusesTheOldestSectorWhenFull)
+{
+    addRecords(16 * TELEMETRY_SECTOR_RECORDS + 10);
+    flush();
+
+    // Sector 0 was erased for the newest records
+    EXPECT_EQ(queryAll().size(), 15 * TELEMETRY_SECTOR_RECORDS + 10);
+    EXPECT_EQ(stats().sectors_erased, 17u);
+
+    reboot();
+    std::vector<telemetry_record_t> all = queryAll();
+    ASSERT_EQ(all.size(), 15 * TELEMETRY_SECTOR_RECORDS + 10);
+    for (size_t i = 1; i < all.size(); i++) {
+        ASSERT_GE(all[i].time_s, all[i - 1].time_s);
+    }
+}
+
+TEST_F(TelemetryStoreTest, QueriesATimeRange)
+{
+    addRecords(3 * TELEMETRY_SECTOR_RECORDS);
+    flush();
+    std::vector<telemetry_record_t> all = queryAll();
+
+    uint32_t from = all[300].time_s;
+    uint32_t to   = all[500].time_s;
+    std::vector<telemetry_record_t> out(1000);
+    out.resize(store->query(from, to, out.data(), out.size()));
+    ASSERT_EQ(out.size(), 201u);
+    EXPECT_EQ(out.front().time_s, from);
+    EXPECT_EQ(out.back().time_s, to);
+
+    // Stops at the capacity of the destination
+    EXPECT_EQ(store->query(from, to, out.data(), 50), 50u);
+}
+
+TEST_F(TelemetryStoreTest, AveragesTheSampleInterval)
+{
+    data.temperature = 90.0f;
+    store->record(&data, 0);
+    data.temperature = 94.0f;
+    host_advance_time_us(TELEMETRY_SAMPLE_INTERVAL_MS * 1000LL / 2);
+    store->record(&data, 0);
+    data.temperature = -1.0f;  // Sensor error, left out of the mean
+    host_advance_time_us(TELEMETRY_SAMPLE_INTERVAL_MS * 1000LL / 2);
+    store->record(&data, 3);
+    host_run_task(writer);
+
+    std::vector<telemetry_record_t> all = queryAll();
+    ASSERT_EQ(all.size(), 1u);
+    EXPECT_EQ(all[0].temperature, 920);
+    EXPECT_EQ(all[0].pressure, 13000);
+    EXPECT_EQ(all[0].faults, TELEMETRY_FAULT_SENSOR | 3);
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "display/touch_tracker.h"
+#include "tft_config.h"
+
+// One FT6236 read as captured from the bus: TD_STATUS, P1_XH, P1_XL, P1_YH, P1_YL
+typedef struct {
+    int64_t time_us;
+    uint8_t report[FT6236_REPORT_BYTES];
+} trace_sample_t;
+
+// Finger down and up again at (401, 240), 10 ms sampling
+static const int64_t TAP_IRQ_US        = 1000000;
+static const trace_sample_t TAP_TRACE[] = {
+    {1000150, {0x01, 0x01, 0x90, 0x00, 0xF0}},  // Down (400, 240)
+    {1010150, {0x01, 0x81, 0x91, 0x00, 0xF0}},  // Contact (401, 240)
+    {1020150, {0x01, 0x81, 0x91, 0x00, 0xF1}},  // Contact (401, 241)
+    {1030150, {0x00, 0x41, 0x91, 0x00, 0xF1}},  // Up
+    {1040150, {0x00, 0xFF, 0xFF, 0xFF, 0xFF}},  // Idle
+};
+
+// Horizontal swipe from (100, 300) to (160, 302) with a jittery sample in between
+static const int64_t DRAG_IRQ_US        = 2000000;
+static const trace_sample_t DRAG_TRACE[] = {
+    {2000200, {0x01, 0x00, 0x64, 0x01, 0x2C}},  // Down (100, 300)
+    {2010200, {0x01, 0x80, 0x64, 0x01, 0x2C}},  // Contact (100, 300)
+    {2020200, {0x01, 0x80, 0x78, 0x01, 0x2C}},  // Contact (120, 300)
+    {2030200, {0x01, 0x80, 0x79, 0x01, 0x2D}},  // Contact (121, 301)
+    {2040200, {0x01, 0x80, 0x8C, 0x01, 0x2D}},  // Contact (140, 301)
+    {2050200, {0x01, 0x80, 0xA0, 0x01, 0x2E}},  // Contact (160, 302)
+    {2060200, {0x01, 0x40, 0xA0, 0x01, 0x2E}},  // Up
+    {2070200, {0x00, 0xFF, 0xFF, 0xFF, 0xFF}},  // Idle
+};
+
+// A brush of the bezel: INT fires, one contact report, then nothing
+static const int64_t GLITCH_IRQ_US        = 3000000;
+static const trace_sample_t GLITCH_TRACE[] = {
+    {3000100, {0x01, 0x02, 0x10, 0x00, 0x20}},  // Down (528, 32)
+    {3010100, {0x00, 0xFF, 0xFF, 0xFF, 0xFF}},  // Idle
+    {3020100, {0x00, 0xFF, 0xFF, 0xFF, 0xFF}},  // Idle
+};
+
+// Long press with a single dropped report, as seen with a wet finger
+static const int64_t DROPOUT_IRQ_US        = 4000000;
+static const trace_sample_t DROPOUT_TRACE[] = {
+    {4000100, {0x01, 0x00, 0xC8, 0x00, 0xC8}},  // Down (200, 200)
+    {4010100, {0x01, 0x80, 0xC8, 0x00, 0xC8}},  // Contact (200, 200)
+    {4020100, {0x00, 0xFF, 0xFF, 0xFF, 0xFF}},  // Dropout
+    {4030100, {0x01, 0x80, 0xC8, 0x00, 0xC8}},  // Contact (200, 200)
+    {4040100, {0x01, 0x80, 0xC8, 0x00, 0xC8}},  // Contact (200, 200)
+    {4050100, {0x00, 0x40, 0xC8, 0x00, 0xC8}},  // Up
+    {4060100, {0x00, 0xFF, 0xFF, 0xFF, 0xFF}},  // Idle
+};
+
+class TouchTraceTest : public ::testing::Test {
+protected:
+    TouchTracker tracker;
+
+    // Feed a trace the way the sampling task does and return the queued events
+    template <size_t N>
+    std::vector<touch_event_t> replay(int64_t irq_time_us, const trace_sample_t (&trace)[N])
+    {
+        std::vector<touch_event_t> out;
+        tracker.begin(irq_time_us);
+        for (size_t i = 0; i < N; i++) {
+            EXPECT_FALSE(tracker.finished()) << "Trace continues after the contact ended";
+
+            uint16_t x = 0, y = 0;
+            bool contact = touch_decode_ft6236(trace[i].report, &x, &y);
+
+            touch_event_t event;
+            if (tracker.update(contact, x, y, trace[i].time_us, &event)) {
+                out.push_back(event);
+            }
+        }
+        EXPECT_TRUE(tracker.finished()) << "Trace ends before the contact was released";
+        return out;
+    }
+};
+
+static void expectEvent(const touch_event_t& event,
+                        touch_event_type_t type,
+                        uint16_t x,
+                        uint16_t y,
+                        int64_t timestamp_us)
+{
+    EXPECT_EQ(event.type, type);
+    EXPECT_EQ(event.x, x);
+    EXPECT_EQ(event.y, y);
+    EXPECT_EQ(event.timestamp_us, timestamp_us);
+}
+
+TEST_F(TouchTraceTest, TapIsOnePressAndOneRelease)
+{
+    std::vector<touch_event_t> events = replay(TAP_IRQ_US, TAP_TRACE);
+
+    ASSERT_EQ(events.size(), 2u);
+    expectEvent(events[0], TOUCH_EVENT_PRESS, 401, 240, TAP_IRQ_US);
+    expectEvent(events[1], TOUCH_EVENT_RELEASE, 401, 240, 1040150);
+}
+
+TEST_F(TouchTraceTest, PressIsStampedWithTheIrqEdge)
+{
+    std::vector<touch_event_t> events = replay(TAP_IRQ_US, TAP_TRACE);
+
+    // Debouncing delays the press by a sample, but latency is measured from the edge
+    ASSERT_FALSE(events.empty());
+    EXPECT_LT(events[0].timestamp_us, TAP_TRACE[TOUCH_PRESS_SAMPLES - 1].time_us);
+}
+
+TEST_F(TouchTraceTest, DragReportsMovesPastTheThreshold)
+{
+    std::vector<touch_event_t> events = replay(DRAG_IRQ_US, DRAG_TRACE);
+
+    ASSERT_EQ(events.size(), 5u);
+    expectEvent(events[0], TOUCH_EVENT_PRESS, 100, 300, DRAG_IRQ_US);
+    expectEvent(events[1], TOUCH_EVENT_MOVE, 120, 300, 2020200);
+    expectEvent(events[2], TOUCH_EVENT_MOVE, 140, 301, 2040200);
+    expectEvent(events[3], TOUCH_EVENT_MOVE, 160, 302, 2050200);
+    expectEvent(events[4], TOUCH_EVENT_RELEASE, 160, 302, 2070200);
+
+    for (size_t i = 1; i < events.size(); i++) {
+        EXPECT_GT(events[i].timestamp_us, events[i - 1].timestamp_us);
+    }
+}
+
+TEST_F(TouchTraceTest, SingleReportGlitchIsIgnored)
+{
+    EXPECT_TRUE(replay(GLITCH_IRQ_US, GLITCH_TRACE).empty());
+}
+
+TEST_F(TouchTraceTest, SingleDropoutDoesNotRelease)
+{
+    std::vector<touch_event_t> events = replay(DROPOUT_IRQ_US, DROPOUT_TRACE);
+
+    ASSERT_EQ(events.size(), 2u);
+    expectEvent(events[0], TOUCH_EVENT_PRESS, 200, 200, DROPOUT_IRQ_US);
+    expectEvent(events[1], TOUCH_EVENT_RELEASE, 200, 200, 4060100);
+}
+
+TEST_F(TouchTraceTest, ContactsDoNotLeakIntoEachOther)
+{
+    replay(GLITCH_IRQ_US, GLITCH_TRACE);
+    std::vector<touch_event_t> events = replay(TAP_IRQ_US, TAP_TRACE);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, TOUCH_EVENT_PRESS);
+
+    events = replay(DRAG_IRQ_US, DRAG_TRACE);
+    ASSERT_EQ(events.size(), 5u);
+    expectEvent(events[0], TOUCH_EVENT_PRESS, 100, 300, DRAG_IRQ_US);
+}
+
+TEST(TouchDecodeTest, ClampsToThePanel)
+{
+    const uint8_t report[] = {0x01, 0x8F, 0xFF, 0x0F, 0xFF};
+    uint16_t x = 0, y = 0;
+
+    ASSERT_TRUE(touch_decode_ft6236(report, &x, &y));
+    EXPECT_EQ(x, TFT_WIDTH - 1);
+    EXPECT_EQ(y, TFT_HEIGHT - 1);
+}
+
+TEST(TouchDecodeTest, UsesTheFirstPointOfTwo)
+{
+    const uint8_t report[] = {0x02, 0x80, 0x32, 0x10, 0x46};
+    uint16_t x = 0, y = 0;
+
+    ASSERT_TRUE(touch_decode_ft6236(report, &x, &y));
+    EXPECT_EQ(x, 50);
+    EXPECT_EQ(y, 70);
+}
+
+TEST(TouchDecodeTest, RejectsLiftsAndInvalidReports)
+{
+    const uint8_t no_touch[] = {0x00, 0x80, 0x32, 0x00, 0x46};
+    const uint8_t lifted[]   = {0x01, 0x40, 0x32, 0x00, 0x46};
+    const uint8_t no_event[] = {0x01, 0xC0, 0x32, 0x00, 0x46};
+    const uint8_t settling[] = {0x0F, 0x80, 0x32, 0x00, 0x46};
+    uint16_t x = 0, y = 0;
+
+    EXPECT_FALSE(touch_decode_ft6236(no_touch, &x, &y));
+    EXPECT_FALSE(touch_decode_ft6236(lifted, &x, &y));
+    EXPECT_FALSE(touch_decode_ft6236(no_event, &x, &y));
+    EXPECT_FALSE(touch_decode_ft6236(settling, &x, &y));
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <new>
+#include <optional>
+
+#include "common/seqlock.h"
+#include "ui_manager/ui_bindings.h"
+
+// Every heap allocation in the test binary goes through these
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+// Row of the SSR model, as in main_ui.slint
+struct SsrRow {
+    const char* name;
+    bool state;
+    bool has_pid;
+    float setpoint;
+};
+
+// Fixed-capacity model with the row interface of slint::VectorModel
+struct FixedSsrModel {
+    SsrRow rows[UI_BINDING_MAX_SSRS] = {};
+    int size                         = 0;
+    int writes[UI_BINDING_MAX_SSRS]  = {};
+
+    std::optional<SsrRow> row_data(size_t i) const
+    {
+        if ((int)i >= size) {
+            return std::nullopt;
+        }
+        return rows[i];
+    }
+
+    void set_row_data(size_t i, const SsrRow& row)
+    {
+        rows[i] = row;
+        writes[i]++;
+    }
+};
+
+// The control side's view of one cycle, as published to the render task
+struct Cycle {
+    float temperature;
+    float pressure;
+    bool ssr_states[4];
+};
+
+class UiAllocationTest : public ::testing::Test {
+protected:
+    MainWindowBindings bindings;
+    FixedSsrModel model;
+
+    void SetUp() override
+    {
+        static const char* names[] = {"BOILER", "GROUP", "STEAM", "PUMP"};
+        model.size = 4;
+        for (int i = 0; i < 4; i++) {
+            model.rows[i] = {names[i], false, i < 2, 90.0f};
+            bindings.ssr_state[i].sync(false);
+            bindings.ssr_setpoint[i].sync(90.0f);
+        }
+    }
+};
+
+TEST_F(UiAllocationTest, OneRelayTouchesOneRowWithoutAllocating)
+{
+    size_t before = allocations;
+
+    bindings.ssr_state[2].set(true);
+    ASSERT_TRUE(bindings.ssrPending(4));
+    EXPECT_EQ(bindings.applySsrRows(model, 4), 1);
+
+    EXPECT_EQ(allocations, before);
+    EXPECT_TRUE(model.rows[2].state);
+    EXPECT_STREQ(model.rows[2].name, "STEAM");
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(model.writes[i], i == 2 ? 1 : 0);
+    }
+    EXPECT_FALSE(bindings.ssrPending(4));
+}
+
+TEST_F(UiAllocationTest, UnchangedRowsAreNotWritten)
+{
+    for (int i = 0; i < 4; i++) {
+        bindings.ssr_state[i].set(false);
+        bindings.ssr_setpoint[i].set(90.04f);  // Same in the display precision
+    }
+    EXPECT_EQ(bindings.applySsrRows(model, 4), 0);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(model.writes[i], 0);
+    }
+}
+
+// Publish, read, stage and apply, the whole path a sensor cycle takes to the window
+TEST_F(UiAllocationTest, UpdatePathDoesNotAllocate)
+{
+    SeqlockMailbox<Cycle> mailbox;
+    size_t before = allocations;
+
+    for (int n = 0; n < 1000; n++) {
+        Cycle cycle = {90.0f + n * 0.01f, 130.0f, {n % 2 == 0, false, n % 7 == 0, false}};
+        mailbox.publish(cycle);
+
+        Cycle seen;
+        mailbox.read(seen);
+        bindings.temperature.set(seen.temperature);
+        bindings.pressure.set(seen.pressure);
+        for (int i = 0; i < 4; i++) {
+            bindings.ssr_state[i].set(seen.ssr_states[i]);
+        }
+        if (bindings.sensorPending()) {
+            bindings.temperature.take();
+            bindings.pressure.take();
+        }
+        bindings.applySsrRows(model, 4);
+    }
+
+    EXPECT_EQ(allocations, before);
+    EXPECT_EQ(model.writes[1], 0);
+    EXPECT_EQ(model.writes[0], 1000);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "ui_manager/ui_bindings.h"
+
+TEST(BindingTest, ForwardsTheFirstValue)
+{
+    Binding<float> binding(0.1f);
+    EXPECT_FALSE(binding.pending());
+    EXPECT_TRUE(binding.set(0.0f));
+    EXPECT_TRUE(binding.pending());
+    EXPECT_FLOAT_EQ(binding.take(), 0.0f);
+    EXPECT_FALSE(binding.pending());
+}
+
+TEST(BindingTest, DropsChangesBelowTheDisplayStep)
+{
+    Binding<float> binding(UI_TEMPERATURE_STEP);
+    binding.set(92.04f);
+    binding.take();
+
+    // Still shows as 92.0
+    EXPECT_FALSE(binding.set(92.01f));
+    EXPECT_FALSE(binding.set(91.96f));
+    EXPECT_FALSE(binding.pending());
+
+    // Shows as 92.1
+    EXPECT_TRUE(binding.set(92.06f));
+    EXPECT_FLOAT_EQ(binding.take(), 92.06f);
+}
+
+TEST(BindingTest, KeepsTheNewestStagedValue)
+{
+    Binding<float> binding(1.0f);
+    binding.set(10.0f);
+    binding.set(11.0f);
+    binding.set(12.0f);
+    EXPECT_FLOAT_EQ(binding.take(), 12.0f);
+}
+
+TEST(BindingTest, ComparesOtherTypesForEquality)
+{
+    Binding<bool> state;
+    EXPECT_TRUE(state.set(false));
+    state.take();
+    EXPECT_FALSE(state.set(false));
+    EXPECT_TRUE(state.set(true));
+
+    // Segment names are constants, so the same text at another address is a change
+    static const char preinfuse[] = "PREINFUSE";
+    static const char copy[]      = "PREINFUSE";
+    Binding<const char*> step;
+    step.set(preinfuse);
+    step.take();
+    EXPECT_FALSE(step.set(preinfuse));
+    EXPECT_TRUE(step.set(copy));
+}
+
+TEST(BindingTest, SyncSuppressesTheEcho)
+{
+    Binding<float> binding(UI_SETPOINT_STEP);
+    binding.set(90.0f);
+    binding.take();
+
+    // The user edited the setpoint in the window, the control side then reports it back
+    binding.sync(93.0f);
+    EXPECT_FALSE(binding.pending());
+    EXPECT_FALSE(binding.set(93.0f));
+    EXPECT_TRUE(binding.set(94.0f));
+}
+
+TEST(MainWindowBindingsTest, ReportsPendingGroups)
+{
+    MainWindowBindings bindings;
+    EXPECT_FALSE(bindings.sensorPending());
+    EXPECT_FALSE(bindings.shotPending());
+    EXPECT_FALSE(bindings.ssrPending(4));
+
+    bindings.ssr_setpoint[3].set(50.0f);
+    EXPECT_FALSE(bindings.ssrPending(3));
+    EXPECT_TRUE(bindings.ssrPending(4));
+
+    bindings.shot_volume.set(1.0f);
+    EXPECT_TRUE(bindings.shotPending());
+
+    // SSR setpoints got their display step
+    bindings.ssr_setpoint[3].take();
+    EXPECT_FALSE(bindings.ssr_setpoint[3].set(50.04f));
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "dosing/volumetric_dose.h"
+#include "esp_timer.h"
+#include "hardware/hardware_control.h"
+
+// Flow meter 1 pulse train fed through the interrupt entry point
+class VolumetricDoseTest : public ::testing::Test {
+protected:
+    VolumetricDose dose;
+
+    void SetUp() override
+    {
+        hw = HardwareControl();
+        host_set_time_us(1000000);
+    }
+
+    // One pulse every interval_us, as the flow meter delivers them during a shot
+    void pulses(uint32_t count, int64_t interval_us = 10000)
+    {
+        for (uint32_t i = 0; i < count; i++) {
+            host_advance_time_us(interval_us);
+            dose.onPulseFromIsr();
+        }
+    }
+
+    // Let the flow settle and poll until the dose is finished
+    void settle()
+    {
+        host_advance_time_us(DOSE_SETTLE_MS * 1000LL);
+        dose.poll();
+    }
+
+    static uint32_t pulsesFor(float ml) { return (uint32_t)lroundf(ml * DOSE_PULSES_PER_ML); }
+};
+
+TEST_F(VolumetricDoseTest, CutsOnTheTargetPulse)
+{
+    ASSERT_TRUE(dose.arm(36.0f));
+    uint32_t cut = pulsesFor(36.0f - DOSE_DRIP_INITIAL_ML);
+
+    pulses(cut - 1);
+    EXPECT_EQ(dose.getState(), DOSE_STATE_ARMED);
+    EXPECT_EQ(hw.cut_calls, 0u);
+
+    pulses(1);
+    EXPECT_EQ(dose.getState(), DOSE_STATE_SETTLING);
+    EXPECT_EQ(hw.cut_calls, 1u);
+    EXPECT_TRUE(hw.pump_cutoff);
+    EXPECT_EQ(hw.cutoff_mask, (uint32_t)DOSE_CUT_SSR_MASK);
+
+    // Drip pulses after the cutoff do not cut again
+    pulses(5);
+    EXPECT_EQ(hw.cut_calls, 1u);
+}
+
+TEST_F(VolumetricDoseTest, ReportsTheCutoffOnce)
+{
+    ASSERT_TRUE(dose.arm(20.0f));
+    EXPECT_FALSE(dose.poll());
+
+    pulses(pulsesFor(20.0f - DOSE_DRIP_INITIAL_ML));
+    EXPECT_TRUE(dose.poll());
+    EXPECT_FALSE(dose.poll());
+    EXPECT_FALSE(dose.poll());
+}
+
+TEST_F(VolumetricDoseTest, FinishesAfterTheFlowSettles)
+{
+    ASSERT_TRUE(dose.arm(36.0f));
+    pulses(pulsesFor(36.0f - DOSE_DRIP_INITIAL_ML));
+    dose.poll();
+
+    // Every drip pulse restarts the settle time
+    pulses(pulsesFor(DOSE_DRIP_INITIAL_ML), 500000);
+    host_advance_time_us(DOSE_SETTLE_MS * 1000LL - 1);
+    dose.poll();
+    EXPECT_EQ(dose.getState(), DOSE_STATE_SETTLING);
+    EXPECT_EQ(hw.release_calls, 0u);
+
+    host_advance_time_us(1);
+    dose.poll();
+    EXPECT_EQ(dose.getState(), DOSE_STATE_IDLE);
+    EXPECT_EQ(hw.release_calls, 1u);
+    EXPECT_FALSE(hw.pump_cutoff);
+
+    dose_stats_t stats;
+    dose.getStats(&stats);
+    EXPECT_EQ(stats.shots, 1u);
+    EXPECT_NEAR(stats.volume_ml, 36.0f, 0.5f / DOSE_PULSES_PER_ML);
+    EXPECT_NEAR(stats.error_ml, 0.0f, 0.5f / DOSE_PULSES_PER_ML);
+}
+
+TEST_F(VolumetricDoseTest, LearnsTheDrip)
+{
+    ASSERT_TRUE(dose.arm(36.0f));
+    pulses(pulsesFor(36.0f - DOSE_DRIP_INITIAL_ML));
+    pulses(pulsesFor(4.0f));  // Twice the expected drip
+    settle();
+
+    dose_stats_t stats;
+    dose.getStats(&stats);
+    float drip = DOSE_DRIP_INITIAL_ML + DOSE_DRIP_GAIN * (4.0f - DOSE_DRIP_INITIAL_ML);
+    EXPECT_NEAR(stats.drip_ml, drip, 0.01f);
+    EXPECT_NEAR(stats.error_ml, 2.0f, 0.5f / DOSE_PULSES_PER_ML);
+
+    // The next shot cuts earlier by the learned drip
+    ASSERT_TRUE(dose.arm(36.0f));
+    uint32_t cut = pulsesFor(36.0f - drip);
+    pulses(cut - 1);
+    EXPECT_EQ(hw.cut_calls, 1u);
+    pulses(1);
+    EXPECT_EQ(hw.cut_calls, 2u);
+}
+
+TEST_F(VolumetricDoseTest, ClampsTheLearnedDrip)
+{
+    for (int shot = 0; shot < 20; shot++) {
+        ASSERT_TRUE(dose.arm(60.0f));
+        while (dose.getState() == DOSE_STATE_ARMED) {
+            pulses(1);
+        }
+        pulses(pulsesFor(3 * DOSE_DRIP_MAX_ML));
+        settle();
+    }
+
+    dose_stats_t stats;
+    dose.getStats(&stats);
+    EXPECT_EQ(stats.shots, 20u);
+    EXPECT_FLOAT_EQ(stats.drip_ml, DOSE_DRIP_MAX_ML);
+}
+
+TEST_F(VolumetricDoseTest, CountsOnlyPulsesAfterArming)
+{
+    pulses(1000);  // Flushing, a previous shot
+    ASSERT_TRUE(dose.arm(10.0f));
+
+    pulses(pulsesFor(10.0f - DOSE_DRIP_INITIAL_ML) - 1);
+    EXPECT_EQ(hw.cut_calls, 0u);
+    pulses(1);
+    EXPECT_EQ(hw.cut_calls, 1u);
+}
+
+TEST_F(VolumetricDoseTest, CancelKeepsThePumpRunning)
+{
+    ASSERT_TRUE(dose.arm(36.0f));
+    pulses(50);
+    dose.cancel();
+    EXPECT_EQ(dose.getState(), DOSE_STATE_IDLE);
+
+    pulses(500);
+    EXPECT_EQ(hw.cut_calls, 0u);
+    EXPECT_FALSE(dose.poll());
+
+    dose_stats_t stats;
+    dose.getStats(&stats);
+    EXPECT_EQ(stats.cancelled, 1u);
+    EXPECT_EQ(stats.shots, 0u);
+}
+
+TEST_F(VolumetricDoseTest, CancelAfterTheCutoffIsIgnored)
+{
+    ASSERT_TRUE(dose.arm(20.0f));
+    pulses(pulsesFor(20.0f - DOSE_DRIP_INITIAL_ML));
+    dose.cancel();
+
+    // The outputs stay cut until the drip has been counted
+    EXPECT_EQ(dose.getState(), DOSE_STATE_SETTLING);
+    EXPECT_TRUE(hw.pump_cutoff);
+}
+
+TEST_F(VolumetricDoseTest, RejectsTargetsWithinTheDrip)
+{
+    EXPECT_FALSE(dose.arm(DOSE_DRIP_INITIAL_ML));
+    EXPECT_FALSE(dose.arm(0.0f));
+    EXPECT_EQ(dose.getState(), DOSE_STATE_IDLE);
+}
+
+TEST_F(VolumetricDoseTest, ArmingWhileSettlingFinishesTheShot)
+{
+    ASSERT_TRUE(dose.arm(20.0f));
+    pulses(pulsesFor(20.0f - DOSE_DRIP_INITIAL_ML));
+    pulses(pulsesFor(DOSE_DRIP_INITIAL_ML));
+
+    ASSERT_TRUE(dose.arm(20.0f));
+    EXPECT_EQ(dose.getState(), DOSE_STATE_ARMED);
+    EXPECT_EQ(hw.release_calls, 1u);
+
+    dose_stats_t stats;
+    dose.getStats(&stats);
+    EXPECT_EQ(stats.shots, 1u);
+}
+
+TEST_F(VolumetricDoseTest, TracksTheVolumeSinceArming)
+{
+    pulses(100);
+    ASSERT_TRUE(dose.arm(36.0f));
+    pulses(pulsesFor(10.0f));
+    EXPECT_NEAR(dose.volumeMl(), 10.0f, 0.5f / DOSE_PULSES_PER_ML);
+}